@@ -20,120 +20,98 @@ limitations under the License.
 #include <stdio.h>
 #include "omp.h"
 
-#define M_PI 3.14159265358979323846
+#include "DeformObject_core.h"
 
 /* C-OMP Mex-function to perform forward/inverse deformation according to [1]
  *
  * Input Parameters:
- * 1. A - image to deform (N x N )
+ * 1. A - image to deform (N x M, non-square images have square pixels) or a stack of images (N x M x K), single (the deformation is computed in single precision) or double
  * 2. RFP - propotional to the focal point distance
  * 3. AngleTransform - deformation angle in degrees
  * 4. DeformType - deformation type, 0 - forward, 1 - inverse
+ * 5. Interpolation - (optional) 'linear' (default), 'cubic' (cubic B-spline) or 'lanczos' (Lanczos-3), the higher
+ *    orders keep small features without supersampling (single A only)
+ * or with the warp plan of DeformPlan_C (single A only):
+ * 2. Index - int32 indices of the plan
+ * 3. Weights - single or uint16 weights of the plan
  *
  * Output:
- * 1. Deformed image
+ * 1. Deformed image (stack) of the class of A, the single stacks are deformed with a warp plan built once
  *
- * to compile with OMP support: mex DeformObject_C.c CFLAGS="\$CFLAGS -fopenmp -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+ * to compile with OMP support: mex DeformObject_C.c DeformObject_core.c CFLAGS="\$CFLAGS -fopenmp -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
  * References:
  * [1] D. Kazantsev & V. Pickalov, "New iterative reconstruction methods for fan-beam tomography" IPSE, 2017
  */
 
-double Deform_func(double *A, double *B, double *Tomorange_X_Ar, double H_x, double RFP, double angleRad, int DeformType, int dimX, int dimY);
-
 void mexFunction(
         int nlhs, mxArray *plhs[],
         int nrhs, const mxArray *prhs[])
         
 {
-    int number_of_dims, dimX, dimY, DeformType, i;
+    int number_of_dims, dimX, dimY, Images, DeformType, Interp, k;
     const mwSize  *dim_array;
-    double *A, *B, *Tomorange_X_Ar=NULL, RFP, angle, angleRad, Tomorange_Xmin, Tomorange_Xmax, H_x;;
+    double RFP, angle;
+    
+    /*Handling Matlab input data*/
+    if ((nrhs < 3) || (nrhs > 5)) mexErrMsgTxt("Input of 4 or 5 parameters (or 3 with a warp plan) is required");
+    if ((mxGetClassID(prhs[0]) != mxSINGLE_CLASS) && (mxGetClassID(prhs[0]) != mxDOUBLE_CLASS)) mexErrMsgTxt("The image must be in a single or double precision");
     
     number_of_dims = mxGetNumberOfDimensions(prhs[0]);
     dim_array = mxGetDimensions(prhs[0]);
+    if ((number_of_dims != 2) && (number_of_dims != 3)) mexErrMsgTxt("The input must be an image or a stack of images");
     
-    /*Handling Matlab input data*/
-    if (nrhs != 4) mexErrMsgTxt("Input of 4 parameters is required");
+    /*Handling Matlab output data*/
+    /* the cores index the images as A[i*dimY + j] (j fastest), the columns of the MATLAB arrays are contiguous */
+    dimX = dim_array[1]; dimY = dim_array[0];
+    Images = (number_of_dims == 3) ? dim_array[2] : 1;
     
-    A  = (double *) mxGetData(prhs[0]); /* image to deform */
+    if (nrhs == 3) {
+        /* deformation with a given warp plan */
+        if (mxGetClassID(prhs[0]) != mxSINGLE_CLASS) mexErrMsgTxt("The warp plan deforms single precision images");
+        if ((mxGetClassID(prhs[1]) != mxINT32_CLASS) || (mxGetNumberOfElements(prhs[1]) != (size_t)dimX*dimY)) mexErrMsgTxt("The plan indices must be int32 of the image size");
+        if (mxGetNumberOfElements(prhs[2]) != 4*(size_t)dimX*dimY) mexErrMsgTxt("The plan weights must be 4 per pixel");
+        float *A = (float *) mxGetData(prhs[0]);
+        float *B = (float*)mxGetData(plhs[0] = mxCreateNumericArray(number_of_dims, dim_array, mxSINGLE_CLASS, mxREAL));
+        int *Index = (int *) mxGetData(prhs[1]);
+        if (mxGetClassID(prhs[2]) == mxSINGLE_CLASS) DeformObject_apply_core(Index, (float *) mxGetData(prhs[2]), NULL, A, B, dimX, dimY, Images);
+        else if (mxGetClassID(prhs[2]) == mxUINT16_CLASS) DeformObject_apply_core(Index, NULL, (unsigned short *) mxGetData(prhs[2]), A, B, dimX, dimY, Images);
+        else mexErrMsgTxt("The plan weights must be single or uint16");
+        return;
+    }
     RFP =  (double) mxGetScalar(prhs[1]); /*  propotional to focal point distance*/
     angle =  (double) mxGetScalar(prhs[2]); /*  deformation angle in degrees */
     DeformType =  (int) mxGetScalar(prhs[3]); /* deformation type, 0 - forward, 1 - inverse  */
+    Interp = 0; /* bilinear interpolation is the default one */
     
-    /*Handling Matlab output data*/
-    dimX = dim_array[0]; dimY = dim_array[1];
-    
-    if (number_of_dims == 2) {
-        
-        B = (double*)mxGetPr(plhs[0] = mxCreateNumericArray(2, dim_array, mxDOUBLE_CLASS, mxREAL));
-        
-        Tomorange_X_Ar = malloc(dimX*sizeof(double));
-        
-        angleRad = angle*(M_PI/180.0f);
-        Tomorange_Xmin = -1.0f;
-        Tomorange_Xmax = 1.0f;
-        H_x = (Tomorange_Xmax - Tomorange_Xmin)/(dimX);
-        for(i=0; i<dimX; i++)  {Tomorange_X_Ar[i] = Tomorange_Xmin + (double)i*H_x;}
-                
-        /* perform deformation */
-        Deform_func(A, B, Tomorange_X_Ar, H_x, RFP, angleRad, DeformType, dimX, dimY); 
+    if (nrhs == 5)  {
+        char *InterpType;
+        InterpType = mxArrayToString(prhs[4]); /* 'linear' (default), 'cubic' or 'lanczos' */
+        if ((strcmp(InterpType, "linear") != 0) && (strcmp(InterpType, "cubic") != 0) && (strcmp(InterpType, "lanczos") != 0)) mexErrMsgTxt("Choose 'linear', 'cubic' or 'lanczos'");
+        if (strcmp(InterpType, "cubic") == 0)  Interp = 1;
+        if (strcmp(InterpType, "lanczos") == 0)  Interp = 2;
+        mxFree(InterpType);
+    }
+    if ((Interp != 0) && (mxGetClassID(prhs[0]) != mxSINGLE_CLASS)) mexErrMsgTxt("The cubic and lanczos interpolations deform single precision images");
     
-        free(Tomorange_X_Ar);
+    /* perform deformation */
+    if (mxGetClassID(prhs[0]) == mxSINGLE_CLASS) {
+        float *A = (float *) mxGetData(prhs[0]);
+        float *B = (float*)mxGetData(plhs[0] = mxCreateNumericArray(number_of_dims, dim_array, mxSINGLE_CLASS, mxREAL));
+        if ((Images == 1) || (dimX < 2) || (dimY < 2) || (Interp != 0)) {
+            for(k=0; k<Images; k++) DeformObject_core_interp(&A[(size_t)k*dimX*dimY], &B[(size_t)k*dimX*dimY], dimX, dimY, (float)RFP, (float)angle, DeformType, Interp);
+        }
+        else {
+            /* the plan is built once for all slices */
+            int *Index = (int*) malloc((size_t)dimX*dimY*sizeof(int));
+            float *Weights = (float*) malloc(4*(size_t)dimX*dimY*sizeof(float));
+            DeformObject_plan_core(Index, Weights, NULL, dimX, dimY, (float)RFP, (float)angle, DeformType);
+            DeformObject_apply_core(Index, Weights, NULL, A, B, dimX, dimY, Images);
+            free(Index); free(Weights);
+        }
+    }
+    else {
+        double *A = (double *) mxGetData(prhs[0]);
+        double *B = (double*)mxGetPr(plhs[0] = mxCreateNumericArray(number_of_dims, dim_array, mxDOUBLE_CLASS, mxREAL));
+        for(k=0; k<Images; k++) DeformObject_core_double(&A[(size_t)k*dimX*dimY], &B[(size_t)k*dimX*dimY], dimX, dimY, RFP, angle, DeformType);
     }
-}
-
-/* Related Functions */
-/*****************************************************************/
-double Deform_func(double *A, double *B, double *Tomorange_X_Ar, double H_x, double RFP, double angleRad, int DeformType, int dimX, int dimY)
-{
-    double i0,j0,xx, yy, xPersp, yPersp, xPersp1, yPersp1, u, v, ll, mm, Ar1step_inv, a, b, c, d;
-    int i,j,i1,j1,i2,j2;
-    Ar1step_inv = 1.0f/H_x;
-#pragma omp parallel for shared(A,B,Tomorange_X_Ar,Ar1step_inv) private(i,j,i1,j1,i2,j2,i0,j0,xx, yy, xPersp, yPersp, xPersp1, yPersp1, u, v, ll, mm, a, b, c, d )
-    for(i=0; i<dimX; i++) {
-        for(j=0; j<dimY; j++) {
-            xx = Tomorange_X_Ar[i]*cos(angleRad) + Tomorange_X_Ar[j]*sin(angleRad);
-            yy = -Tomorange_X_Ar[i]*sin(angleRad) + Tomorange_X_Ar[j]*cos(angleRad);
-            
-            if (DeformType == 0) {
-                /* do forward transform*/
-                xPersp1 = xx*(1.0f - yy*RFP);
-                yPersp1 = yy;
-                xPersp = xPersp1*(1.0f - yPersp1*RFP)*cos(angleRad) - yPersp1*sin(angleRad);
-                yPersp = xPersp1*(1.0f - yPersp1*RFP)*sin(angleRad) + yPersp1*cos(angleRad);
-            }
-            else {
-                /* do inverse transform */
-                xPersp1 = xx/(1.0f - yy*RFP);
-                yPersp1 = yy;
-                xPersp = xPersp1/(1.0f - yPersp1*RFP)*cos(angleRad) - yPersp1*sin(angleRad);
-                yPersp = xPersp1/(1.0f - yPersp1*RFP)*sin(angleRad) + yPersp1*cos(angleRad);
-            }
-//             printf("%f %f \n", xPersp, yPersp);
-            /*Bilinear 2D Interpolation */
-            ll = (xPersp - (-1.0f))*Ar1step_inv;
-            mm = (yPersp - (-1.0f))*Ar1step_inv;
-            
-            i0 = (double)floor((double)ll);
-            j0 = (double)floor((double)mm);
-            u = ll - i0;
-            v = mm - j0;
-            
-            i2 = (int)i0;
-            j2 = (int)j0;
-            
-            i1 = i2+1;
-            j1 = j2+1;
-            
-            a = 0.0f; b = 0.0f; c = 0.0f; d = 0.0f;
-            
-            if ((i2 >= 0) && (i2 < dimX) && (j2 >= 0) && (j2 < dimX))   a = A[(i2)*dimY + (j2)];
-            if ((i2 >= 0) && (i2 < dimX-1) && (j2 >= 0) && (j2 < dimX)) b = A[(i1)*dimY + (j2)];
-            if ((i2 >= 0) && (i2 < dimX) && (j2 >= 0) && (j2 < dimX-1)) c = A[(i2)*dimY + (j1)];
-            if ((i2 >= 0) && (i2 < dimX-1) && (j2 >= 0) && (j2 < dimX-1))  d = A[(i1)*dimY + (j1)];
-            
-            B[(i)*dimY + (j)] = (1.0f - u)*(1.0f - v)*a + u*(1.0f - v)*b + (1.0f - u)*v*c+ u*v*d;
-            
-        }}
-    return *B;
 }
@@ -0,0 +1,682 @@
+/*
+ * Copyright 2017 Daniil Kazantsev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DeformObject_core.h"
+#include "utils.h"
+
+#define M_PI 3.14159265358979323846
+
+/* Functions to perform the forward/inverse deformation of 2D images according to [1]
+ *
+ * The image A (dimX x dimY, A[i*dimY + j]) is resampled at the deformed positions of the pixels
+ * x = -Cx + i*H, y = -Cy + j*H, H = 2/max(dimX, dimY), Cx = dimX*H/2, Cy = dimY*H/2 (x = -1 + i*H, y = -1 + j*H
+ * for the square images, the non-square images have square pixels and the longer side is [-1, 1]), the rotation
+ * by the deformation angle is hoisted out of the loops (the rotated coordinates of a row are the sum of a row term
+ * and a precomputed column term). In single precision the bilinear interpolation is branch-free: the indices of the
+ * four taps are clamped and the taps outside of the image are replaced by zeros, so the loops over the rows are
+ * vectorised (with gathers on AVX2). The images have less than 2^31 pixels.
+ *
+ * Input Parameters:
+ * 1. A - image to deform (dimX x dimY)
+ * 2. RFP - propotional to the focal point distance
+ * 3. Angle - deformation angle in degrees
+ * 4. DeformType - deformation type, 0 - forward, 1 - inverse
+ *
+ * Output:
+ * 1. B - deformed image (dimX x dimY)
+ *
+ * References:
+ * [1] D. Kazantsev & V. Pickalov, "New iterative reconstruction methods for fan-beam tomography" IPSE, 2017
+ */
+
+UTILS_INLINE float deform_bilinear_f(const float *A, int dimX, int dimY, float ll, float mm)
+{
+    int i1, j1, i2, j2, vi2, vi1, vj2, vj1;
+    float u, v, a, b, c, d;
+    /* the coordinates far outside of the image (and NaN) are moved next to it, where all taps are zero */
+    ll = (ll > -2.0f) ? ll : -2.0f;
+    ll = (ll < (float)dimX + 1.0f) ? ll : (float)dimX + 1.0f;
+    mm = (mm > -2.0f) ? mm : -2.0f;
+    mm = (mm < (float)dimY + 1.0f) ? mm : (float)dimY + 1.0f;
+    i2 = (int)ll;
+    i2 = i2 - ((float)i2 > ll);
+    j2 = (int)mm;
+    j2 = j2 - ((float)j2 > mm);
+    u = ll - (float)i2;
+    v = mm - (float)j2;
+    vi2 = (i2 >= 0) & (i2 < dimX);
+    vi1 = (i2 >= 0) & (i2 < dimX-1);
+    vj2 = (j2 >= 0) & (j2 < dimY);
+    vj1 = (j2 >= 0) & (j2 < dimY-1);
+    i1 = clamp_index(i2+1, dimX);
+    j1 = clamp_index(j2+1, dimY);
+    i2 = clamp_index(i2, dimX);
+    j2 = clamp_index(j2, dimY);
+    /* the clamped loads of interp_linear (utils.h) in 2D, the masks keep the border taps of the former
+     * mex-function (the taps i2+1, j2+1 are zero for i2 < 0, j2 < 0) */
+    a = A[i2*dimY + j2];
+    b = A[i1*dimY + j2];
+    c = A[i2*dimY + j1];
+    d = A[i1*dimY + j1];
+    a = (vi2 & vj2) ? a : 0.0f;
+    b = (vi1 & vj2) ? b : 0.0f;
+    c = (vi2 & vj1) ? c : 0.0f;
+    d = (vi1 & vj1) ? d : 0.0f;
+    return (1.0f - u)*(1.0f - v)*a + u*(1.0f - v)*b + (1.0f - u)*v*c + u*v*d;
+}
+
+/* the double precision interpolation keeps the branches of the former mex-function (the scalar loop is
+ * faster with them than with the clamped loads) */
+UTILS_INLINE double deform_bilinear_d(const double *A, int dimX, int dimY, double ll, double mm)
+{
+    int i1, j1, i2, j2;
+    double u, v, a, b, c, d, i0, j0;
+    i0 = floor(ll);
+    j0 = floor(mm);
+    u = ll - i0;
+    v = mm - j0;
+    /* the coordinates far outside of the image (and NaN) give zero */
+    if (!((i0 >= 0.0) && (i0 < (double)dimX) && (j0 >= 0.0) && (j0 < (double)dimY))) return 0.0;
+    i2 = (int)i0;
+    j2 = (int)j0;
+    i1 = i2+1;
+    j1 = j2+1;
+    a = A[(size_t)i2*dimY + j2];
+    b = (i2 < dimX-1) ? A[(size_t)i1*dimY + j2] : 0.0;
+    c = (j2 < dimY-1) ? A[(size_t)i2*dimY + j1] : 0.0;
+    d = ((i2 < dimX-1) && (j2 < dimY-1)) ? A[(size_t)i1*dimY + j1] : 0.0;
+    return (1.0f - u)*(1.0f - v)*a + u*(1.0f - v)*b + (1.0f - u)*v*c + u*v*d;
+}
+
+/* a tap of the higher order interpolations: A[Off + ii], zero outside of [0, Len) (the taps and the weights are
+ * written out and the indices are 32-bit offsets of A, so that the loops calling the interpolations are vectorised) */
+UTILS_INLINE float deform_tap_f(const float *A, int Off, int ii, int Len)
+{
+    float c = A[Off + clamp_index(ii, Len)];
+    return ((ii >= 0) & (ii < Len)) ? c : 0.0f;
+}
+
+/* the pole of the cubic B-spline prefilter */
+#define DEFORM_BSPLINE_POLE -0.267949192431123f
+
+/* the factor z^d of a coefficient d = 1, ..., 5 positions outside of [0, Len): the prefilter takes the image as zero
+ * outside, so its coefficients continue as c(-d) = z^d c(0) and c(Len-1+d) = z^d c(Len-1). z^d is the binomial sum
+ * of (1 + (z - 1))^d, which is exact for the integer d in [0, 5] and has no selects of floats, so that the loops
+ * calling it are vectorised. */
+UTILS_INLINE float deform_bspline_ext(int ii, int Len)
+{
+    const float y = DEFORM_BSPLINE_POLE - 1.0f;
+    int d = (-ii > ii - (Len - 1)) ? -ii : ii - (Len - 1);
+    float t;
+    d = (d > 0) ? d : 0;
+    t = (float)d;
+    return 1.0f + t*y*(1.0f + (t - 1.0f)*(1.0f/2.0f)*y*(1.0f + (t - 2.0f)*(1.0f/3.0f)*y*(1.0f + (t - 3.0f)*(1.0f/4.0f)*y*(1.0f + (t - 4.0f)*(1.0f/5.0f)*y))));
+}
+
+/* the row jj of the cubic B-spline coefficients Ct at the taps i0 - 1, ..., i0 + 2 (the rows and taps outside of
+ * the image are the clamped ones times deform_bspline_ext) */
+UTILS_INLINE float deform_bspline_row(const float *Ct, int dimX, int dimY, int i0, int jj, float w0, float w1, float w2, float w3)
+{
+    int Off = clamp_index(jj, dimY)*dimX;
+    return w0*deform_bspline_ext(i0 - 1, dimX)*Ct[Off + clamp_index(i0 - 1, dimX)] + w1*deform_bspline_ext(i0, dimX)*Ct[Off + clamp_index(i0, dimX)] +
+            w2*deform_bspline_ext(i0 + 1, dimX)*Ct[Off + clamp_index(i0 + 1, dimX)] + w3*deform_bspline_ext(i0 + 2, dimX)*Ct[Off + clamp_index(i0 + 2, dimX)];
+}
+
+/* the cubic B-spline interpolation of the coefficients Ct (transposed, Ct[j*dimX + i], see deform_bspline_coefficients),
+ * the 4 x 4 taps outside of the image are extended as the prefilter assumes (see deform_bspline_ext), so the
+ * interpolation reproduces the border pixels and is zero at the pixel positions outside of the image */
+UTILS_INLINE float deform_bspline_f(const float *Ct, int dimX, int dimY, float ll, float mm)
+{
+    int i0, j0;
+    float u, v, u2, v2, wu0, wu1, wu2, wu3, wv0, wv1, wv2, wv3;
+    ll = (ll > -3.0f) ? ll : -3.0f;
+    ll = (ll < (float)dimX + 2.0f) ? ll : (float)dimX + 2.0f;
+    mm = (mm > -3.0f) ? mm : -3.0f;
+    mm = (mm < (float)dimY + 2.0f) ? mm : (float)dimY + 2.0f;
+    i0 = (int)ll;
+    i0 = i0 - ((float)i0 > ll);
+    j0 = (int)mm;
+    j0 = j0 - ((float)j0 > mm);
+    u = ll - (float)i0;
+    v = mm - (float)j0;
+    u2 = u*u;
+    v2 = v*v;
+    wu0 = (1.0f - u)*(1.0f - u)*(1.0f - u)*(1.0f/6.0f);
+    wu1 = (3.0f*u2*u - 6.0f*u2 + 4.0f)*(1.0f/6.0f);
+    wu2 = (-3.0f*u2*u + 3.0f*u2 + 3.0f*u + 1.0f)*(1.0f/6.0f);
+    wu3 = u2*u*(1.0f/6.0f);
+    wv0 = (1.0f - v)*(1.0f - v)*(1.0f - v)*(1.0f/6.0f);
+    wv1 = (3.0f*v2*v - 6.0f*v2 + 4.0f)*(1.0f/6.0f);
+    wv2 = (-3.0f*v2*v + 3.0f*v2 + 3.0f*v + 1.0f)*(1.0f/6.0f);
+    wv3 = v2*v*(1.0f/6.0f);
+    /* the factors of the rows are arithmetic, the weights computed under a branch would not be vectorised */
+    wv0 *= deform_bspline_ext(j0 - 1, dimY);
+    wv1 *= deform_bspline_ext(j0, dimY);
+    wv2 *= deform_bspline_ext(j0 + 1, dimY);
+    wv3 *= deform_bspline_ext(j0 + 2, dimY);
+    return wv0*deform_bspline_row(Ct, dimX, dimY, i0, j0 - 1, wu0, wu1, wu2, wu3) + wv1*deform_bspline_row(Ct, dimX, dimY, i0, j0, wu0, wu1, wu2, wu3) +
+            wv2*deform_bspline_row(Ct, dimX, dimY, i0, j0 + 1, wu0, wu1, wu2, wu3) + wv3*deform_bspline_row(Ct, dimX, dimY, i0, j0 + 2, wu0, wu1, wu2, wu3);
+}
+
+/* sin(x) and cos(x) for 0 <= x <= pi/2 (Taylor polynomials, the error is below 1e-7) */
+UTILS_INLINE float deform_sinf(float x)
+{
+    float x2 = x*x;
+    return x*(1.0f + x2*(-1.0f/6.0f + x2*(1.0f/120.0f + x2*(-1.0f/5040.0f + x2*(1.0f/362880.0f + x2*(-1.0f/39916800.0f))))));
+}
+
+UTILS_INLINE float deform_cosf(float x)
+{
+    float x2 = x*x;
+    return 1.0f + x2*(-0.5f + x2*(1.0f/24.0f + x2*(-1.0f/720.0f + x2*(1.0f/40320.0f + x2*(-1.0f/3628800.0f)))));
+}
+
+/* the Lanczos-3 kernel sinc(x)*sinc(x/3) at x = u - k: sin(pi*x) = Sgn*sin(pi*u) and sin(pi*x/3) is the rotation
+ * of sin(pi*u/3), cos(pi*u/3) by -pi*k/3 (1 at x = 0, the mask is arithmetic, so that no division is branched) */
+UTILS_INLINE float deform_lanczos_weight(float x, float s1, float s3, float c3, float Sgn, float CosK, float SinK)
+{
+    float Zero = (float)(x*x <= 1.0e-12f);
+    return (1.0f - Zero)*3.0f*Sgn*s1*(s3*CosK - c3*SinK)/((float)(M_PI*M_PI)*x*x + Zero) + Zero;
+}
+
+/* the row ii of A at the taps j0 - 2, ..., j0 + 3 (the row is clamped, its weight is zero outside of the image) */
+UTILS_INLINE float deform_lanczos_row(const float *A, int dimX, int dimY, int ii, int j0, const float *W)
+{
+    int Off = clamp_index(ii, dimX)*dimY;
+    return W[0]*deform_tap_f(A, Off, j0 - 2, dimY) + W[1]*deform_tap_f(A, Off, j0 - 1, dimY) + W[2]*deform_tap_f(A, Off, j0, dimY) +
+            W[3]*deform_tap_f(A, Off, j0 + 1, dimY) + W[4]*deform_tap_f(A, Off, j0 + 2, dimY) + W[5]*deform_tap_f(A, Off, j0 + 3, dimY);
+}
+
+/* the 6 weights of the taps -2, ..., 3 at the fraction u, normalised to the sum 1 */
+UTILS_INLINE void deform_lanczos_weights(float u, float *W)
+{
+    float s1, s3, c3, Sum;
+    s1 = deform_sinf((float)M_PI*(0.5f - fabsf(u - 0.5f)));
+    s3 = deform_sinf((float)M_PI/3.0f*u);
+    c3 = deform_cosf((float)M_PI/3.0f*u);
+    W[0] = deform_lanczos_weight(u + 2.0f, s1, s3, c3, 1.0f, -0.5f, -0.866025404f);
+    W[1] = deform_lanczos_weight(u + 1.0f, s1, s3, c3, -1.0f, 0.5f, -0.866025404f);
+    W[2] = deform_lanczos_weight(u, s1, s3, c3, 1.0f, 1.0f, 0.0f);
+    W[3] = deform_lanczos_weight(u - 1.0f, s1, s3, c3, -1.0f, 0.5f, 0.866025404f);
+    W[4] = deform_lanczos_weight(u - 2.0f, s1, s3, c3, 1.0f, -0.5f, 0.866025404f);
+    W[5] = deform_lanczos_weight(u - 3.0f, s1, s3, c3, -1.0f, -1.0f, 0.0f);
+    Sum = 1.0f/(W[0] + W[1] + W[2] + W[3] + W[4] + W[5]);
+    W[0] *= Sum; W[1] *= Sum; W[2] *= Sum; W[3] *= Sum; W[4] *= Sum; W[5] *= Sum;
+}
+
+/* the Lanczos-3 interpolation of A, the 6 x 6 taps outside of the image are zero */
+UTILS_INLINE float deform_lanczos_f(const float *A, int dimX, int dimY, float ll, float mm)
+{
+    int i0, j0;
+    float Wu[6], Wv[6];
+    ll = (ll > -4.0f) ? ll : -4.0f;
+    ll = (ll < (float)dimX + 3.0f) ? ll : (float)dimX + 3.0f;
+    mm = (mm > -4.0f) ? mm : -4.0f;
+    mm = (mm < (float)dimY + 3.0f) ? mm : (float)dimY + 3.0f;
+    i0 = (int)ll;
+    i0 = i0 - ((float)i0 > ll);
+    j0 = (int)mm;
+    j0 = j0 - ((float)j0 > mm);
+    deform_lanczos_weights(ll - (float)i0, Wu);
+    deform_lanczos_weights(mm - (float)j0, Wv);
+    Wu[0] *= (float)((i0 - 2 >= 0) & (i0 - 2 < dimX));
+    Wu[1] *= (float)((i0 - 1 >= 0) & (i0 - 1 < dimX));
+    Wu[2] *= (float)((i0 >= 0) & (i0 < dimX));
+    Wu[3] *= (float)((i0 + 1 >= 0) & (i0 + 1 < dimX));
+    Wu[4] *= (float)((i0 + 2 >= 0) & (i0 + 2 < dimX));
+    Wu[5] *= (float)((i0 + 3 >= 0) & (i0 + 3 < dimX));
+    return Wu[0]*deform_lanczos_row(A, dimX, dimY, i0 - 2, j0, Wv) + Wu[1]*deform_lanczos_row(A, dimX, dimY, i0 - 1, j0, Wv) +
+            Wu[2]*deform_lanczos_row(A, dimX, dimY, i0, j0, Wv) + Wu[3]*deform_lanczos_row(A, dimX, dimY, i0 + 1, j0, Wv) +
+            Wu[4]*deform_lanczos_row(A, dimX, dimY, i0 + 2, j0, Wv) + Wu[5]*deform_lanczos_row(A, dimX, dimY, i0 + 3, j0, Wv);
+}
+
+/* The cubic B-spline prefilter (the recursive filter of the pole z = sqrt(3) - 2 in both directions) of the columns
+ * of C (Rows x Cols), the image is zero outside. The recursion runs along the rows, the columns are vectorised. */
+static void deform_bspline_prefilter(float *C, int Rows, int Cols)
+{
+    int i, j, jb, Block = 256;
+    const float z = DEFORM_BSPLINE_POLE;
+    const float zEnd = z/(z*z - 1.0f);
+    
+#pragma omp parallel for private(i,j,jb)
+    for(jb=0; jb<Cols; jb+=Block) {
+        int jEnd = (jb + Block < Cols) ? jb + Block : Cols;
+        /* causal */
+#pragma omp simd
+        for(j=jb; j<jEnd; j++) C[j] *= 6.0f;
+        for(i=1; i<Rows; i++) {
+#pragma omp simd
+            for(j=jb; j<jEnd; j++) C[(size_t)i*Cols + j] = 6.0f*C[(size_t)i*Cols + j] + z*C[(size_t)(i-1)*Cols + j];
+        }
+        /* anti-causal */
+#pragma omp simd
+        for(j=jb; j<jEnd; j++) C[(size_t)(Rows-1)*Cols + j] *= zEnd;
+        for(i=Rows-2; i>=0; i--) {
+#pragma omp simd
+            for(j=jb; j<jEnd; j++) C[(size_t)i*Cols + j] = z*(C[(size_t)(i+1)*Cols + j] - C[(size_t)i*Cols + j]);
+        }
+    }
+}
+
+/* the cubic B-spline coefficients Ct (dimY x dimX, transposed) of the image A (dimX x dimY): the columns are
+ * filtered, the result is transposed and the columns of the transposed image are filtered */
+static void deform_bspline_coefficients(const float *A, float *Ct, int dimX, int dimY)
+{
+    int i, j;
+    float *C = malloc((size_t)dimX*dimY*sizeof(float));
+    memcpy(C, A, (size_t)dimX*dimY*sizeof(float));
+    deform_bspline_prefilter(C, dimX, dimY);
+#pragma omp parallel for private(i,j)
+    for(j=0; j<dimY; j++) {
+        for(i=0; i<dimX; i++) Ct[(size_t)j*dimX + i] = C[(size_t)i*dimY + j];
+    }
+    free(C);
+    deform_bspline_prefilter(Ct, dimY, dimX);
+}
+
+/* the grid of the deformation in single precision: X[i] and the rotated column terms Ycs[j], Ysn[j],
+ * the pixels are square (the longer side of the image is [-1, 1]) and the grid is centred at (Cx, Cy) pixels */
+static void deform_grid_f(int dimX, int dimY, float Angle, float *X, float *Ycs, float *Ysn, float *cs, float *sn, float *Inv, float *Cx, float *Cy)
+{
+    int i, j;
+    int Dim = (dimX > dimY) ? dimX : dimY;
+    float H_x = 2.0f/(float)Dim;
+    double angleRad = Angle*(M_PI/180.0);
+    *cs = (float)cos(angleRad);
+    *sn = (float)sin(angleRad);
+    *Inv = 1.0f/H_x;
+    *Cx = (float)dimX/(float)Dim;
+    *Cy = (float)dimY/(float)Dim;
+    for(i=0; i<dimX; i++) X[i] = -(*Cx) + (float)i*H_x;
+    for(j=0; j<dimY; j++) {
+        Ycs[j] = (-(*Cy) + (float)j*H_x)*(*cs);
+        Ysn[j] = (-(*Cy) + (float)j*H_x)*(*sn);
+    }
+}
+
+/* the source positions (in pixels) L[j], M[j] of the row with X = Xi */
+static void deform_row_f(float Xi, const float *Ycs, const float *Ysn, int dimY, float RFP, float cs, float sn, float Inv, float Cx, float Cy, int DeformType, float *L, float *M)
+{
+    int j;
+    float xc = Xi*cs, xs = Xi*sn, xx, yy, s, t;
+    if (DeformType == 0) {
+        /* forward transform */
+#pragma omp simd private(xx,yy,s,t)
+        for(j=0; j<dimY; j++) {
+            xx = xc + Ysn[j];
+            yy = Ycs[j] - xs;
+            s = 1.0f - yy*RFP;
+            t = xx*s*s;
+            L[j] = (t*cs - yy*sn + Cx)*Inv;
+            M[j] = (t*sn + yy*cs + Cy)*Inv;
+        }
+    }
+    else {
+        /* inverse transform */
+#pragma omp simd private(xx,yy,s,t)
+        for(j=0; j<dimY; j++) {
+            xx = xc + Ysn[j];
+            yy = Ycs[j] - xs;
+            s = 1.0f - yy*RFP;
+            t = xx/(s*s);
+            L[j] = (t*cs - yy*sn + Cx)*Inv;
+            M[j] = (t*sn + yy*cs + Cy)*Inv;
+        }
+    }
+}
+
+float DeformObject_core(const float *A, float *B, int dimX, int dimY, float RFP, float Angle, int DeformType)
+{
+    int i, j;
+    float Inv, cs, sn, Cx, Cy, *X, *Ycs, *Ysn, *L, *M;
+    
+    X = malloc(dimX*sizeof(float));
+    Ycs = malloc(dimY*sizeof(float));
+    Ysn = malloc(dimY*sizeof(float));
+    deform_grid_f(dimX, dimY, Angle, X, Ycs, Ysn, &cs, &sn, &Inv, &Cx, &Cy);
+    
+#pragma omp parallel shared(A,B) private(i,j,L,M)
+    {
+        /* the source positions of a row */
+        L = malloc(dimY*sizeof(float));
+        M = malloc(dimY*sizeof(float));
+#pragma omp for
+        for(i=0; i<dimX; i++) {
+            deform_row_f(X[i], Ycs, Ysn, dimY, RFP, cs, sn, Inv, Cx, Cy, DeformType, L, M);
+#pragma omp simd
+            for(j=0; j<dimY; j++) B[(size_t)i*dimY + j] = deform_bilinear_f(A, dimX, dimY, L[j], M[j]);
+        }
+        free(L); free(M);
+    }
+    free(X); free(Ycs); free(Ysn);
+    return *B;
+}
+
+/* The deformation of DeformObject_core with the interpolation Interp: 0 - bilinear, 1 - cubic B-spline (the image is
+ * prefiltered into the spline coefficients first), 2 - Lanczos-3. The higher orders keep the small features and
+ * the forward/inverse deformations are close to the identity without supersampling. B can be A. */
+float DeformObject_core_interp(const float *A, float *B, int dimX, int dimY, float RFP, float Angle, int DeformType, int Interp)
+{
+    int i, j;
+    float Inv, cs, sn, Cx, Cy, *X, *Ycs, *Ysn, *L, *M, *C = NULL;
+    const float *Src = A;
+    
+    if ((Interp != 1) && (Interp != 2)) {
+        /* DeformObject_core reads the neighbours of A while writing B */
+        if (A == B) {
+            C = malloc((size_t)dimX*dimY*sizeof(float));
+            memcpy(C, A, (size_t)dimX*dimY*sizeof(float));
+            Src = C;
+        }
+        DeformObject_core(Src, B, dimX, dimY, RFP, Angle, DeformType);
+        if (C != NULL) free(C);
+        return *B;
+    }
+    if (Interp == 1) {
+        C = malloc((size_t)dimX*dimY*sizeof(float));
+        deform_bspline_coefficients(A, C, dimX, dimY);
+        Src = C;
+    }
+    else if (A == B) {
+        C = malloc((size_t)dimX*dimY*sizeof(float));
+        memcpy(C, A, (size_t)dimX*dimY*sizeof(float));
+        Src = C;
+    }
+    X = malloc(dimX*sizeof(float));
+    Ycs = malloc(dimY*sizeof(float));
+    Ysn = malloc(dimY*sizeof(float));
+    deform_grid_f(dimX, dimY, Angle, X, Ycs, Ysn, &cs, &sn, &Inv, &Cx, &Cy);
+    
+#pragma omp parallel shared(Src,B) private(i,j,L,M)
+    {
+        L = malloc(dimY*sizeof(float));
+        M = malloc(dimY*sizeof(float));
+#pragma omp for
+        for(i=0; i<dimX; i++) {
+            deform_row_f(X[i], Ycs, Ysn, dimY, RFP, cs, sn, Inv, Cx, Cy, DeformType, L, M);
+            if (Interp == 1) {
+#pragma omp simd
+                for(j=0; j<dimY; j++) B[(size_t)i*dimY + j] = deform_bspline_f(Src, dimX, dimY, L[j], M[j]);
+            }
+            else {
+#pragma omp simd
+                for(j=0; j<dimY; j++) B[(size_t)i*dimY + j] = deform_lanczos_f(Src, dimX, dimY, L[j], M[j]);
+            }
+        }
+        free(L); free(M);
+    }
+    free(X); free(Ycs); free(Ysn);
+    if (C != NULL) free(C);
+    return *B;
+}
+
+/* Builds the warp plan of a deformation (see DeformObject_core), so that the deformation of many images of the
+ * same geometry is a pass of gathers and multiply-adds (see DeformObject_apply_core):
+ * Index (dimX*dimY values) - the first pixel of the 2 x 2 block of the taps of every pixel,
+ * Weights (4*dimX*dimY values) - the weights of the pixels Index, Index + dimY, Index + 1, Index + dimY + 1
+ * (zero for the taps outside of the image), or if Weights is NULL,
+ * QWeights (4*dimX*dimY values) - the weights quantised to 16 bits (w*65535, the interior weights sum to 65535).
+ * The images have at least 2 x 2 pixels. The plan gives the values of DeformObject_core. */
+int DeformObject_plan_core(int *Index, float *Weights, unsigned short *QWeights, int dimX, int dimY, float RFP, float Angle, int DeformType)
+{
+    int i, j, n, t, i2, j2, ib, jb, Valid[4];
+    float Inv, cs, sn, Cx, Cy, *X, *Ycs, *Ysn, *L, *M, ll, mm, u, v, W[4], Tap[4], Sum;
+    long q, Q[4];
+    
+    if ((dimX < 2) || (dimY < 2)) {
+        printf("%s\n", "The images of a warp plan must be at least 2 x 2 pixels!");
+        return 1;
+    }
+    X = malloc(dimX*sizeof(float));
+    Ycs = malloc(dimY*sizeof(float));
+    Ysn = malloc(dimY*sizeof(float));
+    deform_grid_f(dimX, dimY, Angle, X, Ycs, Ysn, &cs, &sn, &Inv, &Cx, &Cy);
+    
+#pragma omp parallel private(i,j,n,t,i2,j2,ib,jb,Valid,L,M,ll,mm,u,v,W,Tap,Sum,q,Q)
+    {
+        L = malloc(dimY*sizeof(float));
+        M = malloc(dimY*sizeof(float));
+#pragma omp for
+        for(i=0; i<dimX; i++) {
+            deform_row_f(X[i], Ycs, Ysn, dimY, RFP, cs, sn, Inv, Cx, Cy, DeformType, L, M);
+            for(j=0; j<dimY; j++) {
+                n = i*dimY + j;
+                /* the taps of deform_bilinear_f */
+                ll = (L[j] > -2.0f) ? L[j] : -2.0f;
+                ll = (ll < (float)dimX + 1.0f) ? ll : (float)dimX + 1.0f;
+                mm = (M[j] > -2.0f) ? M[j] : -2.0f;
+                mm = (mm < (float)dimY + 1.0f) ? mm : (float)dimY + 1.0f;
+                i2 = (int)floorf(ll);
+                j2 = (int)floorf(mm);
+                u = ll - (float)i2;
+                v = mm - (float)j2;
+                Tap[0] = (1.0f - u)*(1.0f - v);
+                Tap[1] = u*(1.0f - v);
+                Tap[2] = (1.0f - u)*v;
+                Tap[3] = u*v;
+                Valid[0] = (i2 >= 0) && (i2 < dimX) && (j2 >= 0) && (j2 < dimY);
+                Valid[1] = (i2 >= 0) && (i2 < dimX-1) && (j2 >= 0) && (j2 < dimY);
+                Valid[2] = (i2 >= 0) && (i2 < dimX) && (j2 >= 0) && (j2 < dimY-1);
+                Valid[3] = (i2 >= 0) && (i2 < dimX-1) && (j2 >= 0) && (j2 < dimY-1);
+                /* the block is moved inside of the image, the valid taps keep their pixels */
+                ib = (i2 < 0) ? 0 : ((i2 > dimX-2) ? dimX-2 : i2);
+                jb = (j2 < 0) ? 0 : ((j2 > dimY-2) ? dimY-2 : j2);
+                W[0] = W[1] = W[2] = W[3] = 0.0f;
+                for(t=0; t<4; t++) {
+                    if (Valid[t]) W[(i2 + (t & 1) - ib) + 2*(j2 + (t >> 1) - jb)] = Tap[t];
+                }
+                Index[n] = ib*dimY + jb;
+                if (Weights != NULL) {
+                    for(t=0; t<4; t++) Weights[4*(size_t)n + t] = W[t];
+                }
+                else {
+                    Sum = 0.0f;
+                    for(t=0; t<4; t++) {
+                        Q[t] = lrintf(W[t]*65535.0f);
+                        Sum += W[t];
+                    }
+                    /* the rounding error is moved to the largest weight, so the sum is kept */
+                    q = lrintf(Sum*65535.0f) - (Q[0] + Q[1] + Q[2] + Q[3]);
+                    t = (W[0] >= W[1]) ? 0 : 1;
+                    t = (W[2] > W[t]) ? 2 : t;
+                    t = (W[3] > W[t]) ? 3 : t;
+                    Q[t] += q;
+                    for(t=0; t<4; t++) QWeights[4*(size_t)n + t] = (unsigned short)(Q[t] < 0 ? 0 : (Q[t] > 65535 ? 65535 : Q[t]));
+                }
+            }
+        }
+        free(L); free(M);
+    }
+    free(X); free(Ycs); free(Ysn);
+    return 0;
+}
+
+/* the row i of an image deformed with a warp plan */
+UTILS_INLINE void deform_apply_row(const int *Index, const float *Weights, const unsigned short *QWeights, const float *Ai, float *Bi, int dimY, int i)
+{
+    int j, n, k;
+    const float QScale = 1.0f/65535.0f;
+    if (Weights != NULL) {
+#pragma omp simd private(n,k)
+        for(j=0; j<dimY; j++) {
+            n = i*dimY + j;
+            k = Index[n];
+            Bi[n] = Weights[4*(size_t)n]*Ai[k] + Weights[4*(size_t)n + 1]*Ai[k + dimY] + Weights[4*(size_t)n + 2]*Ai[k + 1] + Weights[4*(size_t)n + 3]*Ai[k + dimY + 1];
+        }
+    }
+    else {
+#pragma omp simd private(n,k)
+        for(j=0; j<dimY; j++) {
+            n = i*dimY + j;
+            k = Index[n];
+            Bi[n] = QScale*((float)QWeights[4*(size_t)n]*Ai[k] + (float)QWeights[4*(size_t)n + 1]*Ai[k + dimY] + (float)QWeights[4*(size_t)n + 2]*Ai[k + 1] + (float)QWeights[4*(size_t)n + 3]*Ai[k + dimY + 1]);
+        }
+    }
+}
+
+/* Deforms the Images images of A (Images x dimX x dimY, e.g. the slices of a volume) into B with the warp plan
+ * of DeformObject_plan_core (Weights or QWeights, the other one is NULL). B can be A (in place): then every thread
+ * deforms whole images from a copy of the image, so only one image per thread is kept in memory. */
+float DeformObject_apply_core(const int *Index, const float *Weights, const unsigned short *QWeights, const float *A, float *B, int dimX, int dimY, int Images)
+{
+    int r, i, k;
+    size_t Size = (size_t)dimX*dimY;
+    float *Copy;
+    
+    if (A != B) {
+#pragma omp parallel for shared(A,B) private(r)
+        for(r=0; r<Images*dimX; r++) deform_apply_row(Index, Weights, QWeights, &A[(size_t)(r/dimX)*Size], &B[(size_t)(r/dimX)*Size], dimY, r % dimX);
+    }
+    else {
+#pragma omp parallel shared(B) private(i,k,Copy)
+        {
+            Copy = malloc(Size*sizeof(float));
+#pragma omp for
+            for(k=0; k<Images; k++) {
+                memcpy(Copy, &B[(size_t)k*Size], Size*sizeof(float));
+                for(i=0; i<dimX; i++) deform_apply_row(Index, Weights, QWeights, Copy, &B[(size_t)k*Size], dimY, i);
+            }
+            free(Copy);
+        }
+    }
+    return *B;
+}
+
+/* The fan-beam pipeline of [1]: the fan-beam projection of A (N x N) at the angle Th[a] (in degrees) is the parallel
+ * projection (along the rows of the rotated grid) of A deformed with the forward transform of the angle Th[a].
+ * The deformation and the integration are fused, no deformed images are formed:
+ * S[a*N + p] = sum_q A(deformed position of (X[p], Y[q])), the line integrals in pixels (N detectors on the image grid).
+ * The angles are computed in parallel, the detector pixels of a ray step are vectorised. */
+float DeformSino_core(const float *A, float *S, int N, float RFP, const float *Th, int AngTot)
+{
+    int a, p, q;
+    float H_x, Inv, cs, sn, yy, s2, t, ll, mm, *X, *Row;
+    
+    H_x = 2.0f/(float)N;
+    Inv = 1.0f/H_x;
+    X = malloc(N*sizeof(float));
+    for(p=0; p<N; p++) X[p] = -1.0f + (float)p*H_x;
+    
+#pragma omp parallel shared(A,S,X) private(a,p,q,cs,sn,yy,s2,t,ll,mm,Row)
+    {
+#pragma omp for
+        for(a=0; a<AngTot; a++) {
+            cs = (float)cos(Th[a]*(M_PI/180.0));
+            sn = (float)sin(Th[a]*(M_PI/180.0));
+            Row = &S[(size_t)a*N];
+            for(p=0; p<N; p++) Row[p] = 0.0f;
+            for(q=0; q<N; q++) {
+                yy = X[q];
+                s2 = (1.0f - yy*RFP)*(1.0f - yy*RFP);
+#pragma omp simd private(t,ll,mm)
+                for(p=0; p<N; p++) {
+                    t = X[p]*s2;
+                    ll = (t*cs - yy*sn + 1.0f)*Inv;
+                    mm = (t*sn + yy*cs + 1.0f)*Inv;
+                    Row[p] += deform_bilinear_f(A, N, N, ll, mm);
+                }
+            }
+        }
+    }
+    free(X);
+    return *S;
+}
+
+/* The inverse pipeline of DeformSino_core: the rows of the sinogram S (AngTot x N) are smeared back along the rays
+ * and deformed with the inverse transform, i.e. every pixel of B (N x N) sums the linearly interpolated values of the
+ * detector positions xx/(1 - yy*RFP)^2 of its rotated coordinates (xx, yy) over the angles (the unfiltered
+ * backprojection matching the projection). The rows of B are computed in parallel. */
+float DeformBackproj_core(const float *S, float *B, int N, float RFP, const float *Th, int AngTot)
+{
+    int i, j, a;
+    float H_x, Inv, cs, sn, xx, yy, s, pp, *X, *Cs, *Sn, *Row;
+    const float *Sa;
+    
+    H_x = 2.0f/(float)N;
+    Inv = 1.0f/H_x;
+    X = malloc(N*sizeof(float));
+    Cs = malloc(AngTot*sizeof(float));
+    Sn = malloc(AngTot*sizeof(float));
+    for(i=0; i<N; i++) X[i] = -1.0f + (float)i*H_x;
+    for(a=0; a<AngTot; a++) {
+        Cs[a] = (float)cos(Th[a]*(M_PI/180.0));
+        Sn[a] = (float)sin(Th[a]*(M_PI/180.0));
+    }
+    
+#pragma omp parallel for shared(S,B,X,Cs,Sn) private(i,j,a,cs,sn,xx,yy,s,pp,Row,Sa)
+    for(i=0; i<N; i++) {
+        Row = &B[(size_t)i*N];
+        for(j=0; j<N; j++) Row[j] = 0.0f;
+        for(a=0; a<AngTot; a++) {
+            cs = Cs[a]; sn = Sn[a];
+            Sa = &S[(size_t)a*N];
+#pragma omp simd private(xx,yy,s,pp)
+            for(j=0; j<N; j++) {
+                xx = X[i]*cs + X[j]*sn;
+                yy = X[j]*cs - X[i]*sn;
+                s = 1.0f - yy*RFP;
+                pp = (xx/(s*s) + 1.0f)*Inv;
+                Row[j] += interp_linear(Sa, N, pp);
+            }
+        }
+    }
+    free(X); free(Cs); free(Sn);
+    return *B;
+}
+
+/* the same in double precision (the values are the ones of the former double precision mex-function) */
+double DeformObject_core_double(const double *A, double *B, int dimX, int dimY, double RFP, double Angle, int DeformType)
+{
+    int i, j;
+    double H_x, Inv, cs, sn, xx, yy, xPersp1, xPersp, yPersp, Cx, Cy, *X, *Y;
+    double angleRad = Angle*(M_PI/180.0f);
+    int Dim = (dimX > dimY) ? dimX : dimY;
+    
+    cs = cos(angleRad);
+    sn = sin(angleRad);
+    H_x = 2.0/(double)Dim;
+    Inv = 1.0f/H_x;
+    Cx = (double)dimX/(double)Dim;
+    Cy = (double)dimY/(double)Dim;
+    X = malloc(dimX*sizeof(double));
+    Y = malloc(dimY*sizeof(double));
+    for(i=0; i<dimX; i++) X[i] = -Cx + (double)i*H_x;
+    for(j=0; j<dimY; j++) Y[j] = -Cy + (double)j*H_x;
+    
+#pragma omp parallel for shared(A,B) private(i,j,xx,yy,xPersp1,xPersp,yPersp)
+    for(i=0; i<dimX; i++) {
+        if (DeformType == 0) {
+            for(j=0; j<dimY; j++) {
+                xx = X[i]*cs + Y[j]*sn;
+                yy = -X[i]*sn + Y[j]*cs;
+                xPersp1 = xx*(1.0f - yy*RFP);
+                xPersp = xPersp1*(1.0f - yy*RFP)*cs - yy*sn;
+                yPersp = xPersp1*(1.0f - yy*RFP)*sn + yy*cs;
+                B[(size_t)i*dimY + j] = deform_bilinear_d(A, dimX, dimY, (xPersp + Cx)*Inv, (yPersp + Cy)*Inv);
+            }
+        }
+        else {
+            for(j=0; j<dimY; j++) {
+                xx = X[i]*cs + Y[j]*sn;
+                yy = -X[i]*sn + Y[j]*cs;
+                xPersp1 = xx/(1.0f - yy*RFP);
+                xPersp = xPersp1/(1.0f - yy*RFP)*cs - yy*sn;
+                yPersp = xPersp1/(1.0f - yy*RFP)*sn + yy*cs;
+                B[(size_t)i*dimY + j] = deform_bilinear_d(A, dimX, dimY, (xPersp + Cx)*Inv, (yPersp + Cy)*Inv);
+            }
+        }
+    }
+    free(X); free(Y);
+    return *B;
+}
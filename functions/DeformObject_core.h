@@ -0,0 +1,37 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef DEFORMOBJECT_CORE_H
+#define DEFORMOBJECT_CORE_H
+
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+float DeformObject_core(const float *A, float *B, int dimX, int dimY, float RFP, float Angle, int DeformType);
+float DeformObject_core_interp(const float *A, float *B, int dimX, int dimY, float RFP, float Angle, int DeformType, int Interp);
+int DeformObject_plan_core(int *Index, float *Weights, unsigned short *QWeights, int dimX, int dimY, float RFP, float Angle, int DeformType);
+float DeformObject_apply_core(const int *Index, const float *Weights, const unsigned short *QWeights, const float *A, float *B, int dimX, int dimY, int Images);
+float DeformSino_core(const float *A, float *S, int N, float RFP, const float *Th, int AngTot);
+float DeformBackproj_core(const float *S, float *B, int N, float RFP, const float *Th, int AngTot);
+double DeformObject_core_double(const double *A, double *B, int dimX, int dimY, double RFP, double Angle, int DeformType);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,79 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mex.h"
+#include <matrix.h>
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "DeformObject_core.h"
+
+/* C-OMP Mex-function to build the warp plan of the deformation [1] of DeformObject_C, the plan deforms
+ * many images of the same geometry with DeformObject_C(A, Index, Weights) (single A, N x M or N x M x K)
+ *
+ * Input Parameters:
+ * 1. Dims - the image size [N M], i.e. size(A)
+ * 2. RFP - propotional to the focal point distance
+ * 3. AngleTransform - deformation angle in degrees
+ * 4. DeformType - deformation type, 0 - forward, 1 - inverse
+ * 5. Quantised - (optional) 1 to keep the weights in uint16, 0 (default) - single
+ *
+ * Output:
+ * 1. Index - int32 indices of the 2 x 2 blocks of the interpolation (N x M)
+ * 2. Weights - the 4 weights of every pixel (4 x N x M)
+ *
+ * to compile with OMP support: mex DeformPlan_C.c DeformObject_core.c CFLAGS="\$CFLAGS -fopenmp -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+ * References:
+ * [1] D. Kazantsev & V. Pickalov, "New iterative reconstruction methods for fan-beam tomography" IPSE, 2017
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int dimX, dimY, DeformType, Quantised;
+    mwSize dims[2], wdims[3];
+    double RFP, angle, *Dims;
+    
+    /*Handling Matlab input data*/
+    if ((nrhs != 4) && (nrhs != 5)) mexErrMsgTxt("Input of 4 or 5 parameters is required");
+    if (mxGetNumberOfElements(prhs[0]) != 2) mexErrMsgTxt("The image size must be given as [N M]");
+    
+    Dims = (double *) mxGetPr(prhs[0]);
+    RFP =  (double) mxGetScalar(prhs[1]); /*  propotional to focal point distance*/
+    angle =  (double) mxGetScalar(prhs[2]); /*  deformation angle in degrees */
+    DeformType =  (int) mxGetScalar(prhs[3]); /* deformation type, 0 - forward, 1 - inverse  */
+    Quantised = (nrhs == 5) ? (int) mxGetScalar(prhs[4]) : 0;
+    
+    /* the columns of the MATLAB arrays are contiguous (the rows of the cores, see DeformObject_C) */
+    dimX = (int)Dims[1]; dimY = (int)Dims[0];
+    if ((dimX < 2) || (dimY < 2)) mexErrMsgTxt("The images of a warp plan must be at least 2 x 2 pixels");
+    
+    /*Handling Matlab output data*/
+    dims[0] = dimY; dims[1] = dimX;
+    wdims[0] = 4; wdims[1] = dimY; wdims[2] = dimX;
+    int *Index = (int*)mxGetData(plhs[0] = mxCreateNumericArray(2, dims, mxINT32_CLASS, mxREAL));
+    if (Quantised == 1) {
+        unsigned short *QWeights = (unsigned short*)mxGetData(plhs[1] = mxCreateNumericArray(3, wdims, mxUINT16_CLASS, mxREAL));
+        DeformObject_plan_core(Index, NULL, QWeights, dimX, dimY, (float)RFP, (float)angle, DeformType);
+    }
+    else {
+        float *Weights = (float*)mxGetData(plhs[1] = mxCreateNumericArray(3, wdims, mxSINGLE_CLASS, mxREAL));
+        DeformObject_plan_core(Index, Weights, NULL, dimX, dimY, (float)RFP, (float)angle, DeformType);
+    }
+}
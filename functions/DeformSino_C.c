@@ -0,0 +1,77 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mex.h"
+#include <matrix.h>
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "DeformObject_core.h"
+
+/* C-OMP Mex-function to compute the fan-beam sinogram of an image with the deformation transform [1] (the projection
+ * of the deformed image for every angle, fused in one pass) or the matching inverse pipeline (backprojection)
+ *
+ * Input Parameters:
+ * 1. A - image (N x N) to project or sinogram (N x length(Th)) to backproject, single
+ * 2. RFP - propotional to the focal point distance
+ * 3. Th - projection angles in degrees, single
+ * 4. Direction - 0 - projection (default), 1 - backprojection
+ *
+ * Output:
+ * 1. Fan-beam sinogram (N x length(Th)) or backprojected image (N x N), single
+ *
+ * to compile with OMP support: mex DeformSino_C.c DeformObject_core.c CFLAGS="\$CFLAGS -fopenmp -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+ * References:
+ * [1] D. Kazantsev & V. Pickalov, "New iterative reconstruction methods for fan-beam tomography" IPSE, 2017
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int N, AngTot, Direction;
+    const mwSize  *dim_array;
+    mwSize dims[2];
+    float RFP, *A, *Th;
+    
+    /*Handling Matlab input data*/
+    if ((nrhs != 3) && (nrhs != 4)) mexErrMsgTxt("Input of 3 or 4 parameters is required: Image/Sinogram, RFP, Angles, Direction");
+    if (mxGetClassID(prhs[0]) != mxSINGLE_CLASS) mexErrMsgTxt("The image (sinogram) must be in a single precision");
+    if (mxGetClassID(prhs[2]) != mxSINGLE_CLASS) mexErrMsgTxt("The vector of angles must be in a single precision");
+    if (mxGetNumberOfDimensions(prhs[0]) != 2) mexErrMsgTxt("The input must be 2D");
+    
+    dim_array = mxGetDimensions(prhs[0]);
+    A = (float *) mxGetData(prhs[0]);
+    RFP = (float) mxGetScalar(prhs[1]); /*  propotional to focal point distance*/
+    Th = (float *) mxGetData(prhs[2]); /* angles */
+    AngTot = (int) mxGetNumberOfElements(prhs[2]);
+    Direction = (nrhs == 4) ? (int) mxGetScalar(prhs[3]) : 0;
+    N = dim_array[0];
+    
+    /*Handling Matlab output data*/
+    if (Direction == 0) {
+        if (dim_array[1] != (mwSize)N) mexErrMsgTxt("The image must be N x N");
+        dims[0] = N; dims[1] = AngTot;
+        DeformSino_core(A, (float*)mxGetData(plhs[0] = mxCreateNumericArray(2, dims, mxSINGLE_CLASS, mxREAL)), N, RFP, Th, AngTot);
+    }
+    else {
+        if (dim_array[1] != (mwSize)AngTot) mexErrMsgTxt("The sinogram must be N x length(Th)");
+        dims[0] = N; dims[1] = N;
+        DeformBackproj_core(A, (float*)mxGetData(plhs[0] = mxCreateNumericArray(2, dims, mxSINGLE_CLASS, mxREAL)), N, RFP, Th, AngTot);
+    }
+}
@@ -0,0 +1,78 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mex.h"
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "FBP_core.h"
+
+/* Function to reconstruct 2D images (or 3D volumes slice by slice) from the parallel beam sinograms of buildSino2D
+ * and buildSino3D with the filtered backprojection (the ramp filter), the reference reconstruction without
+ * external toolboxes (MATLAB wrapper)
+ *
+ * Input Parameters:
+ * 1. Sinogram [P, length(Th)] or [P, length(Th), slices], single [required]
+ * 2. Projection angles Th (in degrees, over 180 or 360 degrees), single [required]
+ * 3. ImageSize in pixels (N x N) [required]
+ * 4. ImageCentring of the sinogram, choose 'radon' or 'astra' (default) [optional]
+ *
+ * Output:
+ * 1. The reconstructed image N x N (or the volume N x N x slices)
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int number_of_dims, N, P, CenTypeIn, AngTot, Slices;
+    float *A, *Sino, *Th;
+    const mwSize *dim_array;
+    
+    /*Handling Matlab input data*/
+    if ((nrhs < 3) || (nrhs > 4)) mexErrMsgTxt("Input of 3 or 4 parameters is required: Sinogram, Projection angles, ImageSize, Centering");
+    if (mxGetClassID(prhs[0]) != mxSINGLE_CLASS) mexErrMsgTxt("The sinogram must be in a single precision");
+    if (mxGetClassID(prhs[1]) != mxSINGLE_CLASS) mexErrMsgTxt("The vector of angles must be in a single precision");
+    
+    Sino = (float*) mxGetData(prhs[0]);
+    number_of_dims = mxGetNumberOfDimensions(prhs[0]);
+    dim_array = mxGetDimensions(prhs[0]);
+    Th = (float*) mxGetData(prhs[1]); /* angles */
+    N = (int) mxGetScalar(prhs[2]); /* choosen dimension (N x N) */
+    CenTypeIn = 1; /* astra-type centering is the default one */
+    
+    if (nrhs == 4)  {
+        char *CenType;
+        CenType = mxArrayToString(prhs[3]); /* 'radon' or 'astra' (default) */
+        if ((strcmp(CenType, "radon") != 0) && (strcmp(CenType, "astra") != 0)) mexErrMsgTxt("Choose 'radon' or 'astra''");
+        if (strcmp(CenType, "radon") == 0)  CenTypeIn = 0;  /* enable 'radon'-type centaering */
+        mxFree(CenType);
+    }
+    P = dim_array[0];
+    AngTot = (int)mxGetNumberOfElements(prhs[1]);
+    if ((number_of_dims < 2) || ((int)dim_array[1] != AngTot)) mexErrMsgTxt("The sinogram must be of the size [P, length(Th)] or [P, length(Th), slices]");
+    if ((P < 2) || (N < 1)) mexErrMsgTxt("The detector and the image sizes must be positive");
+    Slices = (number_of_dims == 3) ? dim_array[2] : 1;
+    
+    /*Handling Matlab output data*/
+    mwSize N_dims[] = {N, N, Slices};
+    A = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray((Slices > 1) ? 3 : 2, N_dims, mxSINGLE_CLASS, mxREAL));
+    
+    /* every image of the output is overwritten */
+    FBP_core(A, Sino, N, P, Th, AngTot, CenTypeIn, Slices);
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2017 Daniil Kazantsev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FBP_core.h"
+#include "utils.h"
+
+#define M_PI 3.14159265358979323846
+/* the rows of the image reconstructed together (a tile stays in the cache over all angles) */
+#define FBP_BLOCK 16
+
+/* Function to reconstruct the images (N x N) from the parallel beam sinograms of buildSino2D_core/buildSino3D_core
+ * with the filtered backprojection (the reference reconstruction without external toolboxes)
+ *
+ * The projections are filtered with the ramp (Ram-Lak) filter in the Fourier domain (radix-2 FFT of the zero
+ * padded projections, two real projections are filtered as one complex sequence). The backprojection is computed
+ * in tiles of FBP_BLOCK rows over all angles, the tiles of all slices in parallel, the rows of a tile are vectorised
+ * (the detector position is linear along a row).
+ *
+ * Input Parameters:
+ * 1. Sino - Slices x AngTot x P sinograms (the layout of buildSino3D_core, 2D: Slices = 1)
+ * 2. N - the size of the reconstructed images
+ * 3. Th - the projection angles in degrees (uniform over 180 or 360 degrees)
+ * 4. CenTypeIn - the centring of the sinograms: 0 - radon, 1 - astra (see buildSino2D_core)
+ *
+ * Output:
+ * 1. A - Slices x N x N images (the layout of buildPhantom3D_core)
+ */
+
+/* the in-place radix-2 FFT of the complex sequence (Re, Im) of the length Len (a power of 2), the twiddles
+ * Cs[k] = cos(2*pi*k/Len), Sn[k] = sin(2*pi*k/Len), k < Len/2; Inverse - the inverse transform (unscaled) */
+static void fbp_fft(float *Re, float *Im, int Len, const float *Cs, const float *Sn, int Inverse)
+{
+    int i, j, k, m, Half, Step;
+    float tr, ti, wr, wi;
+    /* the bit reversal */
+    for(i=1, j=0; i<Len; i++) {
+        m = Len >> 1;
+        for(; j & m; m >>= 1) j ^= m;
+        j |= m;
+        if (i < j) {
+            tr = Re[i]; Re[i] = Re[j]; Re[j] = tr;
+            ti = Im[i]; Im[i] = Im[j]; Im[j] = ti;
+        }
+    }
+    for(Half=1; Half<Len; Half<<=1) {
+        Step = Len/(2*Half);
+        for(i=0; i<Len; i+=2*Half) {
+            for(k=0; k<Half; k++) {
+                wr = Cs[k*Step];
+                wi = Inverse ? Sn[k*Step] : -Sn[k*Step];
+                j = i + k + Half;
+                tr = wr*Re[j] - wi*Im[j];
+                ti = wr*Im[j] + wi*Re[j];
+                Re[j] = Re[i+k] - tr;
+                Im[j] = Im[i+k] - ti;
+                Re[i+k] += tr;
+                Im[i+k] += ti;
+            }
+        }
+    }
+}
+
+float FBP_core(float *A, const float *Sino, int N, int P, const float *Th, int AngTot, int CenTypeIn, int Slices)
+{
+    int i, j, a, k, r, Len, NRows, NBlocks, t, ib;
+    float Pmax, H_p, H_x, Shift, Weight, *X, *Cs, *Sn, *Filter, *Q, *TwC, *TwS, *Re, *Im;
+    float T0, dT, *Row;
+    const float *Qa;
+    
+    /* the detector and the image grids of buildSino2D_core */
+    Pmax = (float)(P)/(float)(N+1);
+    H_p = 2.0f*Pmax/(float)(P-1);
+    H_x = 2.0f/(float)N;
+    Shift = (CenTypeIn == 0) ? H_x : 0.5f*H_x;
+    X = malloc(N*sizeof(float));
+    for(i=0; i<N; i++) X[i] = -1.0f + (float)i*H_x + Shift;
+    
+    /* the weight of an angle is pi/AngTot for the uniform angles over 180 degrees and over 360 degrees (the step
+     * is twice as large, every line is measured twice) */
+    Cs = malloc(AngTot*sizeof(float));
+    Sn = malloc(AngTot*sizeof(float));
+    for(a=0; a<AngTot; a++) {
+        Cs[a] = (float)cos(Th[a]*(M_PI/180.0));
+        Sn[a] = (float)sin(Th[a]*(M_PI/180.0));
+    }
+    Weight = (float)M_PI/(float)AngTot;
+    
+    /* the ramp filter: the transform of the Ram-Lak kernel of the spacing H_p, the sinograms in pixels are
+     * scaled to the units of [-1, 1] (2/N) */
+    for(Len=1; Len<2*P; Len<<=1);
+    TwC = malloc((Len/2 + 1)*sizeof(float));
+    TwS = malloc((Len/2 + 1)*sizeof(float));
+    for(k=0; k<Len/2; k++) {
+        TwC[k] = (float)cos(2.0*M_PI*k/Len);
+        TwS[k] = (float)sin(2.0*M_PI*k/Len);
+    }
+    Filter = calloc(Len, sizeof(float));
+    Re = calloc(Len, sizeof(float));
+    for(k=-Len/2+1; k<Len/2; k++) {
+        t = (k + Len) % Len;
+        if (k == 0) Re[t] = (float)(1.0/(4.0*H_p*H_p));
+        else if (k % 2 != 0) Re[t] = (float)(-1.0/(M_PI*M_PI*(double)k*k*H_p*H_p));
+        Filter[t] = 0.0f;
+    }
+    fbp_fft(Re, Filter, Len, TwC, TwS, 0);
+    for(k=0; k<Len; k++) Filter[k] = Re[k]*H_p*(2.0f/(float)N)/(float)Len;
+    free(Re);
+    
+    /* the filtered projections, two rows at a time */
+    NRows = Slices*AngTot;
+    Q = malloc((size_t)NRows*P*sizeof(float));
+#pragma omp parallel private(r,k,Re,Im)
+    {
+        Re = malloc(Len*sizeof(float));
+        Im = malloc(Len*sizeof(float));
+#pragma omp for
+        for(r=0; r<NRows; r+=2) {
+            for(k=0; k<Len; k++) Re[k] = Im[k] = 0.0f;
+            for(k=0; k<P; k++) Re[k] = Sino[(size_t)r*P + k];
+            if (r+1 < NRows) {
+                for(k=0; k<P; k++) Im[k] = Sino[(size_t)(r+1)*P + k];
+            }
+            fbp_fft(Re, Im, Len, TwC, TwS, 0);
+            /* the filter is real and even, so the real and the imaginary parts stay separated */
+            for(k=0; k<Len; k++) {
+                Re[k] *= Filter[k];
+                Im[k] *= Filter[k];
+            }
+            fbp_fft(Re, Im, Len, TwC, TwS, 1);
+            for(k=0; k<P; k++) Q[(size_t)r*P + k] = Re[k];
+            if (r+1 < NRows) {
+                for(k=0; k<P; k++) Q[(size_t)(r+1)*P + k] = Im[k];
+            }
+        }
+        free(Re); free(Im);
+    }
+    
+    /* the backprojection in tiles of FBP_BLOCK rows */
+    NBlocks = (N + FBP_BLOCK - 1)/FBP_BLOCK;
+#pragma omp parallel for shared(A,Q) private(t,k,ib,i,j,a,T0,dT,Row,Qa)
+    for(t=0; t<Slices*NBlocks; t++) {
+        k = t/NBlocks;
+        ib = (t % NBlocks)*FBP_BLOCK;
+        for(i=ib; (i<ib+FBP_BLOCK) && (i<N); i++) {
+            Row = &A[((size_t)k*N + i)*N];
+            for(j=0; j<N; j++) Row[j] = 0.0f;
+        }
+        for(a=0; a<AngTot; a++) {
+            Qa = &Q[((size_t)k*AngTot + a)*P];
+            /* the detector position (in pixels) of (X[i], X[j]) is T0 - j*dT */
+            dT = H_x*Sn[a]/H_p;
+            for(i=ib; (i<ib+FBP_BLOCK) && (i<N); i++) {
+                Row = &A[((size_t)k*N + i)*N];
+                T0 = (Pmax + X[i]*Cs[a] - X[0]*Sn[a])/H_p;
+#pragma omp simd
+                for(j=0; j<N; j++) Row[j] += Weight*interp_linear(Qa, P, T0 - (float)j*dT);
+            }
+        }
+    }
+    free(X); free(Cs); free(Sn); free(Filter); free(Q); free(TwC); free(TwS);
+    return *A;
+}
@@ -0,0 +1,189 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <mpi.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "buildPhantom3D_core.h"
+#include "buildSino3D_core.h"
+
+/* Distributed (MPI + OpenMP) generation of 3D phantoms and 3D sinograms from Phantom3DLibrary.dat
+ *
+ * The volume is decomposed along z, the sinogram along slices (default) or along angles. Every rank
+ * builds its block with the OpenMP cores and all ranks write collectively (MPI-IO) into one raw
+ * float32 file, which can then be memory-mapped (e.g. numpy.memmap).
+ *
+ * Build:
+ *   mpicc -fopenmp -O2 -fno-math-errno -std=c99 TomoPhantom3D_MPI.c buildPhantom3D_core.c buildSino3D_core.c utils.c -lm -o TomoPhantom3D_MPI
+ *
+ * Usage:
+ *   mpirun -np 4 ./TomoPhantom3D_MPI phantom ModelNo N Phantom3DLibrary.dat output.raw [-c slices]
+ *   mpirun -np 4 ./TomoPhantom3D_MPI sino ModelNo N P AngTot Phantom3DLibrary.dat output.raw [-c slices] [-s slices|angles] [-a angles.txt] [-radon]
+ *
+ * Input Parameters:
+ * 1. ModelNo - the model number from Phantom3DLibrary file
+ * 2. VolumeSize in voxels (N x N x N)
+ * 3. Detector array size P and the number of projection angles AngTot (sino only), the angles
+ *    are equally spaced in [0, 180) degrees or read from a text file given with -a
+ * 4. An absolute path to the file Phantom3DLibrary.dat
+ * 5. -c - the maximal number of slices built (and kept in memory) at once on a rank (default: all)
+ * 6. -s - decompose the sinogram along slices (default) or angles
+ * 7. -radon - matlab radon-iradon centring (default is astra)
+ *
+ * Output (raw float32, C-order):
+ * 1. The analytical phantom size of [N x N x N] or the 3D sinogram size of [N x AngTot x P]
+ */
+
+/* the part [*First, *Last) of Total items owned by the rank */
+static void block_range(int Total, int Rank, int Ranks, int *First, int *Last)
+{
+    *First = (int)(((long long)Total*Rank)/Ranks);
+    *Last = (int)(((long long)Total*(Rank+1))/Ranks);
+}
+
+int main(int argc, char *argv[])
+{
+    int Rank, Ranks, Sino, ModelSelected, N, P = 0, AngTot = 0, CenTypeIn = 1, SplitAngles = 0, Chunk = 0;
+    int Z1, Z2, Ang1, Ang2, NZ, NA, Chunks, MaxChunks, ii, i, argi;
+    char *LibraryPath, *OutputPath, *AnglesPath = NULL;
+    float *Th = NULL, *A = NULL;
+    double t0;
+    MPI_File fh;
+    MPI_Datatype slicetype;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &Rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &Ranks);
+
+    /* handling input */
+    Sino = (argc > 1) && (strcmp(argv[1], "sino") == 0);
+    if ((argc < 2) || (!Sino && strcmp(argv[1], "phantom") != 0) || (argc < (Sino ? 8 : 6))) {
+        if (Rank == 0) printf("Usage: %s phantom ModelNo N Phantom3DLibrary.dat output.raw [-c slices]\n"
+                "       %s sino ModelNo N P AngTot Phantom3DLibrary.dat output.raw [-c slices] [-s slices|angles] [-a angles.txt] [-radon]\n", argv[0], argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+    ModelSelected = atoi(argv[2]);
+    N = atoi(argv[3]);
+    if (Sino) {
+        P = atoi(argv[4]);
+        AngTot = atoi(argv[5]);
+        argi = 6;
+    }
+    else {
+        /* the phantom is written as a [N x N x N] "sinogram" */
+        P = N;
+        AngTot = N;
+        argi = 4;
+    }
+    LibraryPath = argv[argi++];
+    OutputPath = argv[argi++];
+    for(; argi<argc; argi++) {
+        if ((strcmp(argv[argi], "-c") == 0) && (argi+1 < argc)) Chunk = atoi(argv[++argi]);
+        else if ((strcmp(argv[argi], "-s") == 0) && (argi+1 < argc)) SplitAngles = (strcmp(argv[++argi], "angles") == 0);
+        else if ((strcmp(argv[argi], "-a") == 0) && (argi+1 < argc)) AnglesPath = argv[++argi];
+        else if (strcmp(argv[argi], "-radon") == 0) CenTypeIn = 0;
+        else {
+            if (Rank == 0) printf("%s %s\n", "Unknown option", argv[argi]);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    if ((N <= 0) || (P <= 0) || (AngTot <= 0)) {
+        if (Rank == 0) printf("%s\n", "The sizes must be positive");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    if (Sino) {
+        Th = malloc(AngTot*sizeof(float));
+        for(i=0; i<AngTot; i++) Th[i] = 180.0f*(float)i/(float)AngTot;
+        if (AnglesPath != NULL) {
+            FILE *fp = fopen(AnglesPath, "r");
+            if (fp == NULL) {
+                printf("%s %s\n", "Cannot open the file", AnglesPath);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            for(i=0; i<AngTot; i++) {
+                if (fscanf(fp, "%f", &Th[i]) != 1) {
+                    printf("%s %i %s\n", "Expected", AngTot, "angles in the angles file");
+                    MPI_Abort(MPI_COMM_WORLD, 1);
+                }
+            }
+            fclose(fp);
+        }
+    }
+
+    /* the block of slices [Z1, Z2) and angles [Ang1, Ang2) built by this rank */
+    if (Sino && SplitAngles) {
+        Z1 = 0; Z2 = N;
+        block_range(AngTot, Rank, Ranks, &Ang1, &Ang2);
+    }
+    else {
+        block_range(N, Rank, Ranks, &Z1, &Z2);
+        Ang1 = 0; Ang2 = AngTot;
+    }
+    NZ = Z2 - Z1;
+    NA = Ang2 - Ang1;
+    if ((Chunk <= 0) || (Chunk > NZ)) Chunk = NZ;
+    Chunks = (NZ > 0) && (NA > 0) ? (NZ + Chunk - 1)/Chunk : 0;
+    /* the writes are collective, so all ranks go through the same number of chunks */
+    MPI_Allreduce(&Chunks, &MaxChunks, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+
+    if (MPI_File_open(MPI_COMM_WORLD, OutputPath, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (Rank == 0) printf("%s %s\n", "Cannot open the output file", OutputPath);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_set_size(fh, (MPI_Offset)N*AngTot*P*sizeof(float));
+
+    /* one (block) slice in memory, so that the element count of a write stays small */
+    MPI_Type_contiguous(NA > 0 ? NA*P : 1, MPI_FLOAT, &slicetype);
+    MPI_Type_commit(&slicetype);
+    if (Chunks > 0) A = malloc((size_t)Chunk*NA*P*sizeof(float));
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    t0 = MPI_Wtime();
+    for(ii=0; ii<MaxChunks; ii++) {
+        int k1 = Z1 + ii*Chunk, k2 = k1 + Chunk;
+        if (k2 > Z2) k2 = Z2;
+        if ((ii < Chunks) && (k2 > k1)) {
+            int sizes[3] = {N, AngTot, P}, subsizes[3] = {k2 - k1, NA, P}, starts[3] = {k1, Ang1, 0};
+            MPI_Datatype filetype;
+
+            if (Sino) buildSino3D_core(A, ModelSelected, N, P, Th, AngTot, CenTypeIn, LibraryPath, 1, 1.0f, k1, k2, Ang1, Ang2, 0);
+            else buildPhantom3D_core(A, ModelSelected, N, LibraryPath, 1, 1.0f, k1, k2, 0);
+
+            MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, MPI_FLOAT, &filetype);
+            MPI_Type_commit(&filetype);
+            MPI_File_set_view(fh, 0, MPI_FLOAT, filetype, "native", MPI_INFO_NULL);
+            MPI_File_write_all(fh, A, k2 - k1, slicetype, MPI_STATUS_IGNORE);
+            MPI_Type_free(&filetype);
+        }
+        else {
+            /* nothing left on this rank, take part in the collective write only */
+            MPI_File_set_view(fh, 0, MPI_FLOAT, MPI_FLOAT, "native", MPI_INFO_NULL);
+            MPI_File_write_all(fh, A, 0, slicetype, MPI_STATUS_IGNORE);
+        }
+    }
+    MPI_File_close(&fh);
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (Rank == 0) printf("%s %i %s %i %s %.3f %s\n", "Built on", Ranks, "ranks x", omp_get_max_threads(), "threads in", MPI_Wtime() - t0, "s");
+
+    MPI_Type_free(&slicetype);
+    free(A); free(Th);
+    MPI_Finalize();
+    return 0;
+}
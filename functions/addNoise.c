@@ -0,0 +1,82 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mex.h"
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "noiseSino_core.h"
+
+/* Function to add the noise of a measurement to a sinogram (MATLAB wrapper), the noise is reproducible
+ * (counter-based random numbers) for any number of threads
+ *
+ * Input Parameters:
+ * 1. Sinogram [P, length(Th)] or [P, length(Th), slices], single [required]
+ * 2. I0 - the flat-field photon count (Poisson noise of the transmission I0*exp(-Scale*sinogram)), 0 - no Poisson noise [required]
+ * 3. Scale - the attenuation of one unit of the sinogram, e.g. 1/N for the sinograms of a phantom of size N [optional]
+ * 4. Sigma - the gaussian (electronic) noise, in counts (in the units of the sinogram if I0 is 0) [optional]
+ * 5. Seed - the seed of the random numbers [optional]
+ * 6. Zingers - [probability, amplitude] of the zingers [optional]
+ * 7. Stripes - [probability, strength] of the faulty detector pixels (the relative error of the gain) [optional]
+ *
+ * Output:
+ * 1. The noisy sinogram
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int number_of_dims, P, Rows;
+    unsigned int Seed;
+    float *A, I0, Scale, Sigma, ZingerProb, ZingerAmp, StripeProb, StripeStrength;
+    const mwSize *dim_array;
+    double *Par;
+    
+    /*Handling Matlab input data*/
+    if ((nrhs < 2) || (nrhs > 7)) mexErrMsgTxt("Input of 2 to 7 parameters is required: Sinogram, I0, Scale, Sigma, Seed, Zingers, Stripes");
+    if (mxGetClassID(prhs[0]) != mxSINGLE_CLASS) mexErrMsgTxt("The sinogram must be in a single precision");
+    
+    number_of_dims = mxGetNumberOfDimensions(prhs[0]);
+    dim_array = mxGetDimensions(prhs[0]);
+    I0 = (float) mxGetScalar(prhs[1]); /* flat-field counts */
+    Scale = (nrhs >= 3) ? (float) mxGetScalar(prhs[2]) : 1.0f;
+    Sigma = (nrhs >= 4) ? (float) mxGetScalar(prhs[3]) : 0.0f;
+    Seed = (nrhs >= 5) ? (unsigned int) mxGetScalar(prhs[4]) : 0;
+    ZingerProb = ZingerAmp = StripeProb = StripeStrength = 0.0f;
+    if (nrhs >= 6) {
+        if (mxGetNumberOfElements(prhs[5]) != 2) mexErrMsgTxt("Zingers must be given as [probability, amplitude]");
+        Par = mxGetPr(prhs[5]);
+        ZingerProb = (float)Par[0]; ZingerAmp = (float)Par[1];
+    }
+    if (nrhs == 7) {
+        if (mxGetNumberOfElements(prhs[6]) != 2) mexErrMsgTxt("Stripes must be given as [probability, strength]");
+        Par = mxGetPr(prhs[6]);
+        StripeProb = (float)Par[0]; StripeStrength = (float)Par[1];
+    }
+    if ((I0 > 0.0f) && (Scale <= 0.0f)) mexErrMsgTxt("The scale must be positive");
+    
+    /* the P detector pixels are the columns of the noise, the stripes are the same for all angles (and slices) */
+    P = dim_array[0];
+    Rows = (int)(mxGetNumberOfElements(prhs[0])/(P > 0 ? P : 1));
+    
+    /*Handling Matlab output data*/
+    A = (float*)mxGetData(plhs[0] = mxCreateNumericArray(number_of_dims, dim_array, mxSINGLE_CLASS, mxREAL));
+    memcpy(A, mxGetData(prhs[0]), mxGetNumberOfElements(prhs[0])*sizeof(float));
+    if (Rows*P > 0) noiseSino_core(A, Rows, P, I0, Scale, Sigma, ZingerProb, ZingerAmp, StripeProb, StripeStrength, Seed);
+}
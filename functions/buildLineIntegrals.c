@@ -0,0 +1,79 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mex.h"
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "lineIntegrals_core.h"
+
+/* Function to compute the exact line integrals of 2D or 3D models along arbitrary rays (MATLAB wrapper)
+ *
+ * Input Parameters:
+ * 1. Model number (see Phantom2DLibrary.dat or Phantom3DLibrary.dat) [required]
+ * 2. VolumeSize in voxels (N x N [x N]) [required]
+ * 3. Rays - [4 x NRays] (2D: px, py, dx, dy) or [6 x NRays] (3D: px, py, pz, dx, dy, dz) in single precision,
+ *    a point of every ray (outside of the objects) and its direction, in voxels relative to the centre
+ *    of the volume [required]
+ * 4. An absolute path to the file Phantom2DLibrary.dat or Phantom3DLibrary.dat (see OS-specific syntax-differences) [required]
+ * 5. VolumeCentring, choose 'radon' or 'astra' (default) [optional]
+ *
+ * Output:
+ * 1. The line integrals size of [1, NRays] (scaled as the sinograms)
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int ModelSelected, N, CenTypeIn, Dim;
+    float *A, *Rays;
+    mwSize NRays;
+    char *ModelParameters_PATH;
+    
+    /*Handling Matlab input data*/
+    if ((nrhs < 4) || (nrhs > 5)) mexErrMsgTxt("Input of 4 or 5 parameters is required: Model, VolumeSize, Rays, PATH, Centering");
+    if (mxGetClassID(prhs[2]) != mxSINGLE_CLASS) {mexErrMsgTxt("The rays must be in a single precision"); }
+    Dim = (int) mxGetM(prhs[2]);
+    if ((Dim != 4) && (Dim != 6)) {mexErrMsgTxt("The rays must be given as [4 x NRays] (2D) or [6 x NRays] (3D)"); }
+    
+    ModelSelected  = (int) mxGetScalar(prhs[0]); /* selected model */
+    N  = (int) mxGetScalar(prhs[1]); /* choosen dimension (N x N [x N]) */
+    Rays = (float*) mxGetData(prhs[2]); /* rays */
+    NRays = mxGetN(prhs[2]);
+    ModelParameters_PATH = mxArrayToString(prhs[3]); /* provide an absolute path to the file */
+    CenTypeIn = 1; /* astra-type centering is the default one */
+    
+    if (nrhs == 5)  {
+        char *CenType;
+        CenType = mxArrayToString(prhs[4]); /* 'radon' or 'astra' (default) */
+        if ((strcmp(CenType, "radon") != 0) && (strcmp(CenType, "astra") != 0)) mexErrMsgTxt("Choose 'radon' or 'astra''");
+        if (strcmp(CenType, "radon") == 0)  CenTypeIn = 0;  /* enable 'radon'-type centaering */
+        mxFree(CenType);
+    }
+    
+    /*Handling Matlab output data*/
+    mwSize N_dims[] = {1, NRays};
+    A = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray(2, N_dims, mxSINGLE_CLASS, mxREAL));
+    
+    /* the columns of Rays are the rays, i.e. the [NRays x Dim] C-order array */
+    if (Dim == 4) lineIntegrals2D_core(A, ModelSelected, N, Rays, (int)NRays, CenTypeIn, ModelParameters_PATH, 1, 1.0f);
+    else lineIntegrals3D_core(A, ModelSelected, N, Rays, (int)NRays, CenTypeIn, ModelParameters_PATH, 1, 1.0f);
+    
+    mxFree(ModelParameters_PATH);
+}
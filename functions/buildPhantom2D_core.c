@@ -18,6 +18,7 @@ limitations under the License.
 #include <stdio.h>
 #include "omp.h"
 #include "utils.h"
+#include "fastMath.h"
 
 #define M_PI 3.14159265358979323846
 
@@ -33,22 +34,32 @@ limitations under the License.
  * 7. a  - size object
  * 8. b  - size object
  * 9. phi_rot - rotation angle
+ * 10. Overwrite - 1: the object is written into A (the previous content is ignored, no zeroing
+ *     of A is needed), 0: the object is added to A
+ * 11. Fast - 1 - the approximations of expf and logf of fastMath.h, 0 - expf and logf of the C library (see
+ *     buildPhantom3D_core)
  *
  * Output:
  * 1. The analytical phantom size of [N x N]
  */
 
-float buildPhantom2D_core_single(float *A, int N,  int Object,
+/* buildPhantom2D_core_single_materials also stores the object of the given Material in the label map L
+ * and adds it to its map among the NumMaterials maps of M (both can be NULL, see store_material) in the
+ * same pass, the support
+ * of a gaussian is its part above the half of the maximum */
+float buildPhantom2D_core_single_materials(float *A, unsigned char *L, float *M, int NumMaterials, int Material, int N,  int Object,
         float C0, /* intensity */
         float x0, /* x0 position */
         float y0, /* y0 position */
         float a , /* a - size object */
         float b , /* b - size object */
-        float phi_rot /* phi - rotation angle */)
+        float phi_rot, /* phi - rotation angle */
+        int Overwrite, /* 1 - write into A, 0 - add to A */
+        int Fast /* 1 - the approximations of fastMath.h, 0 - expf and logf of the C library */)
 {
-    int i, j;
+    int i, j, In, Labelled = ((L != NULL) || (M != NULL));
     float *Tomorange_X_Ar=NULL, Tomorange_Xmin, Tomorange_Xmax, H_x, C1, a2, b2, phi_rot_radian, sin_phi, cos_phi;
-    float *Xdel = NULL, *Ydel = NULL, T;
+    float *Xdel = NULL, *Ydel = NULL, T, V;
     Tomorange_X_Ar = malloc(N*sizeof(float));
     Tomorange_Xmin = -1.0f;
     Tomorange_Xmax = 1.0f;
@@ -73,55 +84,76 @@ float buildPhantom2D_core_single(float *A, int N,  int Object,
     /* parameters of an object have been extracted, now run the building module */
     if (Object == 1) {
         /* The object is a gaussian */
-#pragma omp parallel for shared(A) private(i,j,T)
+#pragma omp parallel for shared(A) private(i,j,T,V)
         for(i=0; i<N; i++) {
-            for(j=0; j<N; j++) {
-                T = C1*(a2*powf((Xdel[i]*cos_phi + Ydel[j]*sin_phi),2) + b2*powf((-Xdel[i]*sin_phi + Ydel[j]*cos_phi),2));
-                A[i*N + j] += C0*expf(T);
-            }}
+            if (Fast && !Labelled) {
+                /* the approximation of expf is inlined, so the row is vectorised */
+#pragma omp simd private(T)
+                for(j=0; j<N; j++) {
+                    T = C1*(a2*powf((Xdel[i]*cos_phi + Ydel[j]*sin_phi),2) + b2*powf((-Xdel[i]*sin_phi + Ydel[j]*cos_phi),2));
+                    A[(size_t)i*N + j] = (Overwrite ? 0.0f : A[(size_t)i*N + j]) + C0*fast_expf(T);
+                }
+            }
+            else {
+                for(j=0; j<N; j++) {
+                    T = C1*(a2*powf((Xdel[i]*cos_phi + Ydel[j]*sin_phi),2) + b2*powf((-Xdel[i]*sin_phi + Ydel[j]*cos_phi),2));
+                    V = C0*expf(T);
+                    A[(size_t)i*N + j] = (Overwrite ? 0.0f : A[(size_t)i*N + j]) + V;
+                    if (Labelled) store_material(L, M, NumMaterials, (size_t)N*N, (size_t)i*N + j, V, T >= 0.25f*C1, Material, Overwrite);
+                }
+            }
+        }
     }
     else if (Object == 2) {
         /* the object is a parabola Lambda = 1/2 */
-#pragma omp parallel for shared(A) private(i,j,T)
+#pragma omp parallel for shared(A) private(i,j,T,In)
         for(i=0; i<N; i++) {
             for(j=0; j<N; j++) {
                 T = a2*powf((Xdel[i]*cos_phi + Ydel[j]*sin_phi),2) + b2*powf((-Xdel[i]*sin_phi + Ydel[j]*cos_phi),2);
-                if (T <= 1) T = C0*sqrtf(1.0f - T);
+                In = (T <= 1);
+                if (In) T = C0*sqrtf(1.0f - T);
                 else T = 0.0f;
-                A[(i)*N + (j)] += T;
+                A[(size_t)i*N + j] = (Overwrite ? 0.0f : A[(size_t)i*N + j]) + T;
+                if (Labelled) store_material(L, M, NumMaterials, (size_t)N*N, (size_t)i*N + j, T, In, Material, Overwrite);
             }}
     }
     else if (Object == 3) {
         /* the object is an elliptical disk */
-#pragma omp parallel for shared(A) private(i,j,T)       
+#pragma omp parallel for shared(A) private(i,j,T,In)       
                 for(i=0; i<N; i++) {
                     for(j=0; j<N; j++) {
                         T = a2*powf((Xdel[i]*cos_phi + Ydel[j]*sin_phi),2) + b2*powf((-Xdel[i]*sin_phi + Ydel[j]*cos_phi),2);
-                        if (T <= 1) T = C0;
+                        In = (T <= 1);
+                        if (In) T = C0;
                         else T = 0.0f;
-                        A[(i)*N + (j)] = A[(i)*N + (j)] + T;
+                        A[(size_t)i*N + j] = (Overwrite ? 0.0f : A[(size_t)i*N + j]) + T;
+                        if (Labelled) store_material(L, M, NumMaterials, (size_t)N*N, (size_t)i*N + j, T, In, Material, Overwrite);
                     }}
     }
      else if (Object == 4) {
         /* the object is a parabola Lambda = 1*/
-#pragma omp parallel for shared(A) private(i,j,T)                
+#pragma omp parallel for shared(A) private(i,j,T,In)                
                 for(i=0; i<N; i++) {
                     for(j=0; j<N; j++) {
                         T = (4.0f*a2)*powf((Xdel[i]*cos_phi + Ydel[j]*sin_phi),2) + (4.0f*b2)*powf((-Xdel[i]*sin_phi + Ydel[j]*cos_phi),2);
-                        if (T <= 1) T = C0*sqrtf(1.0f - T);
+                        In = (T <= 1);
+                        if (In) T = C0*sqrtf(1.0f - T);
                         else T = 0.0f;
-                        A[(i)*N + (j)] += T;
+                        A[(size_t)i*N + j] = (Overwrite ? 0.0f : A[(size_t)i*N + j]) + T;
+                        if (Labelled) store_material(L, M, NumMaterials, (size_t)N*N, (size_t)i*N + j, T, In, Material, Overwrite);
                     }}
             }
      else if (Object == 5) {
       /*the object is a cone*/
-#pragma omp parallel for shared(A) private(i,j,T)
+#pragma omp parallel for shared(A) private(i,j,T,In)
                 for(i=0; i<N; i++) {
                     for(j=0; j<N; j++) {
                         T = a2*powf((Xdel[i]*cos_phi + Ydel[j]*sin_phi),2) + b2*powf((-Xdel[i]*sin_phi + Ydel[j]*cos_phi),2);
-                        if (T <= 1) T = C0*(1.0f - sqrtf(T));
+                        In = (T <= 1);
+                        if (In) T = C0*(1.0f - sqrtf(T));
                         else T = 0.0f;
-                        A[(i)*N + (j)] += T;
+                        A[(size_t)i*N + j] = (Overwrite ? 0.0f : A[(size_t)i*N + j]) + T;
+                        if (Labelled) store_material(L, M, NumMaterials, (size_t)N*N, (size_t)i*N + j, T, In, Material, Overwrite);
                     }}
     }
     else if (Object == 6) {
@@ -136,20 +168,25 @@ float buildPhantom2D_core_single(float *A, int N,  int Object,
             sin_phi=sinf(phi_rot_radian);
             cos_phi=cosf(phi_rot_radian);
         }
-#pragma omp parallel for shared(A) private(i,j,HX,HY,T)
+#pragma omp parallel for shared(A) private(i,j,HX,HY,T,In)
                 for(i=0; i<N; i++) {
                     for(j=0; j<N; j++) {
                         HX = fabsf((Xdel[i] - x0r)*cos_phi + (Ydel[j] - y0r)*sin_phi);
                         T = 0.0f;
+                        In = 0;
                         if (HX <= a2) {
                             HY = fabsf((Ydel[j] - y0r)*cos_phi - (Xdel[i] - x0r)*sin_phi);
-                            if (HY <= b2) {T = C0;}
+                            if (HY <= b2) {T = C0; In = 1;}
                         }
-                        A[(i)*N + (j)] += T;
+                        A[(size_t)i*N + j] = (Overwrite ? 0.0f : A[(size_t)i*N + j]) + T;
+                        if (Labelled) store_material(L, M, NumMaterials, (size_t)N*N, (size_t)i*N + j, T, In, Material, Overwrite);
                     }}
     }
     else {
         printf("%s\n", "No such object exist!");
+        if (Overwrite) memset(A, 0, (size_t)N*N*sizeof(float));
+        if (Overwrite && Labelled) clear_materials(L, M, NumMaterials, (size_t)N*N, 0, (size_t)N*N);
+        free(Xdel); free(Ydel); free(Tomorange_X_Ar);
         return 0;
     }
     free(Xdel); free(Ydel);
@@ -158,90 +195,67 @@ float buildPhantom2D_core_single(float *A, int N,  int Object,
     return *A;
 }
 
-float buildPhantom2D_core(float *A, int ModelSelected, int N, char *ModelParametersFilename)
+float buildPhantom2D_core_single(float *A, int N,  int Object, float C0, float x0, float y0, float a, float b, float phi_rot, int Overwrite, int Fast)
 {
-    FILE *in_file = fopen(ModelParametersFilename, "r"); // read parameters file
-    int ii, func_val;
-    if (! in_file )
-    {
-        printf("%s %s\n", "Parameters file does not exist or cannot be read!", ModelParametersFilename);
-        printf("Trying models/Phantom2DLibrary.dat");
-        in_file = fopen("models/Phantom2DLibrary.dat","r");
-        if(! in_file)
-        {
-            printf("models/Phantom2DLibrary.dat is not found");
-            return 0;
+    return buildPhantom2D_core_single_materials(A, NULL, NULL, 0, -1, N, Object, C0, x0, y0, a, b, phi_rot, Overwrite, Fast);
+}
+
+/* Overwrite = 1: the first object is written into A and the following objects are added,
+ * so A does not need to be initialised (and it is zeroed if no object has been built);
+ * Overwrite = 0: all objects are added to A. Weight scales the intensities of all objects. */
+float buildPhantom2D_core(float *A, int ModelSelected, int N, char *ModelParametersFilename, int Overwrite, float Weight, int Fast)
+{
+    int ii, Components = 0, func_val;
+    float *Params;
+    
+    /* read the model parameters */
+    Params = read_model2D(ModelSelected, ModelParametersFilename, &Components);
+    
+    /* loop over all components */
+    for(ii=0; ii<Components; ii++) {
+        float *P = &Params[ii*7];
+        /*  check that the parameters are reasonable  */
+        func_val = parameters_check2D(P[1], P[2], P[3], P[4], P[5], P[6]);
+        
+        /* build phantom */
+        if (func_val == 0) {
+            buildPhantom2D_core_single(A, N, (int)P[0], Weight*P[1], P[2], P[3], P[4], P[5], P[6], Overwrite, Fast);
+            Overwrite = 0;
         }
+        else printf("\nFunction prematurely terminated, not all objects included");
     }
-    char tempbuff[100];
-    while(!feof(in_file))
-    {
-        
-        char tmpstr1[16];
-        char tmpstr2[16];
-        char tmpstr3[16];
-        char tmpstr4[16];
-        char tmpstr5[16];
-        char tmpstr6[16];
-        char tmpstr7[16];
-        char tmpstr8[16];
-        
-        if (fgets(tempbuff,100,in_file)) {
-            
-            if(tempbuff[0] == '#') continue;
-            
-            sscanf(tempbuff, "%15s : %15[^;];", tmpstr1, tmpstr2);
-            /*printf("<<%s>>\n",  tmpstr1);*/
-            int Model = 0, Components = 0;
-            
-            if (strcmp(tmpstr1,"Model")==0) {
-                Model = atoi(tmpstr2);
-            }
-            
-            /*check if we got the right model */
-            if (ModelSelected == Model) {
-                /* read the model parameters */
-                printf("\nThe selected Model : %i \n", Model);
-                if (fgets(tempbuff,100,in_file)) {
-                    sscanf(tempbuff, "%15s : %15[^;];", tmpstr1, tmpstr2); }
-                if  (strcmp(tmpstr1,"Components") == 0) {
-                    Components = atoi(tmpstr2);
-                }
-                else {
-                    printf("%s\n", "The number of components is unknown!");
-                    return 0;
-                }
-                
-                /* loop over all components */
-                for(ii=0; ii<Components; ii++) {
-                    int Object = 0;
-                    float C0 = 0.0f, x0 = 0.0f, y0 = 0.0f, a = 0.0f, b = 0.0f,  phi_rot = 0.0f;
-                    
-                    if (fgets(tempbuff,100,in_file)) {
-                        sscanf(tempbuff, "%15s : %15s %15s %15s %15s %15s %15s %15[^;];", tmpstr1, tmpstr2, tmpstr3, tmpstr4, tmpstr5, tmpstr6, tmpstr7, tmpstr8);
-                    }
-                    if  (strcmp(tmpstr1,"Object") == 0) {
-                        Object = atoi(tmpstr2); /* analytical model */
-                        C0 = (float)atof(tmpstr3); /* intensity */
-                        y0 = (float)atof(tmpstr4); /* x0 position */
-                        x0 = (float)atof(tmpstr5); /* y0 position */
-                        a = (float)atof(tmpstr6); /* a - size object */
-                        b = (float)atof(tmpstr7); /* b - size object */
-                        phi_rot = (float)atof(tmpstr8); /* phi - rotation angle */
-                        /*printf("\nObject : %i \nC0 : %f \nx0 : %f \nc : %f \n", Object, C0, x0, c);*/
-                    }
-                    
-                     /*  check that the parameters are reasonable  */
-                    func_val = parameters_check2D(C0, x0, y0, a, b, phi_rot);
-                    
-                    /* build phantom */
-                    if (func_val == 0) buildPhantom2D_core_single(A, N, Object, C0, x0, y0, a, b, phi_rot);
-                    else printf("\nFunction prematurely terminated, not all objects included");         
-                    
-                }
-            }
-            
+    if (Overwrite) memset(A, 0, (size_t)N*N*sizeof(float));
+    free(Params);
+    return *A;
+}
+
+/* Builds the model into A (see buildPhantom2D_core with Overwrite = 1) together with the label map L
+ * (N x N, the materials of the objects, 0 where no object with a material is present) and the maps M
+ * of the materials 1, ..., NumMaterials (NumMaterials x N x N, the sum of the objects of each material),
+ * all outputs are written in the same pass over the objects (the first object initialises all of them, see
+ * store_material). L and M can be NULL. */
+float buildPhantom2D_core_materials(float *A, unsigned char *L, float *M, int NumMaterials, int ModelSelected, int N, char *ModelParametersFilename, float Weight, int Fast)
+{
+    int ii, Components = 0, func_val, Overwrite = 1, *Materials = NULL;
+    float *Params;
+    
+    /* read the model parameters and the materials of the objects */
+    Params = read_model2D_materials(ModelSelected, ModelParametersFilename, &Components, &Materials);
+    
+    for(ii=0; ii<Components; ii++) {
+        float *P = &Params[ii*7];
+        func_val = parameters_check2D(P[1], P[2], P[3], P[4], P[5], P[6]);
+        if (func_val == 0) {
+            buildPhantom2D_core_single_materials(A, L, M, NumMaterials, Materials[ii], N, (int)P[0], Weight*P[1], P[2], P[3], P[4], P[5], P[6], Overwrite, Fast);
+            Overwrite = 0;
         }
+        else printf("\nFunction prematurely terminated, not all objects included");
+    }
+    if (Overwrite) {
+        memset(A, 0, (size_t)N*N*sizeof(float));
+        clear_materials(L, M, NumMaterials, (size_t)N*N, 0, (size_t)N*N);
     }
+    free(Params);
+    free(Materials);
     return *A;
-}
\ No newline at end of file
+}
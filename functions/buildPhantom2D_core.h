@@ -19,5 +19,7 @@ limitations under the License.
 #include <stdio.h>
 #include "omp.h"
 
-float buildPhantom2D_core(float *A, int ModelSelected, int N, char *ModelParametersFilename);
-float buildPhantom2D_core_single(float *A, int N,  int Object, float C0, float x0, float y0, float a, float b, float phi_rot);
+float buildPhantom2D_core(float *A, int ModelSelected, int N, char *ModelParametersFilename, int Overwrite, float Weight, int Fast);
+float buildPhantom2D_core_materials(float *A, unsigned char *L, float *M, int NumMaterials, int ModelSelected, int N, char *ModelParametersFilename, float Weight, int Fast);
+float buildPhantom2D_core_single(float *A, int N,  int Object, float C0, float x0, float y0, float a, float b, float phi_rot, int Overwrite, int Fast);
+float buildPhantom2D_core_single_materials(float *A, unsigned char *L, float *M, int NumMaterials, int Material, int N,  int Object, float C0, float x0, float y0, float a, float b, float phi_rot, int Overwrite, int Fast);
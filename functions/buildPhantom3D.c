@@ -20,6 +20,7 @@ limitations under the License.
 #include "omp.h"
 
 #include "buildPhantom3D_core.h"
+#include "utils.h"
 
 #define M_PI 3.14159265358979323846
 
@@ -33,6 +34,10 @@ limitations under the License.
  *
  * Output:
  * 1. The analytical phantom size of [N x N x N]
+ * 2. (optional) The uint8 label map of the same size: the materials of the objects ("Material : m;" after
+ *    the object in the library file), 0 where no object with a material is present
+ * 3. (optional) The maps of the materials 1, ..., M (the largest material of the model) of size [N x N x N x M],
+ *    the sum of the objects of each material
  */
 
 void mexFunction(
@@ -40,8 +45,9 @@ void mexFunction(
         int nrhs, const mxArray *prhs[])
         
 {
-    int ModelSelected, N;
-    float *A;
+    int ModelSelected, N, Components, NumMaterials = 0, *Materials = NULL;
+    float *A, *M = NULL, *Params;
+    unsigned char *L = NULL;
     char *ModelParameters_PATH;
     
     /*Handling Matlab input data*/
@@ -52,10 +58,23 @@ void mexFunction(
     ModelParameters_PATH = mxArrayToString(prhs[2]); /* provide an absolute path to the file */      
     
     /*Handling Matlab output data*/
-    int N_dims[] = {N, N, N};
-    A = (float*)mxGetPr(plhs[0] = mxCreateNumericArray(3, N_dims, mxSINGLE_CLASS, mxREAL));   
+    mwSize N_dims[] = {N, N, N, 0};
+    A = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray(3, N_dims, mxSINGLE_CLASS, mxREAL));   
     
-    buildPhantom3D_core(A, ModelSelected, N, ModelParameters_PATH);
+    if (nlhs > 1) {
+        /* the materials are built in the same pass as the phantom */
+        L = (unsigned char*)mxGetData(plhs[1] = mxCreateUninitNumericArray(3, N_dims, mxUINT8_CLASS, mxREAL));
+        if (nlhs > 2) {
+            Params = read_model3D_materials(ModelSelected, ModelParameters_PATH, &Components, &Materials);
+            if (Materials != NULL) NumMaterials = max_material(Materials, Components);
+            free(Params); free(Materials);
+            N_dims[3] = NumMaterials;
+            M = (float*)mxGetPr(plhs[2] = mxCreateUninitNumericArray(4, N_dims, mxSINGLE_CLASS, mxREAL));
+        }
+        buildPhantom3D_core_materials(A, L, M, NumMaterials, ModelSelected, N, ModelParameters_PATH, 1.0f, 0, N, 0);
+    }
+    /* the output is not initialised, the first object overwrites it */
+    else buildPhantom3D_core(A, ModelSelected, N, ModelParameters_PATH, 1, 1.0f, 0, N, 0);
     
     mxFree(ModelParameters_PATH);
 }
@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include "omp.h"
 #include "utils.h"
+#include "fastMath.h"
 
 #define M_PI 3.14159265358979323846
 
@@ -37,12 +38,24 @@
  * 11. psi_gr1 - rotation angle1
  * 12. psi_gr2 - rotation angle2
  * 12. psi_gr3 - rotation angle3
+ * 13. Overwrite - 1: the object is written into A (the previous content is ignored, no zeroing
+ *     of A is needed), 0: the object is added to A
+ * 14. Z1, Z2 - only the slices [Z1, Z2) are built (0, N for the whole volume), A then holds
+ *     (Z2-Z1) x N x N values
+ * 15. Fast - 1 - the polynomial approximations of expf and logf of fastMath.h (relative error below 8.2e-8, the gaussian
+ *     and cone objects are 1.5-4 times faster), 0 - expf and logf of the C library
  *
  * Output:
  * 1. The analytical phantom size of [N x N x N]
  */
 
-float buildPhantom3D_core_single(float *A, int N,  int Object,
+/* buildPhantom3D_core_single_materials also stores the object of the given Material in the label map L
+ * and adds it to its map among the NumMaterials maps of M (both can be NULL, see store_material) in the
+ * same pass, the support
+ * of a gaussian is its part above the half of the maximum. buildPhantom3D_core_single_box builds only the
+ * rows [I1, I2) and the columns [J1, J2) of the slices (the other values are not changed, the box is meant
+ * for Overwrite = 0, see buildPhantom4D_core) */
+float buildPhantom3D_core_single_box(float *A, unsigned char *L, float *M, int NumMaterials, int Material, int N,  int Object,
         float C0, /* intensity */
         float x0, /* x0 position */
         float y0, /* y0 position */
@@ -52,9 +65,14 @@ float buildPhantom3D_core_single(float *A, int N,  int Object,
         float c , /* c - size object */
         float psi_gr1, /* rotation angle1 */
         float psi_gr2, /* rotation angle2 */
-        float psi_gr3 /* rotation angle3 */)
+        float psi_gr3, /* rotation angle3 */
+        int Overwrite, /* 1 - write into A, 0 - add to A */
+        int Z1, int Z2, /* the range of slices [Z1, Z2) to build */
+        int I1, int I2, int J1, int J2, /* the ranges of rows and columns to build */
+        int Fast /* 1 - the approximations of fastMath.h, 0 - expf and logf of the C library */)
 {
-    int i, j, k;
+    int i, j, k, In, Labelled = ((L != NULL) || (M != NULL));
+    size_t Volume = (size_t)(Z2-Z1)*N*N;
     float *Tomorange_X_Ar=NULL, Tomorange_Xmin, Tomorange_Xmax, H_x, C1, a2, b2, c2, phi_rot_radian, sin_phi, cos_phi, aa,bb,cc, psi1, psi2, psi3;
     float *Xdel = NULL, *Ydel = NULL, *Zdel = NULL, T;
     Tomorange_X_Ar = malloc(N*sizeof(float));
@@ -82,10 +100,8 @@ float buildPhantom3D_core_single(float *A, int N,  int Object,
     psi2 = psi_gr2*((float)M_PI/180.0f);
     psi3 = psi_gr3*((float)M_PI/180.0f);
     
-    float *bs, *xh, *xh1, *xh2;
-    bs = malloc(9*sizeof(float));
-    xh = malloc(3*sizeof(float));
-    xh1 = malloc(3*sizeof(float));
+    /* rotation matrix and vectors are kept on the stack (no allocations inside the parallel loop) */
+    float bs[9], xh[3], xh1[3], xh2[3];
     
     a2 = 1.0f/(a*a);
     b2 = 1.0f/(b*b);    
@@ -94,18 +110,36 @@ float buildPhantom3D_core_single(float *A, int N,  int Object,
     
     xh1[0] = x0; xh1[1] = y0; xh1[2] = z0;
     mmtvc(bs,xh1,xh);  /*call subroutine */
-    free(xh1);
     
-    if ((Object == 1) || (Object == 2) || (Object == 3) || (Object == 4)) {
+    if ((Object == 1) && Fast && !Labelled) {
+        /* the gaussian with the approximation of expf: the rotated coordinates are linear in j
+         * (xh2 = bs*(x_i, 0, z_k) + y_j*bs(:,1)), so the rows are vectorised */
+        float q0, q1, q2;
+#pragma omp parallel for shared(A) private(k,i,j,T,aa,bb,cc,xh1,xh2,q0,q1,q2)
+        for(k=Z1; k<Z2; k++) {
+            for(i=I1; i<I2; i++) {
+                xh1[0]=Tomorange_X_Ar[i];
+                xh1[1]=0.0f;
+                xh1[2]=Tomorange_X_Ar[k];
+                mmtvc(bs,xh1,xh2);
+                q0 = xh2[0]-xh[0]; q1 = xh2[1]-xh[1]; q2 = xh2[2]-xh[2];
+#pragma omp simd private(T,aa,bb,cc)
+                for(j=J1; j<J2; j++) {
+                    aa = q0 + Tomorange_X_Ar[j]*bs[1];
+                    bb = q1 + Tomorange_X_Ar[j]*bs[4];
+                    cc = q2 + Tomorange_X_Ar[j]*bs[7];
+                    T = a2*aa*aa + b2*bb*bb + c2*cc*cc;
+                    A[((size_t)(k-Z1)*N + i)*N + j] = (Overwrite ? 0.0f : A[((size_t)(k-Z1)*N + i)*N + j]) + C0*fast_expf(C1*T);
+                }
+            }}
+    }
+    else if ((Object == 1) || (Object == 2) || (Object == 3) || (Object == 4)) {
         
-#pragma omp parallel for shared(A) private(k,i,j,T,aa,bb,cc,xh2,xh1)
-        for(k=0; k<N; k++) {
-            for(i=0; i<N; i++) {
-                for(j=0; j<N; j++) {
+#pragma omp parallel for shared(A) private(k,i,j,T,In,aa,bb,cc,xh2,xh1)
+        for(k=Z1; k<Z2; k++) {
+            for(i=I1; i<I2; i++) {
+                for(j=J1; j<J2; j++) {
                     if ((psi1 != 0.0f) || (psi2 != 0.0f) || (psi3 != 0.0f)) {
-                        
-                        xh1 = malloc(3*sizeof(float));
-                        xh2 = malloc(3*sizeof(float));
                         xh1[0]=Tomorange_X_Ar[i];
                         xh1[1]=Tomorange_X_Ar[j];
                         xh1[2]=Tomorange_X_Ar[k];
@@ -113,7 +147,6 @@ float buildPhantom3D_core_single(float *A, int N,  int Object,
                         aa = a2*powf((xh2[0]-xh[0]),2);
                         bb = b2*powf((xh2[1]-xh[1]),2);
                         cc = c2*powf((xh2[2]-xh[2]),2);
-                        free(xh1); free(xh2);
                     }
                     else {
                         aa = a2*powf(Xdel[i],2);
@@ -121,26 +154,29 @@ float buildPhantom3D_core_single(float *A, int N,  int Object,
                         cc = c2*powf(Zdel[k],2);
                     }
                     T = (aa + bb + cc);
+                    In = (T <= 1.0f);
                     if (Object == 1) {
                         /* The object is a volumetric gaussian */
+                        In = (T <= 0.25f);
                         T = C0*expf(C1*T);
                     }
                     if (Object == 2) {
                         /* the object is a parabola Lambda = 1/2 */
-                        if (T <= 1.0f) T = C0*sqrtf(1.0f - T);
+                        if (In) T = C0*sqrtf(1.0f - T);
                         else T = 0.0f;
                     }
                     if (Object == 3) {
                         /* the object is en ellipsoid */
-                        if (T <= 1.0f) T = C0;
+                        if (In) T = C0;
                         else T = 0.0f;
                     }
                     if (Object == 4) {
                          /* the object is a cone */
-                        if (T <= 1.0f) T = C0*(1.0f - sqrtf(T));
+                        if (In) T = C0*(1.0f - sqrtf(T));
                         else T = 0.0f;
                     }
-                    A[(k)*N*N + (i)*N + (j)] += T;
+                    A[((size_t)(k-Z1)*N + i)*N + j] = (Overwrite ? 0.0f : A[((size_t)(k-Z1)*N + i)*N + j]) + T;
+                    if (Labelled) store_material(L, M, NumMaterials, Volume, ((size_t)(k-Z1)*N + i)*N + j, T, In, Material, Overwrite);
                 }}}
     }
     if (Object == 5) {
@@ -156,135 +192,165 @@ float buildPhantom3D_core_single(float *A, int N,  int Object,
             sin_phi=sinf(phi_rot_radian);
             cos_phi=cosf(phi_rot_radian);
         }        
-#pragma omp parallel for shared(A,Zdel) private(k,i,j,HX,HY,T)
-        for(k=0; k<N; k++) {
+#pragma omp parallel for shared(A,Zdel) private(k,i,j,HX,HY,T,In)
+        for(k=Z1; k<Z2; k++) {
             if  (fabs(Zdel[k]) < c2) {
                 
-                for(i=0; i<N; i++) {
-                    for(j=0; j<N; j++) {
+                for(i=I1; i<I2; i++) {
+                    for(j=J1; j<J2; j++) {
                         HX = fabsf((Xdel[i] - x0r)*cos_phi + (Ydel[j] - y0r)*sin_phi);
                         T = 0.0f;
+                        In = 0;
                         if (HX <= a2) {
                             HY = fabsf((Ydel[j] - y0r)*cos_phi - (Xdel[i] - x0r)*sin_phi);
-                            if (HY <= b2) {T = C0;}
+                            if (HY <= b2) {T = C0; In = 1;}
                         }
-                        A[(k)*N*N + (i)*N + (j)] += T;
+                        A[((size_t)(k-Z1)*N + i)*N + j] = (Overwrite ? 0.0f : A[((size_t)(k-Z1)*N + i)*N + j]) + T;
+                        if (Labelled) store_material(L, M, NumMaterials, Volume, ((size_t)(k-Z1)*N + i)*N + j, T, In, Material, Overwrite);
                     }
                 }
             }
+            else if (Overwrite) {
+                memset(&A[(size_t)(k-Z1)*N*N], 0, (size_t)N*N*sizeof(float));
+                if (Labelled) clear_materials(L, M, NumMaterials, Volume, (size_t)(k-Z1)*N*N, (size_t)N*N);
+            }
         }
     }
     if (Object == 6) {
         /* the object is an elliptical disk (2D) extended into 3D  */
-#pragma omp parallel for shared(A) private(k,i,j,T)
-        for(k=0; k<N; k++) {
+#pragma omp parallel for shared(A) private(k,i,j,T,In)
+        for(k=Z1; k<Z2; k++) {
             if  (fabs(Zdel[k]) < c) {
-                for(i=0; i<N; i++) {
-                    for(j=0; j<N; j++) {
+                for(i=I1; i<I2; i++) {
+                    for(j=J1; j<J2; j++) {
                         T = a2*powf((Xdel[i]*cos_phi + Ydel[j]*sin_phi),2) + b2*powf((-Xdel[i]*sin_phi + Ydel[j]*cos_phi),2);
-                        if (T <= 1) T = C0;
+                        In = (T <= 1);
+                        if (In) T = C0;
                         else T = 0.0f;
-                        A[(k)*N*N + (i)*N + (j)] += T;
+                        A[((size_t)(k-Z1)*N + i)*N + j] = (Overwrite ? 0.0f : A[((size_t)(k-Z1)*N + i)*N + j]) + T;
+                        if (Labelled) store_material(L, M, NumMaterials, Volume, ((size_t)(k-Z1)*N + i)*N + j, T, In, Material, Overwrite);
                     }}
             }
+            else if (Overwrite) {
+                memset(&A[(size_t)(k-Z1)*N*N], 0, (size_t)N*N*sizeof(float));
+                if (Labelled) clear_materials(L, M, NumMaterials, Volume, (size_t)(k-Z1)*N*N, (size_t)N*N);
+            }
         } /*k-loop*/
     }    
-    free(Xdel); free(Ydel); free(Zdel); free(bs); free(xh);
+    if (((Object < 1) || (Object > 6)) && Overwrite) {
+        memset(A, 0, Volume*sizeof(float));
+        if (Labelled) clear_materials(L, M, NumMaterials, Volume, 0, Volume);
+    }
+    free(Xdel); free(Ydel); free(Zdel);
     /************************************************/
     free(Tomorange_X_Ar);
     return *A;
 }
 
-float buildPhantom3D_core(float *A, int ModelSelected, int N, char *ModelParametersFilename)
+float buildPhantom3D_core_single_materials(float *A, unsigned char *L, float *M, int NumMaterials, int Material, int N,  int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float psi_gr1, float psi_gr2, float psi_gr3, int Overwrite, int Z1, int Z2, int Fast)
+{
+    return buildPhantom3D_core_single_box(A, L, M, NumMaterials, Material, N, Object, C0, x0, y0, z0, a, b, c, psi_gr1, psi_gr2, psi_gr3, Overwrite, Z1, Z2, 0, N, 0, N, Fast);
+}
+
+float buildPhantom3D_core_single(float *A, int N,  int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float psi_gr1, float psi_gr2, float psi_gr3, int Overwrite, int Z1, int Z2, int Fast)
+{
+    return buildPhantom3D_core_single_materials(A, NULL, NULL, 0, -1, N, Object, C0, x0, y0, z0, a, b, c, psi_gr1, psi_gr2, psi_gr3, Overwrite, Z1, Z2, Fast);
+}
+
+/* Overwrite = 1: the first object is written into A and the following objects are added,
+ * so A does not need to be initialised (and it is zeroed if no object has been built);
+ * Overwrite = 0: all objects are added to A. Weight scales the intensities of all objects.
+ * Only the slices [Z1, Z2) are built (see buildPhantom3D_core_single). Params holds Components
+ * objects of 11 values in the order of read_model3D. */
+float buildPhantom3D_core_params(float *A, int N, float *Params, int Components, int Overwrite, float Weight, int Z1, int Z2, int Fast)
 {
-    FILE *in_file = fopen(ModelParametersFilename, "r"); // read parameters file
     int ii, func_val;
-    if (! in_file )
-    {
-        printf("%s %s\n", "Parameters file does not exist or cannot be read!", ModelParametersFilename);
-        printf("Trying models/Phantom3DLibrary.dat");
-        in_file = fopen("models/Phantom3DLibrary.dat","r");
-        if(! in_file)
-        {
-            printf("models/Phantom3DLibrary.dat is not found");
-            return 0;
+    
+    /* loop over all components */
+    for(ii=0; ii<Components; ii++) {
+        float *P = &Params[ii*11];
+        /*  check that the parameters are reasonable  */
+        func_val = parameters_check3D(P[1], P[2], P[3], P[4], P[5], P[6], P[7]);
+        
+        /* build phantom */
+        if (func_val == 0) {
+            buildPhantom3D_core_single(A, N, (int)P[0], Weight*P[1], P[2], P[3], P[4], P[5], P[6], P[7], P[8], P[9], P[10], Overwrite, Z1, Z2, Fast);
+            Overwrite = 0;
         }
+        else printf("\nFunction prematurely terminated, not all objects included");
     }
-    char tempbuff[200];
-    while(!feof(in_file))
-    {
-        
-        char tmpstr1[16];
-        char tmpstr2[16];
-        char tmpstr3[16];
-        char tmpstr4[16];
-        char tmpstr5[16];
-        char tmpstr6[16];
-        char tmpstr7[16];
-        char tmpstr8[16];
-        char tmpstr9[16];
-        char tmpstr10[16];
-        char tmpstr11[16];
-        char tmpstr12[16];
-        
-        if (fgets(tempbuff,200,in_file)) {
-            
-            if(tempbuff[0] == '#') continue;
-            
-            sscanf(tempbuff, "%15s : %15[^;];", tmpstr1, tmpstr2);
-            /*printf("<<%s>>\n",  tmpstr1);*/
-            int Model = 0, Components = 0;
-            
-            if (strcmp(tmpstr1,"Model")==0) {
-                Model = atoi(tmpstr2);
-            }
-            
-            /*check if we got the right model */
-            if (ModelSelected == Model) {
-                /* read the model parameters */
-                printf("\nThe selected Model : %i \n", Model);
-                if (fgets(tempbuff,200,in_file)) {
-                    sscanf(tempbuff, "%15s : %15[^;];", tmpstr1, tmpstr2); }
-                if  (strcmp(tmpstr1,"Components") == 0) {
-                    Components = atoi(tmpstr2);
-                }
-                else {
-                    printf("%s\n", "The number of components is unknown!");
-                    return 0;
-                }
-                
-                /* loop over all components */
-                for(ii=0; ii<Components; ii++) {
-                    int Object = 0;
-                    float C0 = 0.0f, x0 = 0.0f, y0 = 0.0f, z0 = 0.0f, a = 0.0f, b = 0.0f, c = 0.0f, psi_gr1 = 0.0f, psi_gr2 = 0.0f, psi_gr3 = 0.0f;
-                    
-                    if (fgets(tempbuff,200,in_file)) {
-                        sscanf(tempbuff, "%15s : %15s %15s %15s %15s %15s %15s %15s %15s %15s %15s %15[^;];", tmpstr1, tmpstr2, tmpstr3, tmpstr4, tmpstr5, tmpstr6, tmpstr7, tmpstr8, tmpstr9, tmpstr10, tmpstr11, tmpstr12);
-                    }
-                    if  (strcmp(tmpstr1,"Object") == 0) {
-                        Object = atoi(tmpstr2); /* analytical model */
-                        C0 = (float)atof(tmpstr3); /* intensity */
-                        y0 = (float)atof(tmpstr4); /* x0 position */
-                        x0 = (float)atof(tmpstr5); /* y0 position */
-                        z0 = (float)atof(tmpstr6); /* z0 position */
-                        a = (float)atof(tmpstr7); /* a - size object */
-                        b = (float)atof(tmpstr8); /* b - size object */
-                        c = (float)atof(tmpstr9); /* c - size object */
-                        psi_gr1 = (float)atof(tmpstr10); /* rotation angle 1*/
-                        psi_gr2 = (float)atof(tmpstr11); /* rotation angle 2*/
-                        psi_gr3 = (float)atof(tmpstr12); /* rotation angle 3*/
-                        printf("\nObject : %i \nC0 : %f \nx0 : %f \ny0 : %f \nz0 : %f \na : %f \nb : %f \nc : %f \nPhi1 : %f \nPhi2 : %f \nPhi3 : %f\n", Object, C0, x0, y0, z0, a, b, c, psi_gr1, psi_gr2, psi_gr3);
-                    }
-                    /*  check that the parameters are reasonable  */
-                    func_val = parameters_check3D(C0, x0, y0, z0, a, b, c);
-                    
-                    /* build phantom */
-                    if (func_val == 0) buildPhantom3D_core_single(A, N, Object, C0, x0, y0, z0, a, b, c, psi_gr1, psi_gr2, psi_gr3);
-                    else printf("\nFunction prematurely terminated, not all objects included");
-                }
-            }
-            
+    if (Overwrite) memset(A, 0, (size_t)(Z2-Z1)*N*N*sizeof(float));
+    return *A;
+}
+
+/* see buildPhantom3D_core_params */
+float buildPhantom3D_core(float *A, int ModelSelected, int N, char *ModelParametersFilename, int Overwrite, float Weight, int Z1, int Z2, int Fast)
+{
+    int Components = 0;
+    float *Params;
+    
+    /* read the model parameters */
+    Params = read_model3D(ModelSelected, ModelParametersFilename, &Components);
+    buildPhantom3D_core_params(A, N, Params, Components, Overwrite, Weight, Z1, Z2, Fast);
+    free(Params);
+    return *A;
+}
+
+/* Builds the slices [Z1, Z2) of the model into A ((Z2-Z1) x N x N values) of the compact Format with
+ * the Scale and Offset of store_compact. The objects are accumulated in float32 slabs of about
+ * COMPACT_SLAB values, so every value of A is stored once and the float32 volume is never allocated. */
+float buildPhantom3D_core_compact(unsigned short *A, int Format, float Scale, float Offset, int ModelSelected, int N, char *ModelParametersFilename, float Weight, int Z1, int Z2, int Fast)
+{
+    int k, S, Components = 0;
+    size_t Slab;
+    float *Params, *B;
+    
+    if (Z2 <= Z1) return 0.0f;
+    Params = read_model3D(ModelSelected, ModelParametersFilename, &Components);
+    Components = check_model3D(Params, Components);
+    Slab = COMPACT_SLAB/((size_t)N*N);
+    if (Slab < 1) Slab = 1;
+    if (Slab > (size_t)(Z2-Z1)) Slab = (size_t)(Z2-Z1);
+    S = (int)Slab;
+    B = malloc((size_t)S*N*N*sizeof(float));
+    for(k=Z1; k<Z2; k+=S) {
+        if (S > Z2-k) S = Z2-k;
+        buildPhantom3D_core_params(B, N, Params, Components, 1, Weight, k, k+S, Fast);
+        store_compact(B, &A[(size_t)(k-Z1)*N*N], (size_t)S*N*N, Format, Scale, Offset);
+    }
+    free(B);
+    free(Params);
+    return 0.0f;
+}
+
+/* Builds the slices [Z1, Z2) of the model into A (see buildPhantom3D_core with Overwrite = 1) together
+ * with the label map L ((Z2-Z1) x N x N, the materials of the objects, 0 where no object with a material
+ * is present) and the maps M of the materials 1, ..., NumMaterials (NumMaterials x (Z2-Z1) x N x N, the
+ * sum of the objects of each material), all outputs are written in the same pass over the objects (the
+ * first object initialises all of them, see store_material). L and M can be NULL. */
+float buildPhantom3D_core_materials(float *A, unsigned char *L, float *M, int NumMaterials, int ModelSelected, int N, char *ModelParametersFilename, float Weight, int Z1, int Z2, int Fast)
+{
+    int ii, Components = 0, func_val, Overwrite = 1, *Materials = NULL;
+    float *Params;
+    size_t Volume = (size_t)(Z2-Z1)*N*N;
+    
+    /* read the model parameters and the materials of the objects */
+    Params = read_model3D_materials(ModelSelected, ModelParametersFilename, &Components, &Materials);
+    
+    for(ii=0; ii<Components; ii++) {
+        float *P = &Params[ii*11];
+        func_val = parameters_check3D(P[1], P[2], P[3], P[4], P[5], P[6], P[7]);
+        if (func_val == 0) {
+            buildPhantom3D_core_single_materials(A, L, M, NumMaterials, Materials[ii], N, (int)P[0], Weight*P[1], P[2], P[3], P[4], P[5], P[6], P[7], P[8], P[9], P[10], Overwrite, Z1, Z2, Fast);
+            Overwrite = 0;
         }
+        else printf("\nFunction prematurely terminated, not all objects included");
+    }
+    if (Overwrite) {
+        memset(A, 0, Volume*sizeof(float));
+        clear_materials(L, M, NumMaterials, Volume, 0, Volume);
     }
+    free(Params);
+    free(Materials);
     return *A;
 }
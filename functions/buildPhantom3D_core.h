@@ -12,13 +12,17 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
-#include <matrix.h>
 #include <math.h>
 #include <stdlib.h>
 #include <memory.h>
 #include <stdio.h>
 #include "omp.h"
 
-float buildPhantom3D_core(float *A, int ModelSelected, int N, char *ModelParametersFilename);
-float buildPhantom3D_core_single(float *A, int N,  int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float phi_rot);
-float parameters_check3D(float C0, float x0, float y0, float z0, float a, float b, float c, float phi_rot);
+float buildPhantom3D_core(float *A, int ModelSelected, int N, char *ModelParametersFilename, int Overwrite, float Weight, int Z1, int Z2, int Fast);
+float buildPhantom3D_core_params(float *A, int N, float *Params, int Components, int Overwrite, float Weight, int Z1, int Z2, int Fast);
+float buildPhantom3D_core_compact(unsigned short *A, int Format, float Scale, float Offset, int ModelSelected, int N, char *ModelParametersFilename, float Weight, int Z1, int Z2, int Fast);
+float buildPhantom3D_core_materials(float *A, unsigned char *L, float *M, int NumMaterials, int ModelSelected, int N, char *ModelParametersFilename, float Weight, int Z1, int Z2, int Fast);
+float buildPhantom3D_core_single_materials(float *A, unsigned char *L, float *M, int NumMaterials, int Material, int N,  int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float psi_gr1, float psi_gr2, float psi_gr3, int Overwrite, int Z1, int Z2, int Fast);
+float buildPhantom3D_core_single_box(float *A, unsigned char *L, float *M, int NumMaterials, int Material, int N,  int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float psi_gr1, float psi_gr2, float psi_gr3, int Overwrite, int Z1, int Z2, int I1, int I2, int J1, int J2, int Fast);
+float buildPhantom3D_core_single(float *A, int N,  int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float psi_gr1, float psi_gr2, float psi_gr3, int Overwrite, int Z1, int Z2, int Fast);
+float parameters_check3D(float C0, float x0, float y0, float z0, float a, float b, float c);
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2017 Daniil Kazantsev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "buildPhantom4D_core.h"
+#include "utils.h"
+#include "buildPhantom3D_core.h"
+#include "buildSino3D_core.h"
+
+/* Functions to build the frames of dynamic (4D) phantoms and their sinograms incrementally: the frame t+1 is
+ * obtained from the frame t by removing the components which have changed (moved, resized, rotated or changed
+ * their intensity) and adding them with their new parameters. Only the bounding boxes of the changed components
+ * are computed, so the cost of a frame is proportional to what has changed in it.
+ *
+ * A 4D model is the sequence of the parameters of its components in every frame (Components x 11 values in the
+ * order of read_model3D, the same components in the same order in all frames). The rounding errors of the
+ * updates are of the order of the float precision of the values (a frame can be rebuilt from its parameters
+ * with buildPhantom3D_core_params/buildSino3D_core_params to remove them). The components with unreasonable
+ * parameters (see parameters_check3D) are not included, as in the full build of a frame.
+ *
+ * Input Parameters:
+ * 1. A - the phantom (N x N x N) or the sinograms (N x AngTot x P, see buildSino3D_core) of the frame of Old
+ * 2. Old, New - the parameters of the components in the current and in the next frame
+ * 3. P, Th, AngTot, CenTypeIn - the geometry of the sinograms (see buildSino3D_core)
+ * 4. Fast - the precision of the kernels (see buildPhantom3D_core), the same as the one the frame was built with
+ *
+ * Output:
+ * 1. A - the phantom (the sinograms) of the frame of New, the number of the changed components is returned
+ */
+
+/* the slices [Box[0], Box[1]), the rows [Box[2], Box[3]) and the columns [Box[4], Box[5]) where the object Q
+ * (11 values) of buildPhantom3D_core_single is not zero, Sino - the slices of its sinogram
+ * (buildSino3D_core_single), returns 0 for an empty box */
+static int object_box4D(const float *Q, int N, int Sino, int *Box)
+{
+    int Obj = (int)Q[0], n;
+    float H_x = 2.0f/(float)N, R, Rz, Centre[3], Radius[3];
+    
+    /* the radius of the sphere (the cylinder) around the support, the objects are rotated about their centres */
+    R = fmaxf(fmaxf(fabsf(Q[5]), fabsf(Q[6])), fabsf(Q[7]));
+    Rz = R;
+    /* the gaussian underflows to zero beyond T = 110/(4 ln 2) */
+    if (Obj == 1) {R *= sqrtf(110.0f/(4.0f*logf(2.0f))); Rz = R;}
+    /* the cube is centred at 2*(x0, y0) in the plane of the slices, its box takes the whole slices */
+    if (Obj == 5) {R = 2.0f; Rz = 0.5f*fabsf(Q[7]);}
+    if (Obj == 6) {R = fmaxf(fabsf(Q[5]), fabsf(Q[6])); Rz = fabsf(Q[7]);}
+    /* the profiles of the sinograms do not extend beyond |z - z0| = c */
+    if (Sino) {R = 2.0f; Rz = fabsf(Q[7]);}
+    if ((Obj < 1) || (Obj > 6) || (Q[1] == 0.0f)) return 0;
+    
+    Centre[0] = Q[4]; Centre[1] = Q[2]; Centre[2] = Q[3];
+    Radius[0] = Rz; Radius[1] = R; Radius[2] = R;
+    for(n=0; n<3; n++) {
+        /* the grid is x_i = -1 + i*H_x, one voxel of margin on both sides */
+        Box[2*n] = (int)floorf((Centre[n] - Radius[n] + 1.0f)/H_x) - 1;
+        Box[2*n+1] = (int)ceilf((Centre[n] + Radius[n] + 1.0f)/H_x) + 2;
+        Box[2*n] = (Box[2*n] < 0) ? 0 : ((Box[2*n] > N) ? N : Box[2*n]);
+        Box[2*n+1] = (Box[2*n+1] < 0) ? 0 : ((Box[2*n+1] > N) ? N : Box[2*n+1]);
+        if (Box[2*n] >= Box[2*n+1]) return 0;
+    }
+    return 1;
+}
+
+/* the object Q multiplied by Weight is added to the phantom A in its box */
+static void phantom_update4D(float *A, int N, const float *Q, float Weight, int Fast)
+{
+    int Box[6];
+    if (parameters_check3D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7]) != 0) return;
+    if (object_box4D(Q, N, 0, Box)) {
+        buildPhantom3D_core_single_box(&A[(size_t)Box[0]*N*N], NULL, NULL, 0, -1, N, (int)Q[0], Weight*Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7], Q[8], Q[9], Q[10], 0, Box[0], Box[1], Box[2], Box[3], Box[4], Box[5], Fast);
+    }
+}
+
+/* the sinogram of the object Q multiplied by Weight is added to the sinograms A in its slices */
+static void sino_update4D(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, const float *Q, float Weight, int Fast)
+{
+    int Box[6];
+    if (parameters_check3D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7]) != 0) return;
+    if (object_box4D(Q, N, 1, Box)) {
+        buildSino3D_core_single(&A[(size_t)Box[0]*AngTot*P], N, P, Th, AngTot, CenTypeIn, (int)Q[0], Weight*Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7], Q[8], 0, Box[0], Box[1], 0, AngTot, Fast);
+    }
+}
+
+int buildPhantom4D_core_update(float *A, int N, const float *Old, const float *New, int Components, int Fast)
+{
+    int ii, Changed = 0;
+    for(ii=0; ii<Components; ii++) {
+        if (memcmp(&Old[ii*11], &New[ii*11], 11*sizeof(float)) == 0) continue;
+        phantom_update4D(A, N, &Old[ii*11], -1.0f, Fast);
+        phantom_update4D(A, N, &New[ii*11], 1.0f, Fast);
+        Changed++;
+    }
+    return Changed;
+}
+
+int buildSino4D_core_update(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, const float *Old, const float *New, int Components, int Fast)
+{
+    int ii, Changed = 0;
+    for(ii=0; ii<Components; ii++) {
+        if (memcmp(&Old[ii*11], &New[ii*11], 11*sizeof(float)) == 0) continue;
+        sino_update4D(A, N, P, Th, AngTot, CenTypeIn, &Old[ii*11], -1.0f, Fast);
+        sino_update4D(A, N, P, Th, AngTot, CenTypeIn, &New[ii*11], 1.0f, Fast);
+        Changed++;
+    }
+    return Changed;
+}
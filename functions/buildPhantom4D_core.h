@@ -0,0 +1,32 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef BUILDPHANTOM4D_CORE_H
+#define BUILDPHANTOM4D_CORE_H
+
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int buildPhantom4D_core_update(float *A, int N, const float *Old, const float *New, int Components, int Fast);
+int buildSino4D_core_update(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, const float *Old, const float *New, int Components, int Fast);
+#ifdef __cplusplus
+}
+#endif
+#endif
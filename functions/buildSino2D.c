@@ -69,10 +69,11 @@ void mexFunction(
     NStructElems = mxGetNumberOfElements(prhs[3]);
     
     /*Handling Matlab output data*/
-    int N_dims[] = {P, NStructElems}; /*format: detectors, angles dim*/
-    A = (float*)mxGetPr(plhs[0] = mxCreateNumericArray(2, N_dims, mxSINGLE_CLASS, mxREAL));    
+    mwSize N_dims[] = {P, NStructElems}; /*format: detectors, angles dim*/
+    A = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray(2, N_dims, mxSINGLE_CLASS, mxREAL));    
         
-    buildSino2D_core(A, ModelSelected, N, P, Th, (int)NStructElems, CenTypeIn, ModelParameters_PATH);
+    /* the output is not initialised, the first object overwrites it */
+    buildSino2D_core(A, ModelSelected, N, P, Th, (int)NStructElems, CenTypeIn, ModelParameters_PATH, 1, 1.0f, 0);
     
     mxFree(ModelParameters_PATH);
 }
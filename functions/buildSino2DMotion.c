@@ -0,0 +1,77 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mex.h"
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "buildSino2D_core.h"
+
+/* Function to create 2D analytical sinograms (parallel beam geometry) of the objects which move during the acquisition,
+ * every projection is computed with the parameters of the objects at its angle (MATLAB wrapper)
+ *
+ * Input Parameters:
+ * 1. Parameters of the objects in single precision [7, length(Th), Components]: every column is
+ *    [Object, C0, x0, y0, a, b, phi_rot] of an object (as of Phantom2DLibrary.dat, Object: 1 - gaussian, 2 - parabola,
+ *    3 - ellipse, 4 - parabola1, 5 - cone, 6 - rectangle) at the corresponding angle [required]
+ * 2. ImageSize in pixels (N x N) [required]
+ * 3. Detector array size P (in pixels) [required]
+ * 4. Projection angles Th (in degrees) [required]
+ * 5. ImageCentring, choose 'radon' or 'astra' (default) [optional]
+ *
+ * Output:
+ * 1. 2D sinogram size of [P, length(Th)]
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int N, CenTypeIn, P, Components;
+    float *A, *Th, *Params;
+    mwSize NStructElems;
+    
+    /*Handling Matlab input data*/
+    if ((nrhs < 4) || (nrhs > 5)) mexErrMsgTxt("Input of 4 or 5 parameters is required: Parameters, ImageSize, Detector Size, Projection angles, Centering");
+    if (mxGetClassID(prhs[0]) != mxSINGLE_CLASS) {mexErrMsgTxt("The parameters must be in a single precision"); }
+    if (mxGetClassID(prhs[3]) != mxSINGLE_CLASS) {mexErrMsgTxt("The vector of angles must be in a single precision"); }
+    
+    Params = (float*) mxGetData(prhs[0]); /* parameters of the objects */
+    N  = (int) mxGetScalar(prhs[1]); /* choosen dimension (N x N) */
+    P  = (int) mxGetScalar(prhs[2]); /* detector size */
+    Th  = (float*) mxGetData(prhs[3]); /* angles */
+    CenTypeIn = 1; /* astra-type centering is the default one */
+    
+    if (nrhs == 5)  {
+        char *CenType;
+        CenType = mxArrayToString(prhs[4]); /* 'radon' or 'astra' (default) */
+        if ((strcmp(CenType, "radon") != 0) && (strcmp(CenType, "astra") != 0)) mexErrMsgTxt("Choose 'radon' or 'astra''");
+        if (strcmp(CenType, "radon") == 0)  CenTypeIn = 0;  /* enable 'radon'-type centaering */
+        mxFree(CenType);
+    }
+    NStructElems = mxGetNumberOfElements(prhs[3]);
+    if ((NStructElems == 0) || (mxGetNumberOfElements(prhs[0]) % (7*NStructElems) != 0) || (mxGetDimensions(prhs[0])[0] != 7)) mexErrMsgTxt("The parameters must be of the size [7, length(Th), Components]");
+    Components = (int)(mxGetNumberOfElements(prhs[0])/(7*NStructElems));
+    
+    /*Handling Matlab output data*/
+    mwSize N_dims[] = {P, NStructElems}; /*format: detectors, angles dim*/
+    A = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray(2, N_dims, mxSINGLE_CLASS, mxREAL));
+    
+    /* the output is not initialised, the first object overwrites it */
+    buildSino2D_core_motion(A, N, P, Th, (int)NStructElems, CenTypeIn, Params, Components, 1, 1.0f, 0);
+}
@@ -18,6 +18,7 @@ limitations under the License.
 #include <stdio.h>
 #include "omp.h"
 #include "utils.h"
+#include "fastMath.h"
 
 #define M_PI 3.14159265358979323846
 #define EPS 0.000000001
@@ -31,17 +32,72 @@ limitations under the License.
  * 4. Projection angles Th (in degrees) [required]
  * 5. An absolute path to the file Phantom2DLibrary.dat (see OS-specific syntax-differences) [required]
  * 6. VolumeCentring, choose 'radon' or 'astra' (default) [optional]
+ * 7. Overwrite - 1: the object is written into A (the previous content is ignored, no zeroing
+ *    of A is needed), 0: the object is added to A
+ * 8. Fast - 1 - the approximations of expf and logf of fastMath.h, 0 - expf and logf of the C library (see
+ *    buildPhantom3D_core)
  *
  * Output:
  * 1. 2D sinogram size of [P, length(Th)]
  */
 
-float buildSino2D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Object, float C0, float x0, float y0, float a, float b, float phi_rot)
+/* the state of an object in a row (an angle) of the sinogram */
+typedef struct {
+    float C0, x0, y0, x00, y00, a, b, a22, b22, phi_rot_radian;
+    int Round;
+} sino_object2D;
+
+/* the state of the object Q (C0, x0, y0, a, b, phi_rot) */
+static void sino_state2D(sino_object2D *S, const float *Q, float H_x, int CenTypeIn, float Weight)
 {
-    int i, j;
-    float *Tomorange_X_Ar=NULL, Tomorange_Xmin, Tomorange_Xmax, Sinorange_Pmax, Sinorange_Pmin, H_p, H_x, C1, a22, b22, phi_rot_radian;
+    S->C0 = Weight*Q[0];
+    S->x0 = Q[1];
+    S->y0 = Q[2];
+    if (CenTypeIn == 0) {
+        /* matlab radon-iradon settings */
+        S->x00 = Q[1] + H_x;
+        S->y00 = Q[2] + H_x;
+    }
+    else {
+        /* astra-toolbox settings */
+        /*2D parallel beam*/
+        S->x00 = Q[1] + 0.5f*H_x;
+        S->y00 = Q[2] + 0.5f*H_x;
+    }
+    S->a = Q[3];
+    S->b = Q[4];
+    S->phi_rot_radian = (Q[5])*((float)M_PI/180.0f);
+    S->a22 = Q[3]*Q[3];
+    S->b22 = Q[4]*Q[4];
+    /* a round object skips the rotation: the width of its profile (delta1) is the same for all angles,
+     * the profile is still evaluated at the detectors of every angle (its position p0 changes) */
+    S->Round = (Q[3] == Q[4]);
+}
+
+/* the inverse of the squared half-width of the profile of the object S at the angle Angle (the semi-axes
+ * squared are scaled by Scale) */
+static float sino_delta2D(const sino_object2D *S, float Angle, float Scale)
+{
+    float sin_2, cos_2;
+    if (S->Round) return 1.0f/(Scale*(S->a22));
+    sin_2 = powf((sinf((Angle) + S->phi_rot_radian)),2);
+    cos_2 = powf((cosf((Angle) + S->phi_rot_radian)),2);
+    return 1.0f/(Scale*(S->a22)*cos_2+Scale*S->b22*sin_2);
+}
+
+/* buildSino2D_core_single_motion builds the object with the parameters of every row of the sinogram (motion
+ * during the acquisition): the row i is computed with Params[i*Stride + 0, ..., 5] = C0 (multiplied by Weight),
+ * x0, y0, a, b, phi_rot. The rectangles (Object 6) are the exception: their row i is the projection at the angle
+ * Th[AngTot-1-i] (the order of the rows of the static rectangles of buildSino2D_core_single), so it is computed
+ * with the parameters Params[(AngTot-1-i)*Stride + ...] of that angle. Stride = 0 - the same parameters for all
+ * rows (the projections related by 180 degrees are then computed once), the cost does not depend on Stride otherwise. */
+float buildSino2D_core_single_motion(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Object, const float *Params, int Stride, float Weight, int Overwrite, int Fast)
+{
+    int i, j, ii, NBase, *Base=NULL, *Mirror=NULL, j1, j2;
+    float *Tomorange_X_Ar=NULL, Tomorange_Xmin, Tomorange_Xmax, Sinorange_Pmax, Sinorange_Pmin, H_p, H_x, C1;
     float *Sinorange_P_Ar=NULL, *AnglesRad=NULL;
-    float AA5, sin_2, cos_2, delta1, delta_sq, first_dr, AA2, AA3, AA6, under_exp, x00, y00;
+    float AA5, delta1, delta_sq, first_dr, AA2, AA3, AA6, under_exp, GaussWidth;
+    sino_object2D St;
     
     Sinorange_Pmax = (float)(P)/(float)(N+1);
     Sinorange_Pmin = -Sinorange_Pmax;
@@ -57,114 +113,152 @@ float buildSino2D_core_single(float *A, int N, int P, float *Th, int AngTot, int
     for(i=0; i<N; i++)  {Tomorange_X_Ar[i] = Tomorange_Xmin + (float)i*H_x;}
     AnglesRad = malloc(AngTot*sizeof(float));
     for(i=0; i<AngTot; i++)  AnglesRad[i] = (Th[i])*((float)M_PI/180.0f);
-    
-    C1 = -4.0f*logf(2.0f);
-    
-    if (CenTypeIn == 0) {
-        /* matlab radon-iradon settings */
-        x00 = x0 + H_x;
-        y00 = y0 + H_x;
-    }
+    /* the projections related by 180 degrees are computed once (the rectangle is computed for all angles),
+     * all projections are computed if the object moves */
+    Base = malloc(AngTot*sizeof(int));
+    Mirror = malloc(AngTot*sizeof(int));
+    if (Stride == 0) NBase = sino_mirrors(Th, 0, AngTot, Base, Mirror);
     else {
-        /* astra-toolbox settings */
-        /*2D parallel beam*/
-        x00 = x0 + 0.5f*H_x;
-        y00 = y0 + 0.5f*H_x;
+        for(i=0; i<AngTot; i++) {Base[i] = i; Mirror[i] = -1;}
+        NBase = AngTot;
     }
     
-    /************************************************/
-    phi_rot_radian = (phi_rot)*((float)M_PI/180.0f);
-    a22 = a*a;
-    b22 = b*b;
+    C1 = -4.0f*logf(2.0f);
+    /* the profiles are computed on their support only: the gaussian underflows to zero
+     * beyond |p-p0| = GaussWidth/delta_sq, the other objects vanish beyond 1/delta_sq */
+    GaussWidth = sqrtf(-110.0f/C1);
     
+    /************************************************/
     /* parameters of an object have been extracted, now run the building module */
     if (Object == 1) {
         /* The object is a gaussian */
-        AA5 = (N/2.0f)*(C0*(a)*(b)/2.0f)*sqrtf((float)M_PI/logf(2.0f));
-#pragma omp parallel for shared(A) private(i,j,sin_2,cos_2,delta1,delta_sq,first_dr,under_exp,AA2,AA3)
-        for(i=0; i<AngTot; i++) {
-            sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
-            cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
-            delta1 = 1.0f/(a22*cos_2+b22*sin_2);
+        float V[SINO_CHUNK];
+        int jn, jj;
+#pragma omp parallel for shared(A) private(i,j,j1,j2,St,AA5,delta1,delta_sq,first_dr,under_exp,jn,jj,V,AA2,AA3)
+        for(ii=0; ii<NBase; ii++) {
+            i = Base[ii];
+            sino_state2D(&St, &Params[(size_t)i*Stride], H_x, CenTypeIn, Weight);
+            AA5 = (N/2.0f)*(St.C0*(St.a)*(St.b)/2.0f)*sqrtf((float)M_PI/logf(2.0f));
+            delta1 = sino_delta2D(&St, AnglesRad[i], 1.0f);
             delta_sq = sqrtf(delta1);
             first_dr = AA5*delta_sq;
-            AA2 = -x00*cosf(AnglesRad[i])+y00*sinf(AnglesRad[i]); /*p0*/
-            for(j=0; j<P; j++) {
+            AA2 = -St.x00*cosf(AnglesRad[i])+St.y00*sinf(AnglesRad[i]); /*p0*/
+            sino_window(AA2, GaussWidth/delta_sq, Sinorange_P_Ar[0], H_p, P, &j1, &j2);
+            if (Overwrite) sino_clear(A, 0, i, j1, j2, P, Mirror);
+            if (Fast) {
+                /* the approximation of expf is inlined, so the detectors are vectorised */
+                for(j=j1; j<j2; j+=SINO_CHUNK) {
+                    jn = (j2-j < SINO_CHUNK) ? j2-j : SINO_CHUNK;
+#pragma omp simd private(AA3,under_exp)
+                    for(jj=0; jj<jn; jj++) {
+                        AA3 = powf((Sinorange_P_Ar[j+jj] - AA2),2); /*(p-p0)^2*/
+                        under_exp = (C1*AA3)*delta1;
+                        V[jj] = first_dr*fast_expf(under_exp);
+                    }
+                    sino_write_row(A, 0, i, j, j+jn, P, Mirror, V, Overwrite);
+                }
+            }
+            else for(j=j1; j<j2; j++) {
                 AA3 = powf((Sinorange_P_Ar[j] - AA2),2); /*(p-p0)^2*/
                 under_exp = (C1*AA3)*delta1;
-                A[(i)*P + (j)] += first_dr*expf(under_exp);
+                sino_write(A, 0, i, j, P, Mirror, first_dr*expf(under_exp), Overwrite);
             }}
     }
     else if (Object == 2) {
         /* the object is a parabola Lambda = 1/2 */
-        AA5 = (N/2.0f)*(((float)M_PI/2.0f)*C0*((a))*((b)));
-#pragma omp parallel for shared(A) private(i,j,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA6)
-        for(i=0; i<AngTot; i++) {
-            sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
-            cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
-            delta1 = 1.0f/(a22*cos_2+b22*sin_2);
+#pragma omp parallel for shared(A) private(i,j,j1,j2,St,AA5,delta1,delta_sq,first_dr,AA2,AA3,AA6)
+        for(ii=0; ii<NBase; ii++) {
+            i = Base[ii];
+            sino_state2D(&St, &Params[(size_t)i*Stride], H_x, CenTypeIn, Weight);
+            AA5 = (N/2.0f)*(((float)M_PI/2.0f)*St.C0*((St.a))*((St.b)));
+            delta1 = sino_delta2D(&St, AnglesRad[i], 1.0f);
             delta_sq = sqrtf(delta1);
             first_dr = AA5*delta_sq;
-            AA2 = -x00*cosf(AnglesRad[i])+y00*sinf(AnglesRad[i]); /*p0*/
-            for(j=0; j<P; j++) {
+            AA2 = -St.x00*cosf(AnglesRad[i])+St.y00*sinf(AnglesRad[i]); /*p0*/
+            sino_window(AA2, 1.0f/delta_sq, Sinorange_P_Ar[0], H_p, P, &j1, &j2);
+            if (Overwrite) sino_clear(A, 0, i, j1, j2, P, Mirror);
+            for(j=j1; j<j2; j++) {
                 AA3 = powf((Sinorange_P_Ar[j] - AA2),2); /*(p-p0)^2*/
                 AA6 = AA3*delta1;
-                if (AA6 < 1.0f) {
-                    A[(i)*P + (j)] += first_dr*(1.0f - AA6);
-                }
+                if (AA6 < 1.0f) AA6 = first_dr*(1.0f - AA6);
+                else AA6 = 0.0f;
+                sino_write(A, 0, i, j, P, Mirror, AA6, Overwrite);
             }}
     }
     else if (Object == 3) {
         /* the object is an elliptical disk */
-        AA5 = (N*C0*a*b);
-#pragma omp parallel for shared(A) private(i,j,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA6)
-        for(i=0; i<AngTot; i++) {
-            sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
-            cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
-            delta1 = 1.0f/(a22*cos_2+b22*sin_2);
+#pragma omp parallel for shared(A) private(i,j,j1,j2,St,AA5,delta1,delta_sq,first_dr,AA2,AA3,AA6)
+        for(ii=0; ii<NBase; ii++) {
+            i = Base[ii];
+            sino_state2D(&St, &Params[(size_t)i*Stride], H_x, CenTypeIn, Weight);
+            AA5 = (N*St.C0*St.a*St.b);
+            delta1 = sino_delta2D(&St, AnglesRad[i], 1.0f);
             delta_sq = sqrtf(delta1);
             first_dr = AA5*delta_sq;
-            AA2 = -x00*cosf(AnglesRad[i])+y00*sinf(AnglesRad[i]); /*p0*/
-            for(j=0; j<P; j++) {
+            AA2 = -St.x00*cosf(AnglesRad[i])+St.y00*sinf(AnglesRad[i]); /*p0*/
+            sino_window(AA2, 1.0f/delta_sq, Sinorange_P_Ar[0], H_p, P, &j1, &j2);
+            if (Overwrite) sino_clear(A, 0, i, j1, j2, P, Mirror);
+            for(j=j1; j<j2; j++) {
                 AA3 = powf((Sinorange_P_Ar[j] - AA2),2); /*(p-p0)^2*/
                 AA6 = (AA3)*delta1;
-                if (AA6 < 1.0f) {
-                    A[(i)*P + (j)] += first_dr*sqrtf(1.0f - AA6);
-                }
+                if (AA6 < 1.0f) AA6 = first_dr*sqrtf(1.0f - AA6);
+                else AA6 = 0.0f;
+                sino_write(A, 0, i, j, P, Mirror, AA6, Overwrite);
             }}
     }
     else if (Object == 4) {
         /* the object is a parabola Lambda = 1 (12)*/
-        AA5 = (N/2.0f)*(4.0f*((0.25f*(a)*(b)*C0)/2.5f));
-#pragma omp parallel for shared(A) private(i,j,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA6)
-        for(i=0; i<AngTot; i++) {
-            sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
-            cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
-            delta1 = 1.0f/(0.25f*(a22)*cos_2+0.25f*b22*sin_2);
+#pragma omp parallel for shared(A) private(i,j,j1,j2,St,AA5,delta1,delta_sq,first_dr,AA2,AA3,AA6)
+        for(ii=0; ii<NBase; ii++) {
+            i = Base[ii];
+            sino_state2D(&St, &Params[(size_t)i*Stride], H_x, CenTypeIn, Weight);
+            AA5 = (N/2.0f)*(4.0f*((0.25f*(St.a)*(St.b)*St.C0)/2.5f));
+            delta1 = sino_delta2D(&St, AnglesRad[i], 0.25f);
             delta_sq = sqrtf(delta1);
             first_dr = AA5*delta_sq;
-            AA2 = -x00*cosf(AnglesRad[i])+y00*sinf(AnglesRad[i]); /*p0*/
-            for(j=0; j<P; j++) {
+            AA2 = -St.x00*cosf(AnglesRad[i])+St.y00*sinf(AnglesRad[i]); /*p0*/
+            sino_window(AA2, 1.0f/delta_sq, Sinorange_P_Ar[0], H_p, P, &j1, &j2);
+            if (Overwrite) sino_clear(A, 0, i, j1, j2, P, Mirror);
+            for(j=j1; j<j2; j++) {
                 AA3 = powf((Sinorange_P_Ar[j] - AA2),2); /*(p-p0)^2*/
                 AA6 = AA3*delta1;
-                if (AA6 < 1.0f) {
-                    A[(i)*P + (j)] += first_dr*(1.0f - AA6);
-                }
+                if (AA6 < 1.0f) AA6 = first_dr*(1.0f - AA6);
+                else AA6 = 0.0f;
+                sino_write(A, 0, i, j, P, Mirror, AA6, Overwrite);
             }}
     }
     else if (Object == 5) {
         /* the object is a cone */
-        float pps2,rlogi,ty1;
-        AA5 = (N/2.0f)*(a*b*C0);
-#pragma omp parallel for shared(A) private(i,j,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA6,pps2,rlogi,ty1)
-        for(i=0; i<AngTot; i++) {
-            sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
-            cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
-            delta1 = 1.0f/(a22*cos_2+b22*sin_2);
+        float pps2,rlogi,ty1,V[SINO_CHUNK];
+        int jn, jj;
+#pragma omp parallel for shared(A) private(i,j,j1,j2,St,AA5,delta1,delta_sq,first_dr,AA2,AA3,AA6,pps2,rlogi,ty1,jn,jj,V)
+        for(ii=0; ii<NBase; ii++) {
+            i = Base[ii];
+            sino_state2D(&St, &Params[(size_t)i*Stride], H_x, CenTypeIn, Weight);
+            AA5 = (N/2.0f)*(St.a*St.b*St.C0);
+            delta1 = sino_delta2D(&St, AnglesRad[i], 1.0f);
             delta_sq = sqrtf(delta1);
             first_dr = AA5*delta_sq;
-            AA2 = -x00*cosf(AnglesRad[i])+y00*sinf(AnglesRad[i]); /*p0*/
-            for(j=0; j<P; j++) {
+            AA2 = -St.x00*cosf(AnglesRad[i])+St.y00*sinf(AnglesRad[i]); /*p0*/
+            sino_window(AA2, 1.0f/delta_sq, Sinorange_P_Ar[0], H_p, P, &j1, &j2);
+            if (Overwrite) sino_clear(A, 0, i, j1, j2, P, Mirror);
+            if (Fast) {
+                /* the approximation of logf is inlined and the conditions are masks, so the detectors are vectorised */
+                for(j=j1; j<j2; j+=SINO_CHUNK) {
+                    jn = (j2-j < SINO_CHUNK) ? j2-j : SINO_CHUNK;
+#pragma omp simd private(AA3,AA6,pps2,rlogi,ty1)
+                    for(jj=0; jj<jn; jj++) {
+                        AA3 = powf((Sinorange_P_Ar[j+jj] - AA2),2); /*(p-p0)^2*/
+                        AA6 = AA3*delta1;
+                        pps2 = (float)(AA6 < 1.0f)*sqrtf(fabsf(1.0f - AA6));
+                        ty1 = (1.0f + pps2)/(1.0f - pps2);
+                        rlogi = (float)((AA6 > (float)EPS) & (pps2 != 1.0f))*0.5f*AA6*fast_logf(ty1);
+                        V[jj] = first_dr*(pps2 - rlogi);
+                    }
+                    sino_write_row(A, 0, i, j, j+jn, P, Mirror, V, Overwrite);
+                }
+            }
+            else for(j=j1; j<j2; j++) {
                 AA3 = powf((Sinorange_P_Ar[j] - AA2),2); /*(p-p0)^2*/
                 AA6 = AA3*delta1;
                 pps2 = 0.0f; rlogi=0.0f;
@@ -177,33 +271,33 @@ float buildSino2D_core_single(float *A, int N, int P, float *Th, int AngTot, int
                     ty1 = (1.0f + pps2)/(1.0f - pps2);
                     if (ty1 > 0.0f) rlogi = 0.5f*AA6*logf(ty1);
                 }
-                A[(i)*P + (j)] += first_dr*(pps2 - rlogi);
+                sino_write(A, 0, i, j, P, Mirror, first_dr*(pps2 - rlogi), Overwrite);
             }}
     }
 	else if (Object == 6) {
 		/* the object is a rectangle */
 		float xwid,ywid,p00,ksi00,ksi1;
-		float PI2,p,ksi,C,S,A2,B2,FI,CF,SF,P0,TF,PC,QM,DEL,XSYC,QP,SS,x11,y11;
-
-         if (CenTypeIn == 0) {
-        /* matlab radon-iradon settings */
-        x11 = -2.0f*y0 - H_x;
-        y11 = 2.0f*x0 + H_x;
-        }
-        else {
-        /* astra-toolbox settings */
-        x11 = -2.0f*y0 - 0.5f*H_x;
-        y11 = 2.0f*x0 + 0.5f*H_x;
-        }
-        
-        xwid = b;
-		ywid = a;
-       
-		if (phi_rot_radian < 0)  {ksi1 = (float)M_PI + phi_rot_radian;}
-        else ksi1 = phi_rot_radian;
+		float PI2,p,ksi,C,S,A2,B2,FI,CF,SF,P0,TF,PC,QM,DEL,XSYC,QP,SS,x11,y11,C0;
         
-#pragma omp parallel for shared(A) private(i,j,PI2,p,ksi,C,S,A2,B2,FI,CF,SF,P0,TF,PC,QM,DEL,XSYC,QP,SS,p00,ksi00)
+#pragma omp parallel for shared(A) private(i,j,St,C0,xwid,ywid,x11,y11,ksi1,PI2,p,ksi,C,S,A2,B2,FI,CF,SF,P0,TF,PC,QM,DEL,XSYC,QP,SS,p00,ksi00)
 				for(i=0; i<AngTot; i++) {
+					/* the row i is computed with the angle (AngTot-1)-i, so with the parameters of that angle */
+					sino_state2D(&St, &Params[(size_t)((AngTot-1)-i)*Stride], H_x, CenTypeIn, Weight);
+					C0 = St.C0;
+					if (CenTypeIn == 0) {
+					/* matlab radon-iradon settings */
+					x11 = -2.0f*St.y0 - H_x;
+					y11 = 2.0f*St.x0 + H_x;
+					}
+					else {
+					/* astra-toolbox settings */
+					x11 = -2.0f*St.y0 - 0.5f*H_x;
+					y11 = 2.0f*St.x0 + 0.5f*H_x;
+					}
+					xwid = St.b;
+					ywid = St.a;
+					if (St.phi_rot_radian < 0)  {ksi1 = (float)M_PI + St.phi_rot_radian;}
+					else ksi1 = St.phi_rot_radian;
 					ksi00 = AnglesRad[(AngTot-1)-i] ; 
 					for(j=0; j<P; j++) {
 						p00 = Sinorange_P_Ar[j];
@@ -261,95 +355,112 @@ float buildSino2D_core_single(float *A, int N, int P, float *Th, int AngTot, int
                         }
                         else SS = xwid/CF*C0;                                   
                         if (PC >= QP) SS=0.0f;
-						A[i*P + (j)] += (N/2.0f)*SS;
+						A[(size_t)i*P + j] = (Overwrite ? 0.0f : A[(size_t)i*P + j]) + (N/2.0f)*SS;
 					}}
 	}
     else {
         printf("%s\n", "No such object exist!");
+        if (Overwrite) memset(A, 0, (size_t)P*AngTot*sizeof(float));
+        free(Tomorange_X_Ar); free(Sinorange_P_Ar); free(AnglesRad); free(Base); free(Mirror);
         return 0;
     }
     /************************************************/
-    free(Tomorange_X_Ar); free(Sinorange_P_Ar); free(AnglesRad);
+    free(Tomorange_X_Ar); free(Sinorange_P_Ar); free(AnglesRad); free(Base); free(Mirror);
     return *A;
 }
 
-float buildSino2D_core(float *A, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char *ModelParametersFilename)
+float buildSino2D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Object, float C0, float x0, float y0, float a, float b, float phi_rot, int Overwrite, int Fast)
 {
-    int ii, func_val;
-    FILE *in_file = fopen(ModelParametersFilename, "r"); // read parameters file
+    float Q[6] = {C0, x0, y0, a, b, phi_rot};
+    return buildSino2D_core_single_motion(A, N, P, Th, AngTot, CenTypeIn, Object, Q, 0, 1.0f, Overwrite, Fast);
+}
+
+/* Overwrite = 1: the first object is written into A and the following objects are added,
+ * so A does not need to be initialised (and it is zeroed if no object has been built);
+ * Overwrite = 0: all objects are added to A. Weight scales the intensities of all objects. */
+float buildSino2D_core(float *A, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char *ModelParametersFilename, int Overwrite, float Weight, int Fast)
+{
+    int ii, Components = 0, func_val;
+    float *Params;
+    
+    /* read the model parameters */
+    Params = read_model2D(ModelSelected, ModelParametersFilename, &Components);
     
-    if (! in_file )
-    {
-        printf("%s\n", "Parameters file does not exist or cannot be read!");
+    /* loop over all components */
+    for(ii=0; ii<Components; ii++) {
+        float *Q = &Params[ii*7];
+        /*  check that the parameters are reasonable  */
+        func_val = parameters_check2D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6]);
+        
+        /* build sinogram */
+        if (func_val == 0) {
+            buildSino2D_core_single(A, N, P, Th, AngTot, CenTypeIn, (int)Q[0], Weight*Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Overwrite, Fast);
+            Overwrite = 0;
+        }
+        else printf("\nFunction prematurely terminated, not all objects included");
     }
-    char tmpstr1[16];
-    char tmpstr2[16];
-    char tmpstr3[16];
-    char tmpstr4[16];
-    char tmpstr5[16];
-    char tmpstr6[16];
-    char tmpstr7[16];
-    char tmpstr8[16];
+    if (Overwrite) memset(A, 0, (size_t)P*AngTot*sizeof(float));
+    free(Params);
+    return *A;
+}
+
+/* Builds the sinogram of the objects which move (or change) during the acquisition: Params holds the parameters of
+ * every object in every row of the sinogram (Components x AngTot x 7 values in the order of read_model2D, the type
+ * of an object is taken from its first row), the row i is computed with the parameters of the row i, except for the
+ * rectangles, whose rows are in the reverse order of the angles and use the parameters of the row AngTot-1-i (see
+ * buildSino2D_core_single_motion). Overwrite and Weight as of buildSino2D_core. */
+float buildSino2D_core_motion(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, float *Params, int Components, int Overwrite, float Weight, int Fast)
+{
+    int ii, i, Valid, Static;
     
-    int Model = 0, Components = 0, Object = 0;
-    float C0 = 0.0f, x0 = 0.0f, y0 = 0.0f, a = 0.0f, b = 0.0f,  phi_rot = 0.0f;
+    for(ii=0; ii<Components; ii++) {
+        float *Q = &Params[(size_t)ii*AngTot*7];
+        /*  check that the parameters are reasonable in all rows */
+        Valid = Static = 1;
+        for(i=0; i<AngTot; i++) {
+            if (parameters_check2D(Q[i*7+1], Q[i*7+2], Q[i*7+3], Q[i*7+4], Q[i*7+5], Q[i*7+6]) != 0) Valid = 0;
+            if (memcmp(&Q[i*7+1], &Q[1], 6*sizeof(float)) != 0) Static = 0;
+        }
+        
+        /* build sinogram, the objects which do not move are built as static ones */
+        if (Valid) {
+            buildSino2D_core_single_motion(A, N, P, Th, AngTot, CenTypeIn, (int)Q[0], &Q[1], Static ? 0 : 7, Weight, Overwrite, Fast);
+            Overwrite = 0;
+        }
+        else printf("\nFunction prematurely terminated, not all objects included");
+    }
+    if (Overwrite) memset(A, 0, (size_t)P*AngTot*sizeof(float));
+    return *A;
+}
+
+/* Builds the basis sinograms of the materials 1, ..., NumMaterials of the model (see read_model2D_materials)
+ * into A (NumMaterials sinograms of AngTot x P values), see buildSino3D_core_materials */
+float buildSino2D_core_materials(float *A, int NumMaterials, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char *ModelParametersFilename, float Weight, int Fast)
+{
+    int ii, m, Components = 0, *Materials = NULL, *Written;
+    float *Params;
+    size_t Size = (size_t)AngTot*P;
     
-    char tempbuff[100];
-    while(!feof(in_file))
-    {
-        if (fgets(tempbuff,100,in_file)) {
-            
-            if(tempbuff[0] == '#') continue;
-            
-            sscanf(tempbuff, "%15s : %15[^;];", tmpstr1, tmpstr2);
-            /*printf("<<%s>>\n",  tmpstr1);*/
-            
-            if (strcmp(tmpstr1,"Model")==0) {
-                Model = atoi(tmpstr2);
-            }
-            
-            /*check if we got the right model */
-            if (ModelSelected == Model) {
-                /* read the model parameters */
-                printf("\nThe selected Model : %i \n", Model);
-                if (fgets(tempbuff,100,in_file)) {
-                    sscanf(tempbuff, "%15s : %15[^;];", tmpstr1, tmpstr2); }
-                if  (strcmp(tmpstr1,"Components") == 0) {
-                    Components = atoi(tmpstr2);
-                }
-                else {
-                    printf("%s\n", "The number of components is unknown!");
-                    return 0;
-                }
-                
-                /* loop over all components */
-                for(ii=0; ii<Components; ii++) {
-                    
-                    if (fgets(tempbuff,100,in_file)) {
-                        sscanf(tempbuff, "%15s : %15s %15s %15s %15s %15s %15s %15[^;];", tmpstr1, tmpstr2, tmpstr3, tmpstr4, tmpstr5, tmpstr6, tmpstr7, tmpstr8);
-                    }
-                    if  (strcmp(tmpstr1,"Object") == 0) {
-                        Object = atoi(tmpstr2); /* analytical model */
-                        C0 = (float)atof(tmpstr3); /* intensity */
-                        y0 = (float)atof(tmpstr4); /* x0 position */
-                        x0 = (float)atof(tmpstr5); /* y0 position */
-                        a = (float)atof(tmpstr6); /* a - size object */
-                        b = (float)atof(tmpstr7); /* b - size object */
-                        phi_rot = (float)atof(tmpstr8); /* phi - rotation angle */
-                        /*printf("\nObject : %i \nC0 : %f \nx0 : %f \nc : %f \n", Object, C0, x0, c);*/
-                        
-                        /*  check that the parameters are reasonable  */
-                        func_val = parameters_check2D(C0, x0, y0, a, b, phi_rot);
-                        
-                        /* build phantom */
-                        if (func_val == 0) buildSino2D_core_single(A, N, P, Th, AngTot, CenTypeIn, Object, C0, x0,y0,a,b,phi_rot);
-                        else printf("\nFunction prematurely terminated, not all objects included");    
-                    }
-                }
-                break;
-            }
+    /* read the model parameters and the materials of the objects */
+    Params = read_model2D_materials(ModelSelected, ModelParametersFilename, &Components, &Materials);
+    Written = calloc(NumMaterials > 0 ? NumMaterials : 1, sizeof(int));
+    
+    for(ii=0; ii<Components; ii++) {
+        float *Q = &Params[ii*7];
+        m = Materials[ii];
+        if ((m < 1) || (m > NumMaterials)) continue;
+        if (parameters_check2D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6]) == 0) {
+            /* the first object of a material is written into its sinogram, the following are added */
+            buildSino2D_core_single(&A[(size_t)(m-1)*Size], N, P, Th, AngTot, CenTypeIn, (int)Q[0], Weight*Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], !Written[m-1], Fast);
+            Written[m-1] = 1;
         }
+        else printf("\nFunction prematurely terminated, not all objects included");
     }
-    fclose(in_file);
+    for(m=0; m<NumMaterials; m++) {
+        if (!Written[m]) memset(&A[(size_t)m*Size], 0, Size*sizeof(float));
+    }
+    free(Written);
+    free(Params);
+    free(Materials);
     return *A;
-}
\ No newline at end of file
+}
@@ -18,5 +18,8 @@ limitations under the License.
 #include <stdio.h>
 #include "omp.h"
 
-float buildSino2D_core(float *A, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn,char* ModelParametersFilename);
-float buildSino2D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Obj, float C0, float x0, float y0, float a, float b, float phi_rot);
+float buildSino2D_core(float *A, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn,char* ModelParametersFilename, int Overwrite, float Weight, int Fast);
+float buildSino2D_core_materials(float *A, int NumMaterials, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char *ModelParametersFilename, float Weight, int Fast);
+float buildSino2D_core_motion(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, float *Params, int Components, int Overwrite, float Weight, int Fast);
+float buildSino2D_core_single_motion(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Object, const float *Params, int Stride, float Weight, int Overwrite, int Fast);
+float buildSino2D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Obj, float C0, float x0, float y0, float a, float b, float phi_rot, int Overwrite, int Fast);
@@ -69,10 +69,11 @@ void mexFunction(
     NStructElems = mxGetNumberOfElements(prhs[3]);
     
     /*Handling Matlab output data*/
-    int N_dims[] = {P, NStructElems, N}; /*format: detectors, angles dim, Z-dim*/
-    A = (float*)mxGetPr(plhs[0] = mxCreateNumericArray(3, N_dims, mxSINGLE_CLASS, mxREAL));    
+    mwSize N_dims[] = {P, NStructElems, N}; /*format: detectors, angles dim, Z-dim*/
+    A = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray(3, N_dims, mxSINGLE_CLASS, mxREAL));    
         
-    buildSino3D_core(A, ModelSelected, N, P, Th, (int)NStructElems, CenTypeIn, ModelParameters_PATH);
+    /* the output is not initialised, the first object overwrites it */
+    buildSino3D_core(A, ModelSelected, N, P, Th, (int)NStructElems, CenTypeIn, ModelParameters_PATH, 1, 1.0f, 0, N, 0, (int)NStructElems, 0);
     
     mxFree(ModelParameters_PATH);
 }
@@ -18,6 +18,7 @@ limitations under the License.
 #include <stdio.h>
 #include "omp.h"
 #include "utils.h"
+#include "fastMath.h"
 
 #define M_PI 3.14159265358979323846
 #define EPS 0.000000001
@@ -31,17 +32,23 @@ limitations under the License.
  * 4. Projection angles Th (in degrees) [required]
  * 5. An absolute path to the file Phantom3DLibrary.dat (see OS-specific differences in synthaxis) [required]
  * 6. VolumeCentring, choose 'radon' or 'astra' (default) [optional]
+ * 7. Overwrite - 1: the object is written into A (the previous content is ignored, no zeroing
+ *    of A is needed), 0: the object is added to A
+ * 8. Z1, Z2, Ang1, Ang2 - only the block of slices [Z1, Z2) and angles [Ang1, Ang2) is built (0, N, 0, AngTot
+ *    for the full sinogram), A then holds (Z2-Z1) x (Ang2-Ang1) x P values
+ * 9. Fast - 1 - the approximations of expf and logf of fastMath.h, 0 - expf and logf of the C library (see
+ *    buildPhantom3D_core)
  *
  * Output:
  * 1. 3D sinogram size of [P, length(Th), N]
  */
 
-float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float phi_rot)
+float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float phi_rot, int Overwrite, int Z1, int Z2, int Ang1, int Ang2, int Fast)
 {
-    int i, j, k;
+    int i, j, k, ii, NA = Ang2 - Ang1, NBase, *Base=NULL, *Mirror=NULL, j1, j2, Round;
     float *Tomorange_X_Ar=NULL, Tomorange_Xmin, Tomorange_Xmax, Sinorange_Pmax, Sinorange_Pmin, H_p, H_x, C1, C00, a1, b1, a22, b22, c22, c2, phi_rot_radian;
     float *Zdel = NULL, *Zdel2 = NULL, *Sinorange_P_Ar=NULL, *AnglesRad=NULL;
-    float AA5, sin_2, cos_2, delta1, delta_sq, first_dr, AA2, AA3, AA6, under_exp, x00, y00;
+    float AA5, sin_2, cos_2, delta1, delta_sq, first_dr, AA2, AA3, AA6, under_exp, x00, y00, GaussWidth;
     
     Sinorange_Pmax = (float)(P)/(float)(N+1);
     Sinorange_Pmin = -Sinorange_Pmax;
@@ -57,8 +64,18 @@ float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int
     for(i=0; i<N; i++)  {Tomorange_X_Ar[i] = Tomorange_Xmin + (float)i*H_x;}
     AnglesRad = malloc(AngTot*sizeof(float));
     for(i=0; i<AngTot; i++)  AnglesRad[i] = (Th[i])*((float)M_PI/180.0f);
+    /* the projections related by 180 degrees are computed once (the rectangle is computed for all angles) */
+    Base = malloc((NA > 0 ? NA : 1)*sizeof(int));
+    Mirror = malloc((NA > 0 ? NA : 1)*sizeof(int));
+    NBase = sino_mirrors(Th, Ang1, Ang2, Base, Mirror);
     
     C1 = -4.0f*logf(2.0f);
+    /* the profiles are computed on their support only: the gaussian underflows to zero
+     * beyond |p-p0| = GaussWidth/delta_sq, the other objects vanish beyond 1/delta_sq */
+    GaussWidth = sqrtf(-110.0f/C1);
+    /* a round object skips the rotation: the width of its profile (delta1) is the same for all angles,
+     * the profile is still evaluated at the detectors of every angle (its position p0 changes) */
+    Round = (a == b);
     
     if (CenTypeIn == 0) {
         /* matlab radon-iradon settings */
@@ -87,8 +104,10 @@ float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int
     
     if (Object == 1) {
         /* The object is a volumetric gaussian */
-#pragma omp parallel for shared(A,Zdel2) private(k,i,j,a1,b1,C00,sin_2,cos_2,delta1,delta_sq,first_dr,under_exp,AA2,AA3,AA5)
-        for(k=0; k<N; k++) {
+        float V[SINO_CHUNK];
+        int jn, jj;
+#pragma omp parallel for shared(A,Zdel2) private(k,i,j,j1,j2,ii,a1,b1,C00,sin_2,cos_2,delta1,delta_sq,first_dr,under_exp,jn,jj,V,AA2,AA3,AA5)
+        for(k=Z1; k<Z2; k++) {
             if (Zdel2[k] <= 1) {
                 a1 = a*powf((1.0f - Zdel2[k]),2);
                 if (a1 == 0.0f) a1 = (float)EPS;
@@ -99,25 +118,45 @@ float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int
                 if (C00 == 0.0f) C00 = (float)EPS;
                 
                 AA5 = (N/2.0f)*(C00*sqrtf(a1)*sqrtf(b1)/2.0f)*sqrtf((float)M_PI/logf(2.0f));
-                for(i=0; i<AngTot; i++) {
-                    sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
-                    cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
-                    delta1 = 1.0f/(a1*cos_2+b1*sin_2);
+                for(ii=0; ii<NBase; ii++) {
+                    i = Ang1 + Base[ii];
+                    if (Round) delta1 = 1.0f/(a1);
+                    else {
+                        sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
+                        cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
+                        delta1 = 1.0f/(a1*cos_2+b1*sin_2);
+                    }
                     delta_sq = sqrtf(delta1);
                     first_dr = AA5*delta_sq;
                     AA2 = -x00*cosf(AnglesRad[i])+y00*sinf(AnglesRad[i]); /*p0*/
-                    for(j=0; j<P; j++) {
+                    sino_window(AA2, GaussWidth/delta_sq, Sinorange_P_Ar[0], H_p, P, &j1, &j2);
+                    if (Overwrite) sino_clear(A, (size_t)(k-Z1)*NA*P, i-Ang1, j1, j2, P, Mirror);
+                    if (Fast) {
+                        /* the approximation of expf is inlined, so the detectors are vectorised */
+                        for(j=j1; j<j2; j+=SINO_CHUNK) {
+                            jn = (j2-j < SINO_CHUNK) ? j2-j : SINO_CHUNK;
+#pragma omp simd private(AA3,under_exp)
+                            for(jj=0; jj<jn; jj++) {
+                                AA3 = powf((Sinorange_P_Ar[j+jj] - AA2),2); /*(p-p0)^2*/
+                                under_exp = (C1*AA3)*delta1;
+                                V[jj] = first_dr*fast_expf(under_exp);
+                            }
+                            sino_write_row(A, (size_t)(k-Z1)*NA*P, i-Ang1, j, j+jn, P, Mirror, V, Overwrite);
+                        }
+                    }
+                    else for(j=j1; j<j2; j++) {
                         AA3 = powf((Sinorange_P_Ar[j] - AA2),2); /*(p-p0)^2*/
                         under_exp = (C1*AA3)*delta1;
-                        A[(k)*P*AngTot + (i)*P + (j)] += first_dr*expf(under_exp);
+                        sino_write(A, (size_t)(k-Z1)*NA*P, i-Ang1, j, P, Mirror, first_dr*expf(under_exp), Overwrite);
                     }}
             }
+            else if (Overwrite) memset(&A[(size_t)(k-Z1)*NA*P], 0, (size_t)NA*P*sizeof(float));
         } /*k-loop*/
     }
     else if (Object == 2) {
         /* the object is a parabola Lambda = 1/2 */
-#pragma omp parallel for shared(A,Zdel2) private(k,i,j,a1,b1,C00,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA5,AA6)
-        for(k=0; k<N; k++) {
+#pragma omp parallel for shared(A,Zdel2) private(k,i,j,j1,j2,ii,a1,b1,C00,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA5,AA6)
+        for(k=Z1; k<Z2; k++) {
             if (Zdel2[k] <= 1) {
                 a1 = a*powf((1.0f - Zdel2[k]),2);
                 b1 = b*powf((1.0f - Zdel2[k]),2);
@@ -126,21 +165,28 @@ float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int
                 
                 AA5 = (N/2.0f)*(((float)M_PI/2.0f)*C00*(sqrtf(a1))*(sqrtf(b1)));
                 
-                for(i=0; i<AngTot; i++) {
-                    sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
-                    cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
-                    delta1 = 1.0f/(a1*cos_2+b1*sin_2);
+                for(ii=0; ii<NBase; ii++) {
+                    i = Ang1 + Base[ii];
+                    if (Round) delta1 = 1.0f/(a1);
+                    else {
+                        sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
+                        cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
+                        delta1 = 1.0f/(a1*cos_2+b1*sin_2);
+                    }
                     delta_sq = sqrtf(delta1);
                     first_dr = AA5*delta_sq;
                     AA2 = -x00*cosf(AnglesRad[i])+y00*sinf(AnglesRad[i]); /*p0*/
-                    for(j=0; j<P; j++) {
+                    sino_window(AA2, 1.0f/delta_sq, Sinorange_P_Ar[0], H_p, P, &j1, &j2);
+                    if (Overwrite) sino_clear(A, (size_t)(k-Z1)*NA*P, i-Ang1, j1, j2, P, Mirror);
+                    for(j=j1; j<j2; j++) {
                         AA3 = powf((Sinorange_P_Ar[j] - AA2),2); /*(p-p0)^2*/
                         AA6 = AA3*delta1;
-                        if (AA6 < 1.0f) {
-                            A[(k)*P*AngTot + (i)*P + (j)] += first_dr*(1.0f - AA6);
-                        }
+                        if (AA6 < 1.0f) AA6 = first_dr*(1.0f - AA6);
+                        else AA6 = 0.0f;
+                        sino_write(A, (size_t)(k-Z1)*NA*P, i-Ang1, j, P, Mirror, AA6, Overwrite);
                     }}
             }
+            else if (Overwrite) memset(&A[(size_t)(k-Z1)*NA*P], 0, (size_t)NA*P*sizeof(float));
         } /*k-loop*/
     }
     else if (Object == 3) {
@@ -148,8 +194,8 @@ float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int
         a22 = a*a;
         b22 = b*b;
         AA5 = (N*C0*a*b);
-#pragma omp parallel for shared(A,Zdel2) private(k,i,j,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA6)
-        for(k=0; k<N; k++) {
+#pragma omp parallel for shared(A,Zdel2) private(k,i,j,j1,j2,ii,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA6)
+        for(k=Z1; k<Z2; k++) {
             if (Zdel2[k] <= 1) {
                 /* round objects case
                  * a22 = a*pow((1.0f - Zdel2[k]),2);
@@ -157,27 +203,34 @@ float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int
                  * b22 = b*pow((1.0f - Zdel2[k]),2);
                  * b2 = 1.0f/b22;
                  */
-                for(i=0; i<AngTot; i++) {
-                    sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
-                    cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
-                    delta1 = 1.0f/(a22*cos_2+b22*sin_2);
+                for(ii=0; ii<NBase; ii++) {
+                    i = Ang1 + Base[ii];
+                    if (Round) delta1 = 1.0f/(a22);
+                    else {
+                        sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
+                        cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
+                        delta1 = 1.0f/(a22*cos_2+b22*sin_2);
+                    }
                     delta_sq = sqrtf(delta1);
                     first_dr = AA5*delta_sq;
                     AA2 = -x00*cosf(AnglesRad[i])+y00*sinf(AnglesRad[i]); /*p0*/
-                    for(j=0; j<P; j++) {
+                    sino_window(AA2, 1.0f/delta_sq, Sinorange_P_Ar[0], H_p, P, &j1, &j2);
+                    if (Overwrite) sino_clear(A, (size_t)(k-Z1)*NA*P, i-Ang1, j1, j2, P, Mirror);
+                    for(j=j1; j<j2; j++) {
                         AA3 = powf((Sinorange_P_Ar[j] - AA2),2); /*(p-p0)^2*/
                         AA6 = (AA3)*delta1;
-                        if (AA6 < 1.0f) {
-                            A[(k)*P*AngTot + (i)*P + (j)] += first_dr*sqrtf(1.0f - AA6);
-                        }
+                        if (AA6 < 1.0f) AA6 = first_dr*sqrtf(1.0f - AA6);
+                        else AA6 = 0.0f;
+                        sino_write(A, (size_t)(k-Z1)*NA*P, i-Ang1, j, P, Mirror, AA6, Overwrite);
                     }}
             }
+            else if (Overwrite) memset(&A[(size_t)(k-Z1)*NA*P], 0, (size_t)NA*P*sizeof(float));
         } /*k-loop*/
     }
     else if (Object == 4) {
         /* the object is a parabola Lambda = 1 */
-#pragma omp parallel for shared(A,Zdel2) private(k,i,j,a1,b1,C00,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA5,AA6)
-        for(k=0; k<N; k++) {
+#pragma omp parallel for shared(A,Zdel2) private(k,i,j,j1,j2,ii,a1,b1,C00,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA5,AA6)
+        for(k=Z1; k<Z2; k++) {
             if (Zdel2[k] <= 1) {
                 a1 = a*powf((1.0f - Zdel2[k]),2);
                 b1 = b*powf((1.0f - Zdel2[k]),2);
@@ -185,28 +238,36 @@ float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int
                 
                 AA5 = (N/2.0f)*(4.0f*((0.25f*sqrtf(a1)*sqrtf(b1)*C00)/2.5f));
                 
-                for(i=0; i<AngTot; i++) {
-                    sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
-                    cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
-                    delta1 = 1.0f/(0.25f*(a1)*cos_2+0.25f*b1*sin_2);
+                for(ii=0; ii<NBase; ii++) {
+                    i = Ang1 + Base[ii];
+                    if (Round) delta1 = 1.0f/(0.25f*(a1));
+                    else {
+                        sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
+                        cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
+                        delta1 = 1.0f/(0.25f*(a1)*cos_2+0.25f*b1*sin_2);
+                    }
                     delta_sq = sqrtf(delta1);
                     first_dr = AA5*delta_sq;
                     AA2 = -x00*cosf(AnglesRad[i])+y00*sinf(AnglesRad[i]); /*p0*/
-                    for(j=0; j<P; j++) {
+                    sino_window(AA2, 1.0f/delta_sq, Sinorange_P_Ar[0], H_p, P, &j1, &j2);
+                    if (Overwrite) sino_clear(A, (size_t)(k-Z1)*NA*P, i-Ang1, j1, j2, P, Mirror);
+                    for(j=j1; j<j2; j++) {
                         AA3 = powf((Sinorange_P_Ar[j] - AA2),2); /*(p-p0)^2*/
                         AA6 = AA3*delta1;
-                        if (AA6 < 1.0f) {
-                            A[(k)*P*AngTot + (i)*P + (j)] += first_dr*(1.0f - AA6);
-                        }
+                        if (AA6 < 1.0f) AA6 = first_dr*(1.0f - AA6);
+                        else AA6 = 0.0f;
+                        sino_write(A, (size_t)(k-Z1)*NA*P, i-Ang1, j, P, Mirror, AA6, Overwrite);
                     }}
             }
+            else if (Overwrite) memset(&A[(size_t)(k-Z1)*NA*P], 0, (size_t)NA*P*sizeof(float));
         } /*k-loop*/
     }
     else if (Object == 5) {
         /* the object is a cone */
-        float pps2,rlogi,ty1;
-#pragma omp parallel for shared(A,Zdel2) private(k,i,j,a1,b1,C00,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA5,AA6,pps2,rlogi,ty1)
-        for(k=0; k<N; k++) {
+        float pps2,rlogi,ty1,V[SINO_CHUNK];
+        int jn, jj;
+#pragma omp parallel for shared(A,Zdel2) private(k,i,j,j1,j2,ii,a1,b1,C00,sin_2,cos_2,delta1,delta_sq,first_dr,AA2,AA3,AA5,AA6,pps2,rlogi,ty1,jn,jj,V)
+        for(k=Z1; k<Z2; k++) {
             if (Zdel2[k] <= 1) {
                 a1 = a*powf((1.0f - Zdel2[k]),2);
                 b1 = b*powf((1.0f - Zdel2[k]),2);
@@ -214,14 +275,36 @@ float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int
                 
                 AA5 = (N/2.0f)*(sqrtf(a1)*sqrtf(b1)*C00);
                 
-                for(i=0; i<AngTot; i++) {
-                    sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
-                    cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
-                    delta1 = 1.0f/(a1*cos_2 + b1*sin_2);
+                for(ii=0; ii<NBase; ii++) {
+                    i = Ang1 + Base[ii];
+                    if (Round) delta1 = 1.0f/(a1);
+                    else {
+                        sin_2 = powf((sinf((AnglesRad[i]) + phi_rot_radian)),2);
+                        cos_2 = powf((cosf((AnglesRad[i]) + phi_rot_radian)),2);
+                        delta1 = 1.0f/(a1*cos_2 + b1*sin_2);
+                    }
                     delta_sq = sqrtf(delta1);
                     first_dr = AA5*delta_sq;
                     AA2 = -x00*cosf(AnglesRad[i])+y00*sinf(AnglesRad[i]); /*p0*/
-                    for(j=0; j<P; j++) {
+                    sino_window(AA2, 1.0f/delta_sq, Sinorange_P_Ar[0], H_p, P, &j1, &j2);
+                    if (Overwrite) sino_clear(A, (size_t)(k-Z1)*NA*P, i-Ang1, j1, j2, P, Mirror);
+                    if (Fast) {
+                        /* the approximation of logf is inlined and the conditions are masks, so the detectors are vectorised */
+                        for(j=j1; j<j2; j+=SINO_CHUNK) {
+                            jn = (j2-j < SINO_CHUNK) ? j2-j : SINO_CHUNK;
+#pragma omp simd private(AA3,AA6,pps2,rlogi,ty1)
+                            for(jj=0; jj<jn; jj++) {
+                                AA3 = powf((Sinorange_P_Ar[j+jj] - AA2),2); /*(p-p0)^2*/
+                                AA6 = AA3*delta1;
+                                pps2 = (float)(AA6 < 1.0f)*sqrtf(fabsf(1.0f - AA6));
+                                ty1 = (1.0f + pps2)/(1.0f - pps2);
+                                rlogi = (float)((AA6 > (float)EPS) & (pps2 != 1.0f))*0.5f*AA6*fast_logf(ty1);
+                                V[jj] = first_dr*(pps2 - rlogi);
+                            }
+                            sino_write_row(A, (size_t)(k-Z1)*NA*P, i-Ang1, j, j+jn, P, Mirror, V, Overwrite);
+                        }
+                    }
+                    else for(j=j1; j<j2; j++) {
                         AA3 = powf((Sinorange_P_Ar[j] - AA2),2); /*(p-p0)^2*/
                         AA6 = AA3*delta1;
                         pps2 = 0.0f; rlogi=0.0f;
@@ -235,9 +318,10 @@ float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int
                             if (ty1 > 0.0f) rlogi = 0.5f*AA6*logf(ty1);
                         }
                         
-                        A[(k)*P*AngTot + (i)*P + (j)] += first_dr*(pps2 - rlogi);
+                        sino_write(A, (size_t)(k-Z1)*NA*P, i-Ang1, j, P, Mirror, first_dr*(pps2 - rlogi), Overwrite);
                     }}
             }
+            else if (Overwrite) memset(&A[(size_t)(k-Z1)*NA*P], 0, (size_t)NA*P*sizeof(float));
         } /*k-loop*/
     }
     else if (Object == 6) {
@@ -269,9 +353,9 @@ float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int
         else ksi1 = phi_rot_radian;
         
 #pragma omp parallel for shared(A,Zdel) private(k,i,j,PI2,p,ksi,C,S,A2,B2,FI,CF,SF,P0,TF,PC,QM,DEL,XSYC,QP,SS,p00,ksi00)
-        for(k=0; k<N; k++) {
+        for(k=Z1; k<Z2; k++) {
             if (fabs(Zdel[k]) < c2) {
-               for(i=0; i<AngTot; i++) {
+               for(i=Ang1; i<Ang2; i++) {
 					ksi00 = AnglesRad[(AngTot-1)-i]; 
 					for(j=0; j<P; j++) {
 						p00 = Sinorange_P_Ar[j];
@@ -330,102 +414,119 @@ float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int
                         else SS = xwid/CF*C0;                                   
                         if (PC >= QP) SS=0.0f;
                         
-                        A[(k)*P*AngTot + (i)*P + (j)] += (N/2.0f)*SS;
+                        A[((size_t)(k-Z1)*NA + (i-Ang1))*P + j] = (Overwrite ? 0.0f : A[((size_t)(k-Z1)*NA + (i-Ang1))*P + j]) + (N/2.0f)*SS;
                     }}
             }
+            else if (Overwrite) memset(&A[(size_t)(k-Z1)*NA*P], 0, (size_t)NA*P*sizeof(float));
         } /*k-loop*/
     }
     else {
         printf("%s\n", "No such object exist!");
+        if (Overwrite) memset(A, 0, (size_t)(Z2-Z1)*NA*P*sizeof(float));
+        free(Zdel); free(Zdel2); free(Tomorange_X_Ar); free(Sinorange_P_Ar); free(AnglesRad); free(Base); free(Mirror);
         return 0;
     }
     free(Zdel); free(Zdel2);
     /************************************************/
-    free(Tomorange_X_Ar); free(Sinorange_P_Ar); free(AnglesRad);
+    free(Tomorange_X_Ar); free(Sinorange_P_Ar); free(AnglesRad); free(Base); free(Mirror);
     return *A;
 }
 
-float buildSino3D_core(float *A, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char *ModelParametersFilename)
+/* Overwrite = 1: the first object is written into A and the following objects are added,
+ * so A does not need to be initialised (and it is zeroed if no object has been built);
+ * Overwrite = 0: all objects are added to A. Weight scales the intensities of all objects.
+ * Z1, Z2, Ang1, Ang2 select the block of slices and angles to build (see buildSino3D_core_single).
+ * Params holds Components objects of 11 values in the order of read_model3D. */
+float buildSino3D_core_params(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, float *Params, int Components, int Overwrite, float Weight, int Z1, int Z2, int Ang1, int Ang2, int Fast)
 {
     int ii, func_val;
-    FILE *in_file = fopen(ModelParametersFilename, "r"); // read parameters file
     
-    if (! in_file )
-    {
-        printf("%s\n", "Parameters file does not exist or cannot be read!");
+    /* loop over all components */
+    for(ii=0; ii<Components; ii++) {
+        float *Q = &Params[ii*11];
+        /*  check that the parameters are reasonable  */
+        func_val = parameters_check3D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7]);
+        
+        /* build sinogram (the in-plane rotation angle is psi1) */
+        if (func_val == 0) {
+            buildSino3D_core_single(A, N, P, Th, AngTot, CenTypeIn, (int)Q[0], Weight*Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7], Q[8], Overwrite, Z1, Z2, Ang1, Ang2, Fast);
+            Overwrite = 0;
+        }
+        else printf("\nFunction prematurely terminated, not all objects included");
     }
-    char tmpstr1[16];
-    char tmpstr2[16];
-    char tmpstr3[16];
-    char tmpstr4[16];
-    char tmpstr5[16];
-    char tmpstr6[16];
-    char tmpstr7[16];
-    char tmpstr8[16];
-    char tmpstr9[16];
-    char tmpstr10[16];
+    if (Overwrite) memset(A, 0, (size_t)(Z2-Z1)*(Ang2-Ang1)*P*sizeof(float));
+    return *A;
+}
+
+/* see buildSino3D_core_params */
+float buildSino3D_core(float *A, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char *ModelParametersFilename, int Overwrite, float Weight, int Z1, int Z2, int Ang1, int Ang2, int Fast)
+{
+    int Components = 0;
+    float *Params;
     
-    int Model = 0, Components = 0, Object = 0;
-    float C0 = 0.0f, x0 = 0.0f, y0 = 0.0f, z0 = 0.0f, a = 0.0f, b = 0.0f, c = 0.0f, phi_rot = 0.0f;
+    /* read the model parameters */
+    Params = read_model3D(ModelSelected, ModelParametersFilename, &Components);
+    buildSino3D_core_params(A, N, P, Th, AngTot, CenTypeIn, Params, Components, Overwrite, Weight, Z1, Z2, Ang1, Ang2, Fast);
+    free(Params);
+    return *A;
+}
+
+/* Builds the block of slices [Z1, Z2) and angles [Ang1, Ang2) of the sinogram into A of the compact
+ * Format with the Scale and Offset of store_compact (see buildPhantom3D_core_compact). */
+float buildSino3D_core_compact(unsigned short *A, int Format, float Scale, float Offset, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char *ModelParametersFilename, float Weight, int Z1, int Z2, int Ang1, int Ang2, int Fast)
+{
+    int k, S, NA = Ang2 - Ang1, Components = 0;
+    size_t Slab;
+    float *Params, *B;
     
-    char tempbuff[100];
-    while(!feof(in_file))
-    {
-        if (fgets(tempbuff,100,in_file)) {
-            
-            if(tempbuff[0] == '#') continue;
-            
-            sscanf(tempbuff, "%15s : %15[^;];", tmpstr1, tmpstr2);
-            /*printf("<<%s>>\n",  tmpstr1);*/
-            
-            if (strcmp(tmpstr1,"Model")==0) {
-                Model = atoi(tmpstr2);
-            }
-            
-            /*check if we got the right model */
-            if (ModelSelected == Model) {
-                /* read the model parameters */
-                printf("\nThe selected Model : %i \n", Model);
-                if (fgets(tempbuff,100,in_file)) {
-                    sscanf(tempbuff, "%15s : %15[^;];", tmpstr1, tmpstr2); }
-                if  (strcmp(tmpstr1,"Components") == 0) {
-                    Components = atoi(tmpstr2);
-                }
-                else {
-                    printf("%s\n", "The number of components is unknown!");
-                    return 0;
-                }
-                
-                /* loop over all components */
-                for(ii=0; ii<Components; ii++) {
-                    
-                    if (fgets(tempbuff,100,in_file)) {
-                        sscanf(tempbuff, "%15s : %15s %15s %15s %15s %15s %15s %15s %15s %15[^;];", tmpstr1, tmpstr2, tmpstr3, tmpstr4, tmpstr5, tmpstr6, tmpstr7, tmpstr8, tmpstr9, tmpstr10);
-                    }
-                    if  (strcmp(tmpstr1,"Object") == 0) {
-                        Object = atoi(tmpstr2); /* analytical model */
-                        C0 = (float)atof(tmpstr3); /* intensity */
-                        y0 = (float)atof(tmpstr4); /* x0 position */
-                        x0 = (float)atof(tmpstr5); /* y0 position */
-                        z0 = (float)atof(tmpstr6); /* z0 position */
-                        a = (float)atof(tmpstr7); /* a - size object */
-                        b = (float)atof(tmpstr8); /* b - size object */
-                        c = (float)atof(tmpstr9); /* c - size object */
-                        phi_rot = (float)atof(tmpstr10); /* phi - rotation angle */
-                        /*printf("\nObject : %i \nC0 : %f \nx0 : %f \nc : %f \n", Object, C0, x0, c);*/
-                        
-                        /*  check that the parameters are reasonable  */
-                        func_val = parameters_check3D(C0, x0, y0, z0, a, b, c);
-                    
-                        /* build phantom */
-                        if (func_val == 0)  buildSino3D_core_single(A, N, P, Th, AngTot, CenTypeIn, Object, C0, x0,y0,z0,a,b,c,phi_rot);
-                        else printf("\nFunction prematurely terminated, not all objects included");
-                    }
-                }
-                break;
-            }
+    if ((Z2 <= Z1) || (NA <= 0)) return 0.0f;
+    Params = read_model3D(ModelSelected, ModelParametersFilename, &Components);
+    Components = check_model3D(Params, Components);
+    Slab = COMPACT_SLAB/((size_t)NA*P);
+    if (Slab < 1) Slab = 1;
+    if (Slab > (size_t)(Z2-Z1)) Slab = (size_t)(Z2-Z1);
+    S = (int)Slab;
+    B = malloc((size_t)S*NA*P*sizeof(float));
+    for(k=Z1; k<Z2; k+=S) {
+        if (S > Z2-k) S = Z2-k;
+        buildSino3D_core_params(B, N, P, Th, AngTot, CenTypeIn, Params, Components, 1, Weight, k, k+S, Ang1, Ang2, Fast);
+        store_compact(B, &A[(size_t)(k-Z1)*NA*P], (size_t)S*NA*P, Format, Scale, Offset);
+    }
+    free(B);
+    free(Params);
+    return 0.0f;
+}
+
+/* Builds the basis sinograms of the materials 1, ..., NumMaterials of the model (see read_model3D_materials)
+ * into A (NumMaterials blocks of (Z2-Z1) x (Ang2-Ang1) x P values): every block is the sinogram of the objects
+ * of one material, so the sinograms of any attenuation of the materials are linear combinations of the blocks
+ * (see spectralSino_core). The objects without a material (or with 0) are not included. */
+float buildSino3D_core_materials(float *A, int NumMaterials, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char *ModelParametersFilename, float Weight, int Z1, int Z2, int Ang1, int Ang2, int Fast)
+{
+    int ii, m, Components = 0, *Materials = NULL, *Written;
+    float *Params;
+    size_t Size = (size_t)(Z2-Z1)*(Ang2-Ang1)*P;
+    
+    /* read the model parameters and the materials of the objects */
+    Params = read_model3D_materials(ModelSelected, ModelParametersFilename, &Components, &Materials);
+    Written = calloc(NumMaterials > 0 ? NumMaterials : 1, sizeof(int));
+    
+    for(ii=0; ii<Components; ii++) {
+        float *Q = &Params[ii*11];
+        m = Materials[ii];
+        if ((m < 1) || (m > NumMaterials)) continue;
+        if (parameters_check3D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7]) == 0) {
+            /* the first object of a material is written into its block, the following are added */
+            buildSino3D_core_single(&A[(size_t)(m-1)*Size], N, P, Th, AngTot, CenTypeIn, (int)Q[0], Weight*Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7], Q[8], !Written[m-1], Z1, Z2, Ang1, Ang2, Fast);
+            Written[m-1] = 1;
         }
+        else printf("\nFunction prematurely terminated, not all objects included");
+    }
+    for(m=0; m<NumMaterials; m++) {
+        if (!Written[m]) memset(&A[(size_t)m*Size], 0, Size*sizeof(float));
     }
-    fclose(in_file);
+    free(Written);
+    free(Params);
+    free(Materials);
     return *A;
 }
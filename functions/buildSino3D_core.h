@@ -18,5 +18,8 @@ limitations under the License.
 #include <stdio.h>
 #include "omp.h"
 
-float buildSino3D_core(float *A, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn,char* ModelParametersFilename);
-float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Obj, float C0, float x0, float y0, float z0, float a, float b, float c, float phi_rot);
+float buildSino3D_core(float *A, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn,char* ModelParametersFilename, int Overwrite, float Weight, int Z1, int Z2, int Ang1, int Ang2, int Fast);
+float buildSino3D_core_params(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, float *Params, int Components, int Overwrite, float Weight, int Z1, int Z2, int Ang1, int Ang2, int Fast);
+float buildSino3D_core_compact(unsigned short *A, int Format, float Scale, float Offset, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char *ModelParametersFilename, float Weight, int Z1, int Z2, int Ang1, int Ang2, int Fast);
+float buildSino3D_core_materials(float *A, int NumMaterials, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char *ModelParametersFilename, float Weight, int Z1, int Z2, int Ang1, int Ang2, int Fast);
+float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Obj, float C0, float x0, float y0, float z0, float a, float b, float c, float phi_rot, int Overwrite, int Z1, int Z2, int Ang1, int Ang2, int Fast);
@@ -0,0 +1,102 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mex.h"
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "buildSinoCone3D_core.h"
+
+#define M_PI 3.14159265358979323846
+
+/* Function to create 3D analytical projections (cone beam geometry, circular trajectory) to 3D phantoms
+ * using Phantom3DLibrary.dat (MATLAB wrapper)
+ *
+ * Input Parameters:
+ * 1. Model number (see Phantom3DLibrary.dat) [required]
+ * 2. VolumeSize in voxels (N x N x N) [required]
+ * 3. Detector array size [P Rows] (in pixels) [required]
+ * 4. Projection angles Th (in degrees) [required]
+ * 5. An absolute path to the file Phantom3DLibrary.dat (see OS-specific syntax-differences) [required]
+ * 6. The size of a detector pixel, scalar or [across along] the rotation axis (in voxels) [required]
+ * 7. The source to the rotation axis distance (in voxels) [required]
+ * 8. The rotation axis to the detector distance (in voxels) [required]
+ * 9. DetectorType, choose 'flat' (default) or 'curved' (cylindrical) [optional]
+ * 10. VolumeCentring, choose 'radon' or 'astra' (default) [optional]
+ *
+ * Output:
+ * 1. Projections size of [P, Rows, length(Th)]
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int ModelSelected, N, CenTypeIn, P, Rows, Curved;
+    float *A, *Th, DetSizeX, DetSizeZ, SourceOrigin, OriginDetector;
+    double *Dims, *PixelSize;
+    mwSize  NStructElems;
+    char *ModelParameters_PATH;
+    
+    /*Handling Matlab input data*/
+    if ((nrhs < 8) || (nrhs > 10)) mexErrMsgTxt("Input of 8 to 10 parameters is required: Model, VolumeSize, Detector Size [P Rows], Projection angles, PATH, Detector pixel size, Source-Origin, Origin-Detector, DetectorType, Centering");
+    if (mxGetClassID(prhs[3]) != mxSINGLE_CLASS) {mexErrMsgTxt("The vector of angles must be in a single precision"); }
+    if ((mxGetClassID(prhs[2]) != mxDOUBLE_CLASS) || (mxGetNumberOfElements(prhs[2]) != 2)) {mexErrMsgTxt("The detector size must be given as [P Rows]"); }
+    if ((mxGetClassID(prhs[5]) != mxDOUBLE_CLASS) || (mxGetNumberOfElements(prhs[5]) > 2)) {mexErrMsgTxt("The detector pixel size must be a scalar or [across along]"); }
+    
+    ModelSelected  = (int) mxGetScalar(prhs[0]); /* selected model */
+    N  = (int) mxGetScalar(prhs[1]); /* choosen dimension (N x N x N) */
+    Dims = mxGetPr(prhs[2]); /* detector size */
+    P = (int) Dims[0];
+    Rows = (int) Dims[1];
+    Th  = (float*) mxGetData(prhs[3]); /* angles */
+    ModelParameters_PATH = mxArrayToString(prhs[4]); /* provide an absolute path to the file */      
+    PixelSize = mxGetPr(prhs[5]); /* detector pixel size */
+    DetSizeX = (float) PixelSize[0];
+    DetSizeZ = (mxGetNumberOfElements(prhs[5]) == 2) ? (float) PixelSize[1] : DetSizeX;
+    SourceOrigin = (float) mxGetScalar(prhs[6]); /* source to the rotation axis */
+    OriginDetector = (float) mxGetScalar(prhs[7]); /* rotation axis to the detector */
+    if ((DetSizeX <= 0.0f) || (DetSizeZ <= 0.0f) || (SourceOrigin <= 0.5f*sqrtf(2.0f)*N) || (OriginDetector < 0.0f)) mexErrMsgTxt("The detector pixel size must be positive and the source outside of the volume");
+    Curved = 0; /* flat detector is the default one */
+    CenTypeIn = 1; /* astra-type centering is the default one */
+    
+    if (nrhs >= 9)  {
+        char *DetType;
+        DetType = mxArrayToString(prhs[8]); /* 'flat' (default) or 'curved' */
+        if ((strcmp(DetType, "flat") != 0) && (strcmp(DetType, "curved") != 0)) mexErrMsgTxt("Choose 'flat' or 'curved'");
+        if (strcmp(DetType, "curved") == 0)  Curved = 1;
+        mxFree(DetType);
+    }
+    if (nrhs == 10)  {
+        char *CenType;
+        CenType = mxArrayToString(prhs[9]); /* 'radon' or 'astra' (default) */
+        if ((strcmp(CenType, "radon") != 0) && (strcmp(CenType, "astra") != 0)) mexErrMsgTxt("Choose 'radon' or 'astra''");
+        if (strcmp(CenType, "radon") == 0)  CenTypeIn = 0;  /* enable 'radon'-type centaering */
+        mxFree(CenType);
+    }
+    NStructElems = mxGetNumberOfElements(prhs[3]);
+    
+    /*Handling Matlab output data*/
+    mwSize N_dims[] = {P, Rows, NStructElems}; /*format: detectors, detector rows, angles dim*/
+    A = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray(3, N_dims, mxSINGLE_CLASS, mxREAL));    
+        
+    /* the output is not initialised, the first object overwrites it */
+    buildSinoCone3D_core(A, ModelSelected, N, P, Rows, Th, (int)NStructElems, CenTypeIn, DetSizeX, DetSizeZ, SourceOrigin, OriginDetector, Curved, ModelParameters_PATH, 1, 1.0f);
+    
+    mxFree(ModelParameters_PATH);
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2017 Daniil Kazantsev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+#include "utils.h"
+#include "lineIntegrals_core.h"
+
+#define M_PI 3.14159265358979323846
+
+/* Function to create 3D analytical projections (cone beam geometry, circular trajectory) to 3D phantoms
+ * using Phantom3DLibrary.dat
+ *
+ * The line integrals are computed exactly along the rays from the source to every detector pixel (no
+ * phantom raster is needed). The source rotates around the z axis at the distance SourceOrigin, in every
+ * x-y plane the geometry is the one of buildSinoFan2D_core_single; the detector rows are along z.
+ *
+ * Input Parameters:
+ * 1. Model number (see Phantom3DLibrary.dat) [required]
+ * 2. VolumeSize in voxels (N x N x N) [required]
+ * 3. Detector array size P x Rows (in pixels) [required]
+ * 4. Projection angles Th (in degrees) [required]
+ * 5. An absolute path to the file Phantom3DLibrary.dat (see OS-specific syntax-differences) [required]
+ * 6. VolumeCentring, choose 'radon' or 'astra' (default) [optional]
+ * 7. DetSizeX, DetSizeZ - the size of a detector pixel across and along the rotation axis (in voxels) [required]
+ * 8. SourceOrigin, OriginDetector - the source to the rotation axis and the rotation axis to the detector
+ *    distances (in voxels), the source must be outside of the phantom [required]
+ * 9. Curved - 0: flat detector, 1: cylindrical detector centred at the source, DetSizeX is then the arc
+ *    length of a pixel at the distance SourceOrigin + OriginDetector [required]
+ * 10. Overwrite - 1: the object is written into A (the previous content is ignored, no zeroing
+ *    of A is needed), 0: the object is added to A
+ *
+ * Output:
+ * 1. Projections size of [P, Rows, length(Th)] (projection-major, A[(angle*Rows + row)*P + column])
+ */
+
+float buildSinoCone3D_core_single(float *A, int N, int P, int Rows, float *Th, int AngTot, int CenTypeIn, float DetSizeX, float DetSizeZ, float SourceOrigin, float OriginDetector, int Curved, int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float psi_gr1, float psi_gr2, float psi_gr3, int Overwrite)
+{
+    int ir, i, r, j;
+    float H_x, SD, th, dx, dy, ex, ey, sx, sy, u, v, g, wx, wy, wz, wn;
+    lineObject3D O;
+
+    H_x = 2.0f/(float)N;
+    /* the object centre is shifted as in the parallel beam sinograms */
+    if (lineObject3D_init(&O, Object, C0, x0, y0, z0, a, b, c, psi_gr1, psi_gr2, psi_gr3, (CenTypeIn == 0) ? H_x : 0.5f*H_x) != 0) {
+        if (Overwrite) memset(A, 0, (size_t)P*Rows*AngTot*sizeof(float));
+        return 0;
+    }
+    SD = (SourceOrigin + OriginDetector)*H_x;
+
+    /* parallel over projections and detector rows */
+#pragma omp parallel for shared(A) private(ir,i,r,j,th,dx,dy,ex,ey,sx,sy,u,v,g,wx,wy,wz,wn)
+    for(ir=0; ir<AngTot*Rows; ir++) {
+        i = ir/Rows;
+        r = ir - i*Rows;
+        th = Th[i]*((float)M_PI/180.0f);
+        /* the central ray and the detector axis */
+        dx = sinf(th); dy = cosf(th);
+        ex = -cosf(th); ey = sinf(th);
+        sx = -SourceOrigin*H_x*dx;
+        sy = -SourceOrigin*H_x*dy;
+        v = ((float)r - 0.5f*(float)(Rows-1))*DetSizeZ*H_x;
+        for(j=0; j<P; j++) {
+            u = (0.5f*(float)(P-1) - (float)j)*DetSizeX*H_x;
+            if (Curved) {
+                g = u/SD;
+                wx = SD*(cosf(g)*dx + sinf(g)*ex);
+                wy = SD*(cosf(g)*dy + sinf(g)*ey);
+            }
+            else {
+                wx = SD*dx + u*ex;
+                wy = SD*dy + u*ey;
+            }
+            wn = 1.0f/sqrtf(wx*wx + wy*wy + v*v);
+            wx *= wn; wy *= wn; wz = v*wn;
+            A[(size_t)ir*P + j] = (Overwrite ? 0.0f : A[(size_t)ir*P + j]) + (N/2.0f)*lineIntegral3D(&O, sx, sy, 0.0f, wx, wy, wz);
+        }
+    }
+    return *A;
+}
+
+/* Overwrite = 1: the first object is written into A and the following objects are added,
+ * so A does not need to be initialised (and it is zeroed if no object has been built);
+ * Overwrite = 0: all objects are added to A. Weight scales the intensities of all objects. */
+float buildSinoCone3D_core(float *A, int ModelSelected, int N, int P, int Rows, float *Th, int AngTot, int CenTypeIn, float DetSizeX, float DetSizeZ, float SourceOrigin, float OriginDetector, int Curved, char *ModelParametersFilename, int Overwrite, float Weight)
+{
+    int ii, Components = 0, func_val;
+    float *Params;
+
+    /* read the model parameters */
+    Params = read_model3D(ModelSelected, ModelParametersFilename, &Components);
+
+    /* loop over all components */
+    for(ii=0; ii<Components; ii++) {
+        float *Q = &Params[ii*11];
+        /*  check that the parameters are reasonable  */
+        func_val = parameters_check3D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7]);
+
+        /* build projections */
+        if (func_val == 0) {
+            buildSinoCone3D_core_single(A, N, P, Rows, Th, AngTot, CenTypeIn, DetSizeX, DetSizeZ, SourceOrigin, OriginDetector, Curved, (int)Q[0], Weight*Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7], Q[8], Q[9], Q[10], Overwrite);
+            Overwrite = 0;
+        }
+        else printf("\nFunction prematurely terminated, not all objects included");
+    }
+    if (Overwrite) memset(A, 0, (size_t)P*Rows*AngTot*sizeof(float));
+    free(Params);
+    return *A;
+}
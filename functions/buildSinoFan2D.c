@@ -0,0 +1,95 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mex.h"
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "buildSinoFan2D_core.h"
+
+#define M_PI 3.14159265358979323846
+
+/* Function to create 2D analytical sinograms (fan beam geometry) to 2D phantoms using Phantom2DLibrary.dat
+ * (MATLAB wrapper)
+ *
+ * Input Parameters:
+ * 1. Model number (see Phantom2DLibrary.dat) [required]
+ * 2. ImageSize in pixels (N x N) [required]
+ * 3. Detector array size P (in pixels) [required]
+ * 4. Projection angles Th (in degrees) [required]
+ * 5. An absolute path to the file Phantom2DLibrary.dat (see OS-specific syntax-differences) [required]
+ * 6. The size of a detector pixel (in image pixels) [required]
+ * 7. The source to the centre of rotation distance (in image pixels) [required]
+ * 8. The centre of rotation to the detector distance (in image pixels) [required]
+ * 9. DetectorType, choose 'flat' (default) or 'curved' [optional]
+ * 10. ImageCentring, choose 'radon' or 'astra' (default) [optional]
+ *
+ * Output:
+ * 1. 2D sinogram size of [P, length(Th)]
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int ModelSelected, N, CenTypeIn, P, Curved;
+    float *A, *Th, DetSize, SourceOrigin, OriginDetector;
+    mwSize  NStructElems;
+    char *ModelParameters_PATH;
+    
+    /*Handling Matlab input data*/
+    if ((nrhs < 8) || (nrhs > 10)) mexErrMsgTxt("Input of 8 to 10 parameters is required: Model, ImageSize, Detector Size, Projection angles, PATH, Detector pixel size, Source-Origin, Origin-Detector, DetectorType, Centering");
+    if (mxGetClassID(prhs[3]) != mxSINGLE_CLASS) {mexErrMsgTxt("The vector of angles must be in a single precision"); }
+    
+    ModelSelected  = (int) mxGetScalar(prhs[0]); /* selected model */
+    N  = (int) mxGetScalar(prhs[1]); /* choosen dimension (N x N) */
+    P  = (int) mxGetScalar(prhs[2]); /* detector size */
+    Th  = (float*) mxGetData(prhs[3]); /* angles */
+    ModelParameters_PATH = mxArrayToString(prhs[4]); /* provide an absolute path to the file */      
+    DetSize = (float) mxGetScalar(prhs[5]); /* detector pixel size */
+    SourceOrigin = (float) mxGetScalar(prhs[6]); /* source to the centre of rotation */
+    OriginDetector = (float) mxGetScalar(prhs[7]); /* centre of rotation to the detector */
+    if ((DetSize <= 0.0f) || (SourceOrigin <= 0.5f*sqrtf(2.0f)*N) || (OriginDetector < 0.0f)) mexErrMsgTxt("The detector pixel size must be positive and the source outside of the image");
+    Curved = 0; /* flat detector is the default one */
+    CenTypeIn = 1; /* astra-type centering is the default one */
+    
+    if (nrhs >= 9)  {
+        char *DetType;
+        DetType = mxArrayToString(prhs[8]); /* 'flat' (default) or 'curved' */
+        if ((strcmp(DetType, "flat") != 0) && (strcmp(DetType, "curved") != 0)) mexErrMsgTxt("Choose 'flat' or 'curved'");
+        if (strcmp(DetType, "curved") == 0)  Curved = 1;
+        mxFree(DetType);
+    }
+    if (nrhs == 10)  {
+        char *CenType;
+        CenType = mxArrayToString(prhs[9]); /* 'radon' or 'astra' (default) */
+        if ((strcmp(CenType, "radon") != 0) && (strcmp(CenType, "astra") != 0)) mexErrMsgTxt("Choose 'radon' or 'astra''");
+        if (strcmp(CenType, "radon") == 0)  CenTypeIn = 0;  /* enable 'radon'-type centaering */
+        mxFree(CenType);
+    }
+    NStructElems = mxGetNumberOfElements(prhs[3]);
+    
+    /*Handling Matlab output data*/
+    mwSize N_dims[] = {P, NStructElems}; /*format: detectors, angles dim*/
+    A = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray(2, N_dims, mxSINGLE_CLASS, mxREAL));    
+        
+    /* the output is not initialised, the first object overwrites it */
+    buildSinoFan2D_core(A, ModelSelected, N, P, Th, (int)NStructElems, CenTypeIn, DetSize, SourceOrigin, OriginDetector, Curved, ModelParameters_PATH, 1, 1.0f);
+    
+    mxFree(ModelParameters_PATH);
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2017 Daniil Kazantsev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+#include "utils.h"
+#include "lineIntegrals_core.h"
+
+#define M_PI 3.14159265358979323846
+
+/* Function to create 2D analytical sinograms (fan beam geometry) to 2D phantoms using Phantom2DLibrary.dat
+ *
+ * The line integrals are computed exactly along the diverging rays (no phantom raster is needed).
+ * The geometry is the one of buildSino2D_core_single with the source at the distance SourceOrigin
+ * from the centre of rotation. The detector pitch is DetSize voxels, while the parallel beam sinograms
+ * of buildSino2D_core have the pitch P*N/((N+1)*(P-1)) voxels: only with that DetSize the sinogram tends
+ * to the one of buildSino2D_core bin for bin for SourceOrigin -> Inf (in single precision the source
+ * should stay within about 1e4 voxels, the smooth objects then match to about 1e-3 of the maximum).
+ *
+ * Input Parameters:
+ * 1. Model number (see Phantom2DLibrary.dat) [required]
+ * 2. VolumeSize in voxels (N x N ) [required]
+ * 3. Detector array size P (in pixels) [required]
+ * 4. Projection angles Th (in degrees) [required]
+ * 5. An absolute path to the file Phantom2DLibrary.dat (see OS-specific syntax-differences) [required]
+ * 6. VolumeCentring, choose 'radon' or 'astra' (default) [optional]
+ * 7. DetSize - the size of a detector pixel (in voxels) [required]
+ * 8. SourceOrigin, OriginDetector - the source to the centre of rotation and the centre of rotation
+ *    to the detector distances (in voxels), the source must be outside of the phantom [required]
+ * 9. Curved - 0: flat detector, 1: curved (equiangular) detector centred at the source, DetSize
+ *    is then the arc length of a pixel at the distance SourceOrigin + OriginDetector [required]
+ * 10. Overwrite - 1: the object is written into A (the previous content is ignored, no zeroing
+ *    of A is needed), 0: the object is added to A
+ *
+ * Output:
+ * 1. 2D sinogram size of [P, length(Th)]
+ */
+
+float buildSinoFan2D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, float DetSize, float SourceOrigin, float OriginDetector, int Curved, int Object, float C0, float x0, float y0, float a, float b, float phi_rot, int Overwrite)
+{
+    int i, j;
+    float H_x, SD, th, dx, dy, ex, ey, sx, sy, u, g, wx, wy, wn;
+    lineObject2D O;
+
+    H_x = 2.0f/(float)N;
+    /* the object centre is shifted as in the parallel beam sinograms */
+    if (lineObject2D_init(&O, Object, C0, x0, y0, a, b, phi_rot, (CenTypeIn == 0) ? H_x : 0.5f*H_x) != 0) {
+        if (Overwrite) memset(A, 0, (size_t)P*AngTot*sizeof(float));
+        return 0;
+    }
+    SD = (SourceOrigin + OriginDetector)*H_x;
+
+#pragma omp parallel for shared(A) private(i,j,th,dx,dy,ex,ey,sx,sy,u,g,wx,wy,wn)
+    for(i=0; i<AngTot; i++) {
+        th = Th[i]*((float)M_PI/180.0f);
+        /* the central ray and the detector axis (the parallel beam ones) */
+        dx = sinf(th); dy = cosf(th);
+        ex = -cosf(th); ey = sinf(th);
+        sx = -SourceOrigin*H_x*dx;
+        sy = -SourceOrigin*H_x*dy;
+        for(j=0; j<P; j++) {
+            u = (0.5f*(float)(P-1) - (float)j)*DetSize*H_x;
+            if (Curved) {
+                g = u/SD;
+                wx = cosf(g)*dx + sinf(g)*ex;
+                wy = cosf(g)*dy + sinf(g)*ey;
+            }
+            else {
+                wn = 1.0f/sqrtf(SD*SD + u*u);
+                wx = (SD*dx + u*ex)*wn;
+                wy = (SD*dy + u*ey)*wn;
+            }
+            A[(size_t)i*P + j] = (Overwrite ? 0.0f : A[(size_t)i*P + j]) + (N/2.0f)*lineIntegral2D(&O, sx, sy, wx, wy);
+        }}
+    return *A;
+}
+
+/* Overwrite = 1: the first object is written into A and the following objects are added,
+ * so A does not need to be initialised (and it is zeroed if no object has been built);
+ * Overwrite = 0: all objects are added to A. Weight scales the intensities of all objects. */
+float buildSinoFan2D_core(float *A, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, float DetSize, float SourceOrigin, float OriginDetector, int Curved, char *ModelParametersFilename, int Overwrite, float Weight)
+{
+    int ii, Components = 0, func_val;
+    float *Params;
+
+    /* read the model parameters */
+    Params = read_model2D(ModelSelected, ModelParametersFilename, &Components);
+
+    /* loop over all components */
+    for(ii=0; ii<Components; ii++) {
+        float *Q = &Params[ii*7];
+        /*  check that the parameters are reasonable  */
+        func_val = parameters_check2D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6]);
+
+        /* build sinogram */
+        if (func_val == 0) {
+            buildSinoFan2D_core_single(A, N, P, Th, AngTot, CenTypeIn, DetSize, SourceOrigin, OriginDetector, Curved, (int)Q[0], Weight*Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Overwrite);
+            Overwrite = 0;
+        }
+        else printf("\nFunction prematurely terminated, not all objects included");
+    }
+    if (Overwrite) memset(A, 0, (size_t)P*AngTot*sizeof(float));
+    free(Params);
+    return *A;
+}
@@ -0,0 +1,97 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <matrix.h>
+#include "mex.h"
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "buildSino2D_core.h"
+#include "spectralSino_core.h"
+
+/* Function to create the 2D sinograms (parallel beam geometry) of energy bins from the basis sinograms of
+ * the materials of a model in Phantom2DLibrary.dat ("Material : m;" after the objects), the objects are
+ * projected once per material (MATLAB wrapper)
+ *
+ * Input Parameters:
+ * 1. Model number (see Phantom2DLibrary.dat) [required]
+ * 2. ImageSize in pixels (N x N) [required]
+ * 3. Detector array size P (in pixels) [required]
+ * 4. Projection angles Th (in degrees) [required]
+ * 5. An absolute path to the file Phantom2DLibrary.dat (see OS-specific syntax-differences) [required]
+ * 6. Mu - the attenuation of the materials at the energies [materials x energies], single [required]
+ * 7. Weights - [] for the linear combinations of the basis sinograms (one sinogram per energy) or the spectra of
+ *    the energy bins [energies x bins], single, for the polychromatic Beer-Lambert sinograms [optional]
+ * 8. ImageCentring, choose 'radon' or 'astra' (default) [optional]
+ *
+ * Output:
+ * 1. The sinograms of the energy bins [P, length(Th), bins]
+ * 2. The basis sinograms of the materials [P, length(Th), materials]
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int ModelSelected, N, CenTypeIn, P, NumMaterials, NumEnergies, NumBins;
+    float *A, *B, *Th, *Mu, *Weights = NULL;
+    mwSize NStructElems;
+    char *ModelParameters_PATH;
+    
+    /*Handling Matlab input data*/
+    if ((nrhs < 6) || (nrhs > 8)) mexErrMsgTxt("Input of 6 to 8 parameters is required: Model, ImageSize, Detector Size, Projection angles, PATH, Mu, Weights, Centering");
+    if (mxGetClassID(prhs[3]) != mxSINGLE_CLASS) {mexErrMsgTxt("The vector of angles must be in a single precision"); }
+    if (mxGetClassID(prhs[5]) != mxSINGLE_CLASS) {mexErrMsgTxt("The attenuation table must be in a single precision"); }
+    
+    ModelSelected  = (int) mxGetScalar(prhs[0]); /* selected model */
+    N  = (int) mxGetScalar(prhs[1]); /* choosen dimension (N x N) */
+    P  = (int) mxGetScalar(prhs[2]); /* detector size */
+    Th  = (float*) mxGetData(prhs[3]); /* angles */
+    Mu  = (float*) mxGetData(prhs[5]); /* materials x energies */
+    NumMaterials = (int) mxGetM(prhs[5]);
+    NumEnergies = (int) mxGetN(prhs[5]);
+    NumBins = NumEnergies;
+    if ((nrhs > 6) && !mxIsEmpty(prhs[6])) {
+        if (mxGetClassID(prhs[6]) != mxSINGLE_CLASS) {mexErrMsgTxt("The spectra must be in a single precision"); }
+        if ((int) mxGetM(prhs[6]) != NumEnergies) {mexErrMsgTxt("The spectra must be of the size [energies x bins]"); }
+        Weights = (float*) mxGetData(prhs[6]);
+        NumBins = (int) mxGetN(prhs[6]);
+    }
+    CenTypeIn = 1; /* astra-type centering is the default one */
+    if (nrhs == 8)  {
+        char *CenType;
+        CenType = mxArrayToString(prhs[7]); /* 'radon' or 'astra' (default) */
+        if ((strcmp(CenType, "radon") != 0) && (strcmp(CenType, "astra") != 0)) mexErrMsgTxt("Choose 'radon' or 'astra''");
+        if (strcmp(CenType, "radon") == 0)  CenTypeIn = 0;  /* enable 'radon'-type centaering */
+        mxFree(CenType);
+    }
+    ModelParameters_PATH = mxArrayToString(prhs[4]); /* provide an absolute path to the file */
+    NStructElems = mxGetNumberOfElements(prhs[3]);
+    
+    /*Handling Matlab output data*/
+    mwSize N_dims[] = {P, NStructElems, NumBins}; /*format: detectors, angles, bins*/
+    A = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray(3, N_dims, mxSINGLE_CLASS, mxREAL));
+    N_dims[2] = NumMaterials;
+    if (nlhs > 1) B = (float*)mxGetPr(plhs[1] = mxCreateUninitNumericArray(3, N_dims, mxSINGLE_CLASS, mxREAL));
+    else B = (float*)malloc((size_t)NumMaterials*NStructElems*P*sizeof(float));
+    
+    buildSino2D_core_materials(B, NumMaterials, ModelSelected, N, P, Th, (int)NStructElems, CenTypeIn, ModelParameters_PATH, 1.0f, 0);
+    spectralSino_core(A, B, NumMaterials, (int)NStructElems, P, Mu, NumEnergies, Weights, NumBins, 0);
+    
+    if (nlhs < 2) free(B);
+    mxFree(ModelParameters_PATH);
+}
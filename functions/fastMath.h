@@ -0,0 +1,71 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+/* Polynomial approximations of expf and logf used by the kernels in the fast precision mode (the
+ * Fast argument of the phantom and sinogram functions). They are defined in the header, so that they
+ * are inlined into the loops, and all selects are integer ones, so that the loops calling them can be
+ * vectorised without relaxed floating-point flags (float selects are not if-converted with
+ * -ftrapping-math).
+ *
+ * fast_expf: relative error below 8.2e-8 for x in [-87.3, 88.3] (measured over all floats), 0 for x
+ *            below about -87.7 (expf returns subnormals there), not defined for x > 88.7, inf and NaN.
+ * fast_logf: relative error below 8.2e-8 for normal positive x (measured over all floats), not
+ *            defined for x <= 0, subnormals, inf and NaN.
+ * The coefficients are the minimax polynomials of the Cephes library. */
+
+#include "utils.h"
+
+typedef union {float f; int i;} fastmath_bits;
+
+UTILS_INLINE float fast_expf(float x)
+{
+    float t, r, y, z;
+    int n;
+    fastmath_bits s;
+    /* exp(x) = 2^n exp(t), n = floor(x/ln2 + 1/2), |t| <= ln2/2 */
+    r = x*1.44269504088896341f + 0.5f;
+    n = (int)r;
+    n = n - ((float)n > r);
+    /* 2^n is 0 below the normal range and the largest power of 2 above it */
+    n = (n < -126) ? -127 : ((n > 127) ? 127 : n);
+    t = x - (float)n*0.693359375f;
+    t = t + (float)n*2.12194440e-4f;
+    z = t*t;
+    y = ((((1.9875691500e-4f*t + 1.3981999507e-3f)*t + 8.3334519073e-3f)*t + 4.1665795894e-2f)*t + 1.6666665459e-1f)*t + 5.0000001201e-1f;
+    y = y*z + t + 1.0f;
+    s.i = (n + 127) << 23;
+    return y*s.f;
+}
+
+UTILS_INLINE float fast_logf(float x)
+{
+    float e, f, z, y;
+    int k;
+    fastmath_bits u;
+    u.f = x;
+    /* x = 2^e m, m in [sqrt(1/2), sqrt(2)), k = 1 if the mantissa of x is above sqrt(2) */
+    k = ((u.i & 0x007fffff) > 0x003504f3);
+    e = (float)(((u.i >> 23) & 0xff) - 127 + k);
+    u.i = (u.i & 0x007fffff) | (0x3f800000 - (k << 23));
+    f = u.f - 1.0f;
+    z = f*f;
+    y = (((((((7.0376836292e-2f*f - 1.1514610310e-1f)*f + 1.1676998740e-1f)*f - 1.2420140846e-1f)*f + 1.4249322787e-1f)*f - 1.6668057665e-1f)*f + 2.0000714765e-1f)*f - 2.4999993993e-1f)*f + 3.3333331174e-1f;
+    y = y*f*z - 2.12194440e-4f*e - 0.5f*z;
+    return f + y + 0.693359375f*e;
+}
+
+#endif
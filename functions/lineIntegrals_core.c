@@ -0,0 +1,493 @@
+/*
+ * Copyright 2017 Daniil Kazantsev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lineIntegrals_core.h"
+#include "utils.h"
+#include "fastMath.h"
+
+#define M_PI 3.14159265358979323846
+
+/* Exact line integrals of the analytical objects along arbitrary lines
+ *
+ * The objects are the ones of buildPhantom2D_core_single and buildPhantom3D_core_single (in the [-1 1]
+ * coordinates of the phantom). A line is given by a point (px, py[, pz]) and a unit direction; the integral
+ * is taken over the whole line, therefore the point (e.g. a source) must lie outside of the object.
+ *
+ * All objects but the rectangle, the box and the cylinder are T(r) = |M(r - c)|^2 based, so along the
+ * line T = s^2 + mu^2*t^2 and the integral reduces to a 1D profile of the distance s (see profile_integral),
+ * the same in 2D and 3D.
+ */
+
+/* integral of the radial profile over the line at the (normalised) distance s2 = s^2 from the centre */
+static float profile_integral(int Profile, float s2)
+{
+    float L;
+    if (Profile == 1) {
+        /* gaussian, exp(C1*T) with C1 = -4*log(2) */
+        return expf(-4.0f*logf(2.0f)*s2)*sqrtf((float)M_PI/(4.0f*logf(2.0f)));
+    }
+    if (s2 >= 1.0f) return 0.0f;
+    L = sqrtf(1.0f - s2);
+    if (Profile == 2) return 0.5f*(float)M_PI*(1.0f - s2); /* sqrt(1 - T) */
+    if (Profile == 3) return 2.0f*L; /* constant */
+    if (Profile == 4) {
+        /* cone, 1 - sqrt(T) */
+        if (s2 > 0.0f) return L - 0.5f*s2*logf((1.0f + L)*(1.0f + L)/s2);
+        return 1.0f;
+    }
+    return 0.0f;
+}
+
+/* V2 = R*V1 for the row-major 3 x 3 matrix R (kept here, so that the per-ray code can be inlined) */
+static void rotate3(const float *R, float v0, float v1, float v2, float *V2)
+{
+    V2[0] = R[0]*v0 + R[1]*v1 + R[2]*v2;
+    V2[1] = R[3]*v0 + R[4]*v1 + R[5]*v2;
+    V2[2] = R[6]*v0 + R[7]*v1 + R[8]*v2;
+}
+
+/* clips the parameter range [*t1, *t2] of the line u0 + t*du to |u| <= h */
+static void slab_clip(float u0, float du, float h, float *t1, float *t2)
+{
+    float ta, tb;
+    if (du == 0.0f) {
+        if (fabsf(u0) > h) {*t1 = 1.0f; *t2 = 0.0f;}
+        return;
+    }
+    ta = (-h - u0)/du;
+    tb = (h - u0)/du;
+    if (ta > tb) {float tmp = ta; ta = tb; tb = tmp;}
+    if (ta > *t1) *t1 = ta;
+    if (tb < *t2) *t2 = tb;
+}
+
+/* Input Parameters:
+ * 1. Object - Analytical Model (1 - gaussian, 2 - parabola, 3 - ellipse, 4 - parabola (Lambda = 1),
+ *    5 - cone, 6 - rectangle), as in Phantom2DLibrary.dat
+ * 2. C0, x0, y0, a, b, phi_rot - the parameters of the object (as in buildPhantom2D_core_single)
+ * 3. Shift - the shift of the centre (0 for the phantom grid, see CenTypeIn of the sinograms)
+ *
+ * Output: 0 if the object is valid, 1 otherwise (the object then integrates to zero)
+ */
+int lineObject2D_init(lineObject2D *O, int Object, float C0, float x0, float y0, float a, float b, float phi_rot, float Shift)
+{
+    float phi_rot_radian = phi_rot*((float)M_PI/180.0f);
+    O->Profile = 0;
+    O->C0 = C0;
+    O->xc = x0 + Shift;
+    O->yc = y0 + Shift;
+    O->ia = 1.0f/a;
+    O->ib = 1.0f/b;
+    O->cs = cosf(phi_rot_radian);
+    O->sn = sinf(phi_rot_radian);
+    if (Object == 1) O->Profile = 1;
+    else if (Object == 2) O->Profile = 2;
+    else if (Object == 3) O->Profile = 3;
+    else if (Object == 4) {
+        /* the parabola of Lambda = 1 has the half axes a/2, b/2 */
+        O->Profile = 2;
+        O->ia = 2.0f/a;
+        O->ib = 2.0f/b;
+    }
+    else if (Object == 5) O->Profile = 4;
+    else if (Object == 6) {
+        /* the rectangle of the phantom is centred at (2*x0, 2*y0) */
+        O->Profile = 5;
+        O->xc = 2.0f*x0 + Shift;
+        O->yc = 2.0f*y0 + Shift;
+        O->ia = 0.5f*a;
+        O->ib = 0.5f*b;
+    }
+    else {
+        printf("%s\n", "No such object exist!");
+        return 1;
+    }
+    return 0;
+}
+
+float lineIntegral2D(const lineObject2D *O, float px, float py, float dx, float dy)
+{
+    float rx, ry, u0, v0, du, dv, mu2, cr, s2, t1, t2;
+
+    /* the line in the frame of the object */
+    rx = px - O->xc;
+    ry = py - O->yc;
+    u0 = rx*O->cs + ry*O->sn;
+    v0 = -rx*O->sn + ry*O->cs;
+    du = dx*O->cs + dy*O->sn;
+    dv = -dx*O->sn + dy*O->cs;
+
+    if (O->Profile == 5) {
+        /* the rectangle: the length of the chord */
+        t1 = -INFINITY; t2 = INFINITY;
+        slab_clip(u0, du, O->ia, &t1, &t2);
+        slab_clip(v0, dv, O->ib, &t1, &t2);
+        return (t2 > t1) ? O->C0*(t2 - t1) : 0.0f;
+    }
+    if (O->Profile == 0) return 0.0f;
+
+    /* normalised frame, the object is T = u^2 + v^2 */
+    u0 *= O->ia; du *= O->ia;
+    v0 *= O->ib; dv *= O->ib;
+    mu2 = du*du + dv*dv;
+    /* the squared distance of the line from the centre (the cross product does not cancel for far sources) */
+    cr = u0*dv - v0*du;
+    s2 = cr*cr/mu2;
+    return O->C0*profile_integral(O->Profile, s2)/sqrtf(mu2);
+}
+
+/* Input Parameters:
+ * 1. Object - Analytical Model (1 - gaussian, 2 - paraboloid, 3 - ellipsoid, 4 - cone, 5 - box,
+ *    6 - elliptical cylinder), as in Phantom3DLibrary.dat
+ * 2. C0, x0, y0, z0, a, b, c, psi_gr1, psi_gr2, psi_gr3 - the parameters of the object (as in
+ *    buildPhantom3D_core_single, the box and the cylinder are rotated by psi_gr1 in the x-y plane only)
+ * 3. Shift - the shift of the centre (0 for the phantom grid, see CenTypeIn of the sinograms)
+ *
+ * Output: 0 if the object is valid, 1 otherwise (the object then integrates to zero)
+ */
+int lineObject3D_init(lineObject3D *O, int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float psi_gr1, float psi_gr2, float psi_gr3, float Shift)
+{
+    float psi1 = psi_gr1*((float)M_PI/180.0f);
+    O->Profile = 0;
+    O->C0 = C0;
+    O->xc = x0 + Shift;
+    O->yc = y0 + Shift;
+    O->zc = z0 + Shift;
+    O->ia = 1.0f/a;
+    O->ib = 1.0f/b;
+    O->ic = 1.0f/c;
+    if ((Object >= 1) && (Object <= 4)) {
+        O->Profile = Object;
+        su3(O->R, psi1, psi_gr2*((float)M_PI/180.0f), psi_gr3*((float)M_PI/180.0f));
+        return 0;
+    }
+    /* in-plane rotation */
+    memset(O->R, 0, 9*sizeof(float));
+    O->R[0] = cosf(psi1); O->R[1] = sinf(psi1);
+    O->R[3] = -sinf(psi1); O->R[4] = cosf(psi1);
+    O->R[8] = 1.0f;
+    if (Object == 5) {
+        /* the box of the phantom is centred at (2*x0, 2*y0, z0) */
+        O->Profile = 5;
+        O->xc = 2.0f*x0 + Shift;
+        O->yc = 2.0f*y0 + Shift;
+        O->ia = 0.5f*a;
+        O->ib = 0.5f*b;
+        O->ic = 0.5f*c;
+    }
+    else if (Object == 6) {
+        /* the elliptical disk extended into [z0 - c, z0 + c] */
+        O->Profile = 6;
+        O->ic = c;
+    }
+    else {
+        printf("%s\n", "No such object exist!");
+        return 1;
+    }
+    return 0;
+}
+
+float lineIntegral3D(const lineObject3D *O, float px, float py, float pz, float dx, float dy, float dz)
+{
+    float q[3], m[3], cr[3], mu2, s2, t1, t2;
+
+    /* the line in the frame of the object */
+    rotate3(O->R, px - O->xc, py - O->yc, pz - O->zc, q);
+    rotate3(O->R, dx, dy, dz, m);
+
+    if (O->Profile == 5) {
+        /* the box: the length of the chord */
+        t1 = -INFINITY; t2 = INFINITY;
+        slab_clip(q[0], m[0], O->ia, &t1, &t2);
+        slab_clip(q[1], m[1], O->ib, &t1, &t2);
+        slab_clip(q[2], m[2], O->ic, &t1, &t2);
+        return (t2 > t1) ? O->C0*(t2 - t1) : 0.0f;
+    }
+    if (O->Profile == 6) {
+        /* the cylinder: the chord of the ellipse clipped by the height */
+        t1 = -INFINITY; t2 = INFINITY;
+        slab_clip(q[2], m[2], O->ic, &t1, &t2);
+        q[0] *= O->ia; m[0] *= O->ia;
+        q[1] *= O->ib; m[1] *= O->ib;
+        mu2 = m[0]*m[0] + m[1]*m[1];
+        if (mu2 == 0.0f) {
+            /* parallel to the axis */
+            if (q[0]*q[0] + q[1]*q[1] > 1.0f) return 0.0f;
+        }
+        else {
+            float tm, h;
+            cr[2] = q[0]*m[1] - q[1]*m[0];
+            s2 = cr[2]*cr[2]/mu2;
+            if (s2 >= 1.0f) return 0.0f;
+            tm = -(q[0]*m[0] + q[1]*m[1])/mu2;
+            h = sqrtf((1.0f - s2)/mu2);
+            if (tm - h > t1) t1 = tm - h;
+            if (tm + h < t2) t2 = tm + h;
+        }
+        return (t2 > t1) ? O->C0*(t2 - t1) : 0.0f;
+    }
+    if (O->Profile == 0) return 0.0f;
+
+    /* normalised frame, the object is T = u^2 + v^2 + w^2 */
+    q[0] *= O->ia; m[0] *= O->ia;
+    q[1] *= O->ib; m[1] *= O->ib;
+    q[2] *= O->ic; m[2] *= O->ic;
+    mu2 = m[0]*m[0] + m[1]*m[1] + m[2]*m[2];
+    cr[0] = q[1]*m[2] - q[2]*m[1];
+    cr[1] = q[2]*m[0] - q[0]*m[2];
+    cr[2] = q[0]*m[1] - q[1]*m[0];
+    s2 = (cr[0]*cr[0] + cr[1]*cr[1] + cr[2]*cr[2])/mu2;
+    return O->C0*profile_integral(O->Profile, s2)/sqrtf(mu2);
+}
+
+/* Batched line integrals of a model along arbitrary rays (any geometry: helical, irregular or jittered
+ * angles, subsampled detectors, ...)
+ *
+ * The rays are processed in chunks of LINE_CHUNK (in parallel over the chunks), every object is applied
+ * to the whole chunk at once. For the profile objects (1-4) the loops over the rays of a chunk are
+ * vectorised (omp simd): the distances s2 of the chunk are computed first, then the profile, which is
+ * fixed per object, is applied in a branch-free loop (see profile_batch). The other objects are
+ * integrated ray by ray.
+ *
+ * Input Parameters:
+ * 1. N - the phantom size (N x N [x N]), the rays are given in voxels relative to the centre of the phantom
+ *    (the rotation axis of the sinograms) and the integrals are scaled as the sinograms
+ * 2. Rays - NRays x 4 (2D: px, py, dx, dy) or NRays x 6 (3D: px, py, pz, dx, dy, dz), a point of the ray
+ *    (outside of the objects, e.g. the source) and its direction (not necessarily normalised, a zero
+ *    direction gives a zero integral)
+ * 3. CenTypeIn - 0: radon, 1: astra centring (as in the sinograms)
+ * 4. Params - Components x 7 (2D) or Components x 11 (3D) object parameters in the order of
+ *    read_model2D / read_model3D (Object, C0, x0, y0, ...)
+ * 5. Overwrite - 1: the integrals are written into A, 0: added to A; Weight scales all objects
+ *
+ * Output:
+ * 1. A - NRays line integrals
+ */
+
+#define LINE_CHUNK 256
+
+/* min(a, b) of non-negative floats with an integer select (see fastMath.h) */
+UTILS_INLINE float min_nonneg(float a, float b)
+{
+    fastmath_bits u, v;
+    u.f = a; v.f = b;
+    u.i = (u.i < v.i) ? u.i : v.i;
+    return u.f;
+}
+
+/* acc += w*profile_integral(Profile, s2) over n rays, one branch-free loop per profile (s2 is clamped
+ * instead of the tests, fast_expf/fast_logf replace expf/logf), so that the loops are vectorised */
+static void profile_batch(int Profile, int n, const float *s2, const float *w, float *acc)
+{
+    float s, L, C1, K;
+    int r;
+
+    if (Profile == 1) {
+        /* gaussian, clamped where expf is below the normal range (fast_expf is 0 there) */
+        C1 = -4.0f*logf(2.0f);
+        K = sqrtf((float)M_PI/(4.0f*logf(2.0f)));
+#pragma omp simd
+        for(r=0; r<n; r++) acc[r] += w[r]*K*fast_expf(C1*min_nonneg(s2[r], 40.0f));
+    }
+    else if (Profile == 2) {
+#pragma omp simd
+        for(r=0; r<n; r++) acc[r] += w[r]*0.5f*(float)M_PI*(1.0f - min_nonneg(s2[r], 1.0f));
+    }
+    else if (Profile == 3) {
+#pragma omp simd
+        for(r=0; r<n; r++) acc[r] += w[r]*2.0f*sqrtf(1.0f - min_nonneg(s2[r], 1.0f));
+    }
+    else if (Profile == 4) {
+        /* cone, 0 at s2 = 1 (L = 0 and log(1) = 0), the offset keeps the log finite at s2 = 0 */
+#pragma omp simd private(s,L)
+        for(r=0; r<n; r++) {
+            s = min_nonneg(s2[r], 1.0f) + 1.0e-30f;
+            L = sqrtf(1.0f - s);
+            acc[r] += w[r]*(L - 0.5f*s*fast_logf((1.0f + L)*(1.0f + L)/s));
+        }
+    }
+}
+
+/* the profile objects (1-4) over a chunk of rays in the frame of the phantom */
+static void quadric3D_batch(const lineObject3D *O, int n, const float *px, const float *py, const float *pz, const float *dx, const float *dy, const float *dz, float *acc)
+{
+    float s2[LINE_CHUNK], w[LINE_CHUNK], rx, ry, rz, u0, v0, w0, du, dv, dw, mu2, c0, c1, c2;
+    const float *R = O->R;
+    int r;
+
+    /* as lineIntegral3D, with the rotation written out (scalars, so that the loop is vectorised) */
+#pragma omp simd private(rx,ry,rz,u0,v0,w0,du,dv,dw,mu2,c0,c1,c2)
+    for(r=0; r<n; r++) {
+        rx = px[r] - O->xc;
+        ry = py[r] - O->yc;
+        rz = pz[r] - O->zc;
+        u0 = (R[0]*rx + R[1]*ry + R[2]*rz)*O->ia;
+        v0 = (R[3]*rx + R[4]*ry + R[5]*rz)*O->ib;
+        w0 = (R[6]*rx + R[7]*ry + R[8]*rz)*O->ic;
+        du = (R[0]*dx[r] + R[1]*dy[r] + R[2]*dz[r])*O->ia;
+        dv = (R[3]*dx[r] + R[4]*dy[r] + R[5]*dz[r])*O->ib;
+        dw = (R[6]*dx[r] + R[7]*dy[r] + R[8]*dz[r])*O->ic;
+        mu2 = du*du + dv*dv + dw*dw;
+        c0 = v0*dw - w0*dv;
+        c1 = w0*du - u0*dw;
+        c2 = u0*dv - v0*du;
+        s2[r] = (c0*c0 + c1*c1 + c2*c2)/mu2;
+        w[r] = O->C0/sqrtf(mu2);
+    }
+    profile_batch(O->Profile, n, s2, w, acc);
+}
+
+static void quadric2D_batch(const lineObject2D *O, int n, const float *px, const float *py, const float *dx, const float *dy, float *acc)
+{
+    float s2[LINE_CHUNK], w[LINE_CHUNK], rx, ry, u0, v0, du, dv, mu2, cr;
+    int r;
+
+#pragma omp simd private(rx,ry,u0,v0,du,dv,mu2,cr)
+    for(r=0; r<n; r++) {
+        rx = px[r] - O->xc;
+        ry = py[r] - O->yc;
+        u0 = (rx*O->cs + ry*O->sn)*O->ia;
+        v0 = (-rx*O->sn + ry*O->cs)*O->ib;
+        du = (dx[r]*O->cs + dy[r]*O->sn)*O->ia;
+        dv = (-dx[r]*O->sn + dy[r]*O->cs)*O->ib;
+        mu2 = du*du + dv*dv;
+        cr = u0*dv - v0*du;
+        s2[r] = cr*cr/mu2;
+        w[r] = O->C0/sqrtf(mu2);
+    }
+    profile_batch(O->Profile, n, s2, w, acc);
+}
+
+float lineIntegrals2D_core_params(float *A, int N, const float *Rays, int NRays, int CenTypeIn, const float *Params, int Components, int Overwrite, float Weight)
+{
+    int ch, ii, Chunks, Objects = 0;
+    float H_x, Shift;
+    lineObject2D *O;
+
+    if (NRays <= 0) return 0;
+    H_x = 2.0f/(float)N;
+    Shift = (CenTypeIn == 0) ? H_x : 0.5f*H_x;
+    O = (lineObject2D*) malloc((Components > 0 ? Components : 1)*sizeof(lineObject2D));
+    for(ii=0; ii<Components; ii++) {
+        const float *Q = &Params[(size_t)ii*7];
+        if (parameters_check2D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6]) != 0) {
+            printf("\nFunction prematurely terminated, not all objects included");
+            continue;
+        }
+        if (lineObject2D_init(&O[Objects], (int)Q[0], Weight*Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Shift) == 0) Objects++;
+    }
+    Chunks = (NRays + LINE_CHUNK - 1)/LINE_CHUNK;
+
+#pragma omp parallel for shared(A,O) private(ch,ii)
+    for(ch=0; ch<Chunks; ch++) {
+        float px[LINE_CHUNK], py[LINE_CHUNK], dx[LINE_CHUNK], dy[LINE_CHUNK], acc[LINE_CHUNK], ok[LINE_CHUNK], wn;
+        int r, n, First = ch*LINE_CHUNK;
+        n = (NRays - First < LINE_CHUNK) ? NRays - First : LINE_CHUNK;
+
+        /* the chunk of rays (structure of arrays) in the [-1 1] coordinates */
+        for(r=0; r<n; r++) {
+            const float *R = &Rays[(size_t)(First + r)*4];
+            px[r] = R[0]*H_x; py[r] = R[1]*H_x;
+            wn = R[2]*R[2] + R[3]*R[3];
+            ok[r] = (wn > 0.0f) ? 1.0f : 0.0f;
+            if (wn > 0.0f) {
+                wn = 1.0f/sqrtf(wn);
+                dx[r] = R[2]*wn; dy[r] = R[3]*wn;
+            }
+            else {
+                /* no direction, any line will do, the integral is masked out */
+                dx[r] = 1.0f; dy[r] = 0.0f;
+            }
+            acc[r] = 0.0f;
+        }
+        for(ii=0; ii<Objects; ii++) {
+            if ((O[ii].Profile >= 1) && (O[ii].Profile <= 4)) quadric2D_batch(&O[ii], n, px, py, dx, dy, acc);
+            else for(r=0; r<n; r++) acc[r] += lineIntegral2D(&O[ii], px[r], py[r], dx[r], dy[r]);
+        }
+        for(r=0; r<n; r++) A[(size_t)First + r] = (Overwrite ? 0.0f : A[(size_t)First + r]) + (N/2.0f)*ok[r]*acc[r];
+    }
+    free(O);
+    return *A;
+}
+
+float lineIntegrals3D_core_params(float *A, int N, const float *Rays, int NRays, int CenTypeIn, const float *Params, int Components, int Overwrite, float Weight)
+{
+    int ch, ii, Chunks, Objects = 0;
+    float H_x, Shift;
+    lineObject3D *O;
+
+    if (NRays <= 0) return 0;
+    H_x = 2.0f/(float)N;
+    Shift = (CenTypeIn == 0) ? H_x : 0.5f*H_x;
+    O = (lineObject3D*) malloc((Components > 0 ? Components : 1)*sizeof(lineObject3D));
+    for(ii=0; ii<Components; ii++) {
+        const float *Q = &Params[(size_t)ii*11];
+        if (parameters_check3D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7]) != 0) {
+            printf("\nFunction prematurely terminated, not all objects included");
+            continue;
+        }
+        if (lineObject3D_init(&O[Objects], (int)Q[0], Weight*Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7], Q[8], Q[9], Q[10], Shift) == 0) Objects++;
+    }
+    Chunks = (NRays + LINE_CHUNK - 1)/LINE_CHUNK;
+
+#pragma omp parallel for shared(A,O) private(ch,ii)
+    for(ch=0; ch<Chunks; ch++) {
+        float px[LINE_CHUNK], py[LINE_CHUNK], pz[LINE_CHUNK], dx[LINE_CHUNK], dy[LINE_CHUNK], dz[LINE_CHUNK], acc[LINE_CHUNK], ok[LINE_CHUNK], wn;
+        int r, n, First = ch*LINE_CHUNK;
+        n = (NRays - First < LINE_CHUNK) ? NRays - First : LINE_CHUNK;
+
+        /* the chunk of rays (structure of arrays) in the [-1 1] coordinates */
+        for(r=0; r<n; r++) {
+            const float *R = &Rays[(size_t)(First + r)*6];
+            px[r] = R[0]*H_x; py[r] = R[1]*H_x; pz[r] = R[2]*H_x;
+            wn = R[3]*R[3] + R[4]*R[4] + R[5]*R[5];
+            ok[r] = (wn > 0.0f) ? 1.0f : 0.0f;
+            if (wn > 0.0f) {
+                wn = 1.0f/sqrtf(wn);
+                dx[r] = R[3]*wn; dy[r] = R[4]*wn; dz[r] = R[5]*wn;
+            }
+            else {
+                /* no direction, any line will do, the integral is masked out */
+                dx[r] = 1.0f; dy[r] = 0.0f; dz[r] = 0.0f;
+            }
+            acc[r] = 0.0f;
+        }
+        for(ii=0; ii<Objects; ii++) {
+            if ((O[ii].Profile >= 1) && (O[ii].Profile <= 4)) quadric3D_batch(&O[ii], n, px, py, pz, dx, dy, dz, acc);
+            else for(r=0; r<n; r++) acc[r] += lineIntegral3D(&O[ii], px[r], py[r], pz[r], dx[r], dy[r], dz[r]);
+        }
+        for(r=0; r<n; r++) A[(size_t)First + r] = (Overwrite ? 0.0f : A[(size_t)First + r]) + (N/2.0f)*ok[r]*acc[r];
+    }
+    free(O);
+    return *A;
+}
+
+/* the same for a model of Phantom2DLibrary.dat / Phantom3DLibrary.dat */
+float lineIntegrals2D_core(float *A, int ModelSelected, int N, const float *Rays, int NRays, int CenTypeIn, char *ModelParametersFilename, int Overwrite, float Weight)
+{
+    int Components = 0;
+    float *Params = read_model2D(ModelSelected, ModelParametersFilename, &Components);
+    lineIntegrals2D_core_params(A, N, Rays, NRays, CenTypeIn, Params, Components, Overwrite, Weight);
+    free(Params);
+    return (NRays > 0) ? *A : 0;
+}
+
+float lineIntegrals3D_core(float *A, int ModelSelected, int N, const float *Rays, int NRays, int CenTypeIn, char *ModelParametersFilename, int Overwrite, float Weight)
+{
+    int Components = 0;
+    float *Params = read_model3D(ModelSelected, ModelParametersFilename, &Components);
+    lineIntegrals3D_core_params(A, N, Rays, NRays, CenTypeIn, Params, Components, Overwrite, Weight);
+    free(Params);
+    return (NRays > 0) ? *A : 0;
+}
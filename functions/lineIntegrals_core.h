@@ -0,0 +1,56 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LINEINTEGRALS_CORE_H
+#define LINEINTEGRALS_CORE_H
+
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* an object of Phantom2DLibrary.dat prepared for the line integration (see lineObject2D_init) */
+typedef struct {
+    int Profile;       /* the radial profile of the object: 0 - none, 1 - gaussian, 2 - parabola, 3 - ellipse, 4 - cone, 5 - rectangle */
+    float C0;          /* intensity */
+    float xc, yc;      /* centre */
+    float ia, ib;      /* inverse half axes (half widths for the rectangle) */
+    float cs, sn;      /* cos and sin of the rotation angle */
+} lineObject2D;
+
+/* an object of Phantom3DLibrary.dat prepared for the line integration (see lineObject3D_init) */
+typedef struct {
+    int Profile;       /* 0 - none, 1 - gaussian, 2 - paraboloid, 3 - ellipsoid, 4 - cone, 5 - box, 6 - elliptical cylinder */
+    float C0;          /* intensity */
+    float xc, yc, zc;  /* centre */
+    float ia, ib, ic;  /* inverse half axes (half widths for the box, half height for the cylinder) */
+    float R[9];        /* rotation matrix (row-major) */
+} lineObject3D;
+
+int lineObject2D_init(lineObject2D *O, int Object, float C0, float x0, float y0, float a, float b, float phi_rot, float Shift);
+float lineIntegral2D(const lineObject2D *O, float px, float py, float dx, float dy);
+int lineObject3D_init(lineObject3D *O, int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float psi_gr1, float psi_gr2, float psi_gr3, float Shift);
+float lineIntegral3D(const lineObject3D *O, float px, float py, float pz, float dx, float dy, float dz);
+float lineIntegrals2D_core_params(float *A, int N, const float *Rays, int NRays, int CenTypeIn, const float *Params, int Components, int Overwrite, float Weight);
+float lineIntegrals3D_core_params(float *A, int N, const float *Rays, int NRays, int CenTypeIn, const float *Params, int Components, int Overwrite, float Weight);
+float lineIntegrals2D_core(float *A, int ModelSelected, int N, const float *Rays, int NRays, int CenTypeIn, char *ModelParametersFilename, int Overwrite, float Weight);
+float lineIntegrals3D_core(float *A, int ModelSelected, int N, const float *Rays, int NRays, int CenTypeIn, char *ModelParametersFilename, int Overwrite, float Weight);
+#ifdef __cplusplus
+}
+#endif
+#endif
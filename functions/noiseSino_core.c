@@ -0,0 +1,185 @@
+/*
+ * Copyright 2017 Daniil Kazantsev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "noiseSino_core.h"
+
+#define M_PI 3.14159265358979323846
+
+/* Function to add the noise of a measurement to a sinogram in place
+ *
+ * The random numbers are drawn from the counter-based generator Philox4x32-10 [1]: the numbers of a value of the
+ * sinogram are a function of the seed and of the index of the value only, so the noise is the same for any
+ * number of threads and any order of the computations.
+ *
+ * Input Parameters:
+ * 1. A - sinogram (Rows x Cols values: the projections, e.g. angles, or slices x angles of a 3D sinogram stored
+ *    slice by slice, times the Cols detector pixels of a projection; the stripe gains depend on the column only)
+ * 2. I0 - the flat-field photon count: the transmission I0*exp(-Scale*A) is replaced by a Poisson count (plus the
+ *    gaussian noise of Sigma counts) and A is -log(counts/I0)/Scale (the counts are at least 1), I0 <= 0 - the
+ *    gaussian noise of Sigma is added to A
+ * 3. Scale - the attenuation of one unit of A (e.g. 1/N for the sinograms in pixels of a phantom of size N)
+ * 4. Sigma - the standard deviation of the gaussian (electronic) noise, in counts (or in the units of A)
+ * 5. ZingerProb, ZingerAmp - the probability of a zinger in a value and its amplitude (added to A)
+ * 6. StripeProb, StripeStrength - the probability of a faulty detector pixel (the stripes of the sinogram, the rings
+ *    of the reconstruction) and the maximal relative error of its gain (A is scaled by 1 + StripeStrength*[-1, 1])
+ * 7. Seed - the seed of the generator
+ *
+ * References:
+ * [1] J. K. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011
+ */
+
+/* the streams of the generator: the noises of a value are independent */
+#define NOISE_POISSON 0
+#define NOISE_GAUSS 1
+#define NOISE_ZINGER 2
+#define NOISE_STRIPE 3
+
+/* Philox4x32-10: four 32-bit random numbers of the counter C and the key K */
+static void philox4x32(const unsigned int *C, const unsigned int *K, unsigned int *R)
+{
+    int i;
+    unsigned int c0 = C[0], c1 = C[1], c2 = C[2], c3 = C[3], k0 = K[0], k1 = K[1], h0, h1;
+    unsigned long long p0, p1;
+    for(i=0; i<10; i++) {
+        p0 = 0xD2511F53ULL*(unsigned long long)c0;
+        p1 = 0xCD9E8D57ULL*(unsigned long long)c2;
+        h0 = (unsigned int)(p0 >> 32);
+        h1 = (unsigned int)(p1 >> 32);
+        c0 = h1 ^ c1 ^ k0;
+        c1 = (unsigned int)p1;
+        c2 = h0 ^ c3 ^ k1;
+        c3 = (unsigned int)p0;
+        k0 += 0x9E3779B9U;
+        k1 += 0xBB67AE85U;
+    }
+    R[0] = c0; R[1] = c1; R[2] = c2; R[3] = c3;
+}
+
+/* the uniform numbers in (0, 1) of the value Index of the stream Stream, drawn four at a time */
+typedef struct {
+    unsigned int Counter[4], Key[2], R[4];
+    int Used;
+} noise_stream;
+
+static void noise_stream_init(noise_stream *S, size_t Index, int Stream, unsigned int Seed)
+{
+    S->Counter[0] = (unsigned int)Index;
+    S->Counter[1] = (unsigned int)((unsigned long long)Index >> 32);
+    S->Counter[2] = (unsigned int)Stream;
+    S->Counter[3] = 0;
+    S->Key[0] = Seed;
+    S->Key[1] = 0x5EED5EEDU;
+    S->Used = 4;
+}
+
+static double noise_uniform(noise_stream *S)
+{
+    if (S->Used == 4) {
+        philox4x32(S->Counter, S->Key, S->R);
+        S->Counter[3]++;
+        S->Used = 0;
+    }
+    return ((double)S->R[S->Used++] + 0.5)*(1.0/4294967296.0);
+}
+
+static double noise_gauss(noise_stream *S)
+{
+    double u1 = noise_uniform(S), u2 = noise_uniform(S);
+    return sqrt(-2.0*log(u1))*cos(2.0*M_PI*u2);
+}
+
+/* the Poisson count of the mean Lambda: the multiplication of uniforms for the small means, the transformed
+ * rejection of Hormann (PTRS) otherwise */
+static double noise_poisson(noise_stream *S, double Lambda)
+{
+    double L, p, k, slam, loglam, a, b, invalpha, vr, U, V, us;
+    if (Lambda <= 0.0) return 0.0;
+    if (Lambda < 10.0) {
+        L = exp(-Lambda);
+        p = noise_uniform(S);
+        k = 0.0;
+        while (p > L) {
+            p *= noise_uniform(S);
+            k += 1.0;
+        }
+        return k;
+    }
+    slam = sqrt(Lambda);
+    loglam = log(Lambda);
+    b = 0.931 + 2.53*slam;
+    a = -0.059 + 0.02483*b;
+    invalpha = 1.1239 + 1.1328/(b - 3.4);
+    vr = 0.9277 - 3.6224/(b - 2.0);
+    while (1) {
+        U = noise_uniform(S) - 0.5;
+        V = noise_uniform(S);
+        us = 0.5 - fabs(U);
+        k = floor((2.0*a/us + b)*U + Lambda + 0.43);
+        if ((us >= 0.07) && (V <= vr)) return k;
+        if ((k < 0.0) || ((us < 0.013) && (V > us))) continue;
+        if (log(V) + log(invalpha) - log(a/(us*us) + b) <= -Lambda + k*loglam - lgamma(k + 1.0)) return k;
+    }
+}
+
+float noiseSino_core(float *A, int Rows, int Cols, float I0, float Scale, float Sigma, float ZingerProb, float ZingerAmp, float StripeProb, float StripeStrength, unsigned int Seed)
+{
+    int r, j;
+    size_t Index;
+    double Counts;
+    float *Gain = NULL;
+    noise_stream S;
+    
+    if ((I0 > 0.0f) && (Scale <= 0.0f)) {
+        printf("%s\n", "The scale of the sinogram must be positive for the Poisson noise");
+        return 0.0f;
+    }
+    if ((StripeProb > 0.0f) && (StripeStrength != 0.0f)) {
+        /* the gains of the detector pixels (the same for all projections) */
+        Gain = malloc(Cols*sizeof(float));
+        for(j=0; j<Cols; j++) {
+            noise_stream_init(&S, (size_t)j, NOISE_STRIPE, Seed);
+            Gain[j] = 1.0f;
+            if (noise_uniform(&S) < StripeProb) Gain[j] = 1.0f + StripeStrength*(float)(2.0*noise_uniform(&S) - 1.0);
+        }
+    }
+    
+#pragma omp parallel for shared(A,Gain) private(r,j,Index,Counts,S)
+    for(r=0; r<Rows; r++) {
+        for(j=0; j<Cols; j++) {
+            Index = (size_t)r*Cols + j;
+            if (Gain != NULL) A[Index] *= Gain[j];
+            if (I0 > 0.0f) {
+                /* photon counting */
+                noise_stream_init(&S, Index, NOISE_POISSON, Seed);
+                Counts = noise_poisson(&S, (double)I0*exp(-(double)Scale*A[Index]));
+                if (Sigma > 0.0f) {
+                    noise_stream_init(&S, Index, NOISE_GAUSS, Seed);
+                    Counts += Sigma*noise_gauss(&S);
+                }
+                Counts = (Counts > 1.0) ? Counts : 1.0;
+                A[Index] = (float)(-log(Counts/(double)I0)/Scale);
+            }
+            else if (Sigma > 0.0f) {
+                noise_stream_init(&S, Index, NOISE_GAUSS, Seed);
+                A[Index] += (float)(Sigma*noise_gauss(&S));
+            }
+            if (ZingerProb > 0.0f) {
+                noise_stream_init(&S, Index, NOISE_ZINGER, Seed);
+                if (noise_uniform(&S) < ZingerProb) A[Index] += ZingerAmp;
+            }
+        }
+    }
+    if (Gain != NULL) free(Gain);
+    return *A;
+}
@@ -0,0 +1,31 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef NOISESINO_CORE_H
+#define NOISESINO_CORE_H
+
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+float noiseSino_core(float *A, int Rows, int Cols, float I0, float Scale, float Sigma, float ZingerProb, float ZingerAmp, float StripeProb, float StripeStrength, unsigned int Seed);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,78 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mex.h"
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "projectJoseph_core.h"
+
+/* Function to compute the discrete parallel beam projections (Joseph's method) of 2D images (or 3D volumes slice
+ * by slice) of buildPhantom2D and buildPhantom3D in the geometry of the analytical sinograms of buildSino2D and
+ * buildSino3D (the numerical sinograms without external toolboxes, MATLAB wrapper)
+ *
+ * Input Parameters:
+ * 1. Phantom N x N (or N x N x slices), single [required]
+ * 2. Detector array size P (in pixels) [required]
+ * 3. Projection angles Th (in degrees), single [required]
+ * 4. ImageCentring, choose 'radon' or 'astra' (default) [optional]
+ *
+ * Output:
+ * 1. The sinogram of the size [P, length(Th)] (or [P, length(Th), slices])
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int number_of_dims, N, P, CenTypeIn, AngTot, Slices;
+    float *A, *S, *Th;
+    const mwSize *dim_array;
+    
+    /*Handling Matlab input data*/
+    if ((nrhs < 3) || (nrhs > 4)) mexErrMsgTxt("Input of 3 or 4 parameters is required: Phantom, Detector Size, Projection angles, Centering");
+    if (mxGetClassID(prhs[0]) != mxSINGLE_CLASS) mexErrMsgTxt("The phantom must be in a single precision");
+    if (mxGetClassID(prhs[2]) != mxSINGLE_CLASS) mexErrMsgTxt("The vector of angles must be in a single precision");
+    
+    A = (float*) mxGetData(prhs[0]);
+    number_of_dims = mxGetNumberOfDimensions(prhs[0]);
+    dim_array = mxGetDimensions(prhs[0]);
+    P = (int) mxGetScalar(prhs[1]); /* detector size */
+    Th = (float*) mxGetData(prhs[2]); /* angles */
+    CenTypeIn = 1; /* astra-type centering is the default one */
+    
+    if (nrhs == 4)  {
+        char *CenType;
+        CenType = mxArrayToString(prhs[3]); /* 'radon' or 'astra' (default) */
+        if ((strcmp(CenType, "radon") != 0) && (strcmp(CenType, "astra") != 0)) mexErrMsgTxt("Choose 'radon' or 'astra''");
+        if (strcmp(CenType, "radon") == 0)  CenTypeIn = 0;  /* enable 'radon'-type centaering */
+        mxFree(CenType);
+    }
+    N = dim_array[0];
+    if ((number_of_dims < 2) || ((int)dim_array[1] != N)) mexErrMsgTxt("The phantom must be of the size N x N or N x N x slices");
+    if (P < 2) mexErrMsgTxt("The detector size must be larger than 1");
+    AngTot = (int)mxGetNumberOfElements(prhs[2]);
+    Slices = (number_of_dims == 3) ? dim_array[2] : 1;
+    
+    /*Handling Matlab output data*/
+    mwSize N_dims[] = {P, AngTot, Slices}; /*format: detectors, angles dim, Z-dim*/
+    S = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray((Slices > 1) ? 3 : 2, N_dims, mxSINGLE_CLASS, mxREAL));
+    
+    /* every projection of the output is overwritten */
+    if ((N > 0) && (AngTot > 0) && (Slices > 0)) projectJoseph_core(S, A, N, P, Th, AngTot, CenTypeIn, Slices);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2017 Daniil Kazantsev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "projectJoseph_core.h"
+#include "utils.h"
+
+#define M_PI 3.14159265358979323846
+
+/* Function to compute the discrete parallel beam projections (Joseph's method) of the images (N x N) of
+ * buildPhantom2D_core/buildPhantom3D_core, the geometry of the analytical sinograms of buildSino2D_core/buildSino3D_core
+ * (the comparisons of the analytical and the numerical projections without external toolboxes)
+ *
+ * A ray is sampled once per column (or row) of the image it crosses at the steeper angle, the image is interpolated
+ * linearly along the column (row). The rows are read from the image and the columns from its transposed copy, the
+ * detector pixels are vectorised (the position in the row is linear in the detector position), the projections
+ * of all slices and angles are computed in parallel.
+ *
+ * Input Parameters:
+ * 1. A - Slices x N x N images (the layout of buildPhantom3D_core, 2D: Slices = 1)
+ * 2. P - the detector size
+ * 3. Th - the projection angles in degrees
+ * 4. CenTypeIn - the centring of the sinograms: 0 - radon, 1 - astra (see buildSino2D_core)
+ *
+ * Output:
+ * 1. S - Slices x AngTot x P sinograms (the layout of buildSino3D_core, the line integrals in pixels)
+ */
+
+/* adds Weight*(the row R at the positions T0 + b*dT) to S[b] for the detector pixels b of the row */
+static void joseph_row(float *S, const float *R, int N, int P, float T0, float dT, float Weight)
+{
+    int b, b1, b2;
+    float t, Lo, Hi;
+    /* the detector pixels where the position is in (-1, N) */
+    if (fabsf(dT) > 1.0e-12f) {
+        Lo = (-1.0f - T0)/dT;
+        Hi = ((float)N - T0)/dT;
+        if (Lo > Hi) {t = Lo; Lo = Hi; Hi = t;}
+        if ((Hi < 0.0f) || (Lo > (float)P)) return;
+        b1 = (Lo > 0.0f) ? (int)Lo : 0;
+        b2 = (Hi < (float)(P-1)) ? (int)Hi + 2 : P;
+        b2 = (b2 > P) ? P : b2;
+    }
+    else {
+        if ((T0 <= -1.0f) || (T0 >= (float)N)) return;
+        b1 = 0; b2 = P;
+    }
+#pragma omp simd
+    for(b=b1; b<b2; b++) S[b] += Weight*interp_linear(R, N, T0 + (float)b*dT);
+}
+
+float projectJoseph_core(float *S, const float *A, int N, int P, const float *Th, int AngTot, int CenTypeIn, int Slices)
+{
+    int i, j, k, a, t;
+    float Pmax, H_p, H_x, X0, cs, sn, *At, *Sa;
+    const float *Ak;
+    
+    /* the detector and the image grids of buildSino2D_core */
+    Pmax = (float)(P)/(float)(N+1);
+    H_p = 2.0f*Pmax/(float)(P-1);
+    H_x = 2.0f/(float)N;
+    /* the centre of the first pixel */
+    X0 = -1.0f + ((CenTypeIn == 0) ? H_x : 0.5f*H_x);
+    
+    /* the transposed images: the columns are read as rows */
+    At = malloc((size_t)Slices*N*N*sizeof(float));
+#pragma omp parallel for shared(A,At) private(k,i,j)
+    for(k=0; k<Slices; k++) {
+        for(i=0; i<N; i++) {
+            for(j=0; j<N; j++) At[((size_t)k*N + j)*N + i] = A[((size_t)k*N + i)*N + j];
+        }
+    }
+    
+    /* the ray of the detector position p: -x*cos(Th) + y*sin(Th) = p, the line integrals are in pixels */
+#pragma omp parallel for shared(S,A,At) private(t,k,a,i,j,cs,sn,Sa,Ak)
+    for(t=0; t<Slices*AngTot; t++) {
+        k = t/AngTot;
+        a = t % AngTot;
+        cs = (float)cos(Th[a]*(M_PI/180.0));
+        sn = (float)sin(Th[a]*(M_PI/180.0));
+        Sa = &S[(size_t)t*P];
+        for(j=0; j<P; j++) Sa[j] = 0.0f;
+        if (fabsf(sn) >= fabsf(cs)) {
+            /* the ray crosses the rows i (the x positions) at y = (p + x*cos)/sin */
+            Ak = &A[(size_t)k*N*N];
+            for(i=0; i<N; i++) {
+                joseph_row(Sa, &Ak[(size_t)i*N], N, P, ((Pmax + (X0 + (float)i*H_x)*cs)/sn - X0)/H_x, -H_p/(sn*H_x), 1.0f/fabsf(sn));
+            }
+        }
+        else {
+            /* the ray crosses the columns j (the y positions) at x = (y*sin - p)/cos */
+            Ak = &At[(size_t)k*N*N];
+            for(j=0; j<N; j++) {
+                joseph_row(Sa, &Ak[(size_t)j*N], N, P, (((X0 + (float)j*H_x)*sn - Pmax)/cs - X0)/H_x, H_p/(cs*H_x), 1.0f/fabsf(cs));
+            }
+        }
+    }
+    free(At);
+    return *S;
+}
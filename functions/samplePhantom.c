@@ -0,0 +1,66 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mex.h"
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "samplePhantom_core.h"
+
+/* Function to evaluate 2D or 3D models at arbitrary points (MATLAB wrapper)
+ *
+ * Input Parameters:
+ * 1. Model number (see Phantom2DLibrary.dat or Phantom3DLibrary.dat) [required]
+ * 2. Points - [2 x M] (x, y) or [3 x M] (x, y, z) coordinates in [-1 1] in single precision, the voxel
+ *    A(r, c, s) of buildPhantom2D/buildPhantom3D is at x = -1 + 2*(c-1)/N, y = -1 + 2*(r-1)/N, z = -1 + 2*(s-1)/N [required]
+ * 3. An absolute path to the file Phantom2DLibrary.dat or Phantom3DLibrary.dat (see OS-specific syntax-differences) [required]
+ *
+ * Output:
+ * 1. The values of the model size of [1, M]
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int ModelSelected, Dim;
+    float *A, *Points;
+    mwSize M;
+    char *ModelParameters_PATH;
+    
+    /*Handling Matlab input data*/
+    if (nrhs != 3) mexErrMsgTxt("Input of 3 parameters is required: Model, Points, PATH");
+    if (mxGetClassID(prhs[1]) != mxSINGLE_CLASS) {mexErrMsgTxt("The points must be in a single precision"); }
+    Dim = (int) mxGetM(prhs[1]);
+    if ((Dim != 2) && (Dim != 3)) {mexErrMsgTxt("The points must be given as [2 x M] (2D) or [3 x M] (3D)"); }
+    
+    ModelSelected  = (int) mxGetScalar(prhs[0]); /* selected model */
+    Points = (float*) mxGetData(prhs[1]); /* points */
+    M = mxGetN(prhs[1]);
+    ModelParameters_PATH = mxArrayToString(prhs[2]); /* provide an absolute path to the file */
+    
+    /*Handling Matlab output data*/
+    mwSize N_dims[] = {1, M};
+    A = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray(2, N_dims, mxSINGLE_CLASS, mxREAL));
+    
+    /* the columns of Points are the points, i.e. the [M x Dim] C-order array */
+    if (Dim == 2) samplePhantom2D_core(A, ModelSelected, Points, (int)M, ModelParameters_PATH, 1, 1.0f);
+    else samplePhantom3D_core(A, ModelSelected, Points, (int)M, ModelParameters_PATH, 1, 1.0f);
+    
+    mxFree(ModelParameters_PATH);
+}
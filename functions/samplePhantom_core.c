@@ -0,0 +1,345 @@
+/*
+ * Copyright 2017 Daniil Kazantsev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "samplePhantom_core.h"
+#include "utils.h"
+
+#define M_PI 3.14159265358979323846
+
+/* Function to evaluate 2D and 3D models (Phantom2DLibrary.dat, Phantom3DLibrary.dat) at arbitrary points
+ *
+ * The values are the ones of buildPhantom2D_core_single and buildPhantom3D_core_single: the point (x, y[, z])
+ * in the [-1 1] coordinates of the phantom corresponds to the pixel A[i*N + j] (voxel A[(k*N + i)*N + j])
+ * at x = -1 + i*2/N, y = -1 + j*2/N (z = -1 + k*2/N), so e.g. mesh nodes, oblique slices or off-grid samples
+ * are evaluated exactly, with the memory of the output only.
+ *
+ * The points are processed in chunks of SAMPLE_CHUNK (in parallel over the chunks), every object is applied
+ * to the whole chunk at once with the object type selected outside of the loops over the points.
+ *
+ * Input Parameters:
+ * 1. Points - M x 2 (x, y) or M x 3 (x, y, z) coordinates
+ * 2. Params - Components x 7 (2D) or Components x 11 (3D) object parameters in the order of
+ *    read_model2D / read_model3D (Object, C0, x0, y0, ...)
+ * 3. Overwrite - 1: the values are written into A, 0: added to A; Weight scales all objects
+ *
+ * Output:
+ * 1. A - M values
+ */
+
+#define SAMPLE_CHUNK 256
+
+/* an object prepared for the sampling */
+typedef struct {
+    int Object;
+    float C0, x0, y0, z0;
+    float a2, b2, c2;  /* 1/a^2, 1/b^2, 1/c^2 (the half widths for the rectangle and the box) */
+    float c;           /* the half height of the cylinder */
+    float cs, sn;      /* the in-plane rotation */
+    float R[9];        /* the rotation of the 3D objects 1-4 */
+} sampleObject;
+
+static int sampleObject2D_init(sampleObject *O, const float *Q, float Weight)
+{
+    float phi = Q[6]*((float)M_PI/180.0f);
+    O->Object = (int)Q[0];
+    O->C0 = Weight*Q[1];
+    O->x0 = Q[2];
+    O->y0 = Q[3];
+    O->a2 = 1.0f/(Q[4]*Q[4]);
+    O->b2 = 1.0f/(Q[5]*Q[5]);
+    O->cs = cosf(phi);
+    O->sn = sinf(phi);
+    if (O->Object == 4) {
+        /* the parabola of Lambda = 1 */
+        O->a2 *= 4.0f;
+        O->b2 *= 4.0f;
+    }
+    else if (O->Object == 6) {
+        /* the rectangle is centred at (2*x0, 2*y0) */
+        O->x0 = 2.0f*Q[2];
+        O->y0 = 2.0f*Q[3];
+        O->a2 = 0.5f*Q[4];
+        O->b2 = 0.5f*Q[5];
+    }
+    else if ((O->Object < 1) || (O->Object > 6)) {
+        printf("%s\n", "No such object exist!");
+        return 1;
+    }
+    return 0;
+}
+
+static int sampleObject3D_init(sampleObject *O, const float *Q, float Weight)
+{
+    float phi = Q[8]*((float)M_PI/180.0f);
+    O->Object = (int)Q[0];
+    O->C0 = Weight*Q[1];
+    O->x0 = Q[2];
+    O->y0 = Q[3];
+    O->z0 = Q[4];
+    O->a2 = 1.0f/(Q[5]*Q[5]);
+    O->b2 = 1.0f/(Q[6]*Q[6]);
+    O->c2 = 1.0f/(Q[7]*Q[7]);
+    O->c = Q[7];
+    O->cs = cosf(phi);
+    O->sn = sinf(phi);
+    if ((O->Object >= 1) && (O->Object <= 4)) su3(O->R, phi, Q[9]*((float)M_PI/180.0f), Q[10]*((float)M_PI/180.0f));
+    else if (O->Object == 5) {
+        /* the box is centred at (2*x0, 2*y0, z0) */
+        O->x0 = 2.0f*Q[2];
+        O->y0 = 2.0f*Q[3];
+        O->a2 = 0.5f*Q[5];
+        O->b2 = 0.5f*Q[6];
+        O->c2 = 0.5f*Q[7];
+    }
+    else if (O->Object != 6) {
+        printf("%s\n", "No such object exist!");
+        return 1;
+    }
+    return 0;
+}
+
+/* the ellipse based objects: T = (u/a)^2 + (v/b)^2 [+ (w/c)^2] */
+static float sample_profile(int Object, float C0, float T)
+{
+    if (Object == 1) return C0*expf(-4.0f*logf(2.0f)*T);
+    if (T > 1.0f) return 0.0f;
+    if (Object == 2) return C0*sqrtf(1.0f - T);
+    if (Object == 3) return C0;
+    /* the cone */
+    return C0*(1.0f - sqrtf(T));
+}
+
+static void sample2D_batch(const sampleObject *O, int n, const float *x, const float *y, float *acc)
+{
+    float dx, dy, u, v, T;
+    int r;
+
+    if (O->Object == 6) {
+        for(r=0; r<n; r++) {
+            dx = x[r] - O->x0;
+            dy = y[r] - O->y0;
+            u = fabsf(dx*O->cs + dy*O->sn);
+            v = fabsf(dy*O->cs - dx*O->sn);
+            acc[r] += ((u <= O->a2) && (v <= O->b2)) ? O->C0 : 0.0f;
+        }
+    }
+    else {
+        /* the 2D objects numbered as the profiles (the parabola of Lambda = 1 has the halved axes) */
+        int Object = (O->Object == 4) ? 2 : ((O->Object == 5) ? 4 : O->Object);
+        for(r=0; r<n; r++) {
+            dx = x[r] - O->x0;
+            dy = y[r] - O->y0;
+            u = dx*O->cs + dy*O->sn;
+            v = -dx*O->sn + dy*O->cs;
+            T = O->a2*u*u + O->b2*v*v;
+            acc[r] += sample_profile(Object, O->C0, T);
+        }
+    }
+}
+
+static void sample3D_batch(const sampleObject *O, int n, const float *x, const float *y, const float *z, float *acc)
+{
+    float dx, dy, dz, u, v, w, T;
+    int r;
+
+    if (O->Object == 5) {
+        for(r=0; r<n; r++) {
+            dx = x[r] - O->x0;
+            dy = y[r] - O->y0;
+            dz = z[r] - O->z0;
+            u = fabsf(dx*O->cs + dy*O->sn);
+            v = fabsf(dy*O->cs - dx*O->sn);
+            acc[r] += ((fabsf(dz) < O->c2) && (u <= O->a2) && (v <= O->b2)) ? O->C0 : 0.0f;
+        }
+    }
+    else if (O->Object == 6) {
+        for(r=0; r<n; r++) {
+            dx = x[r] - O->x0;
+            dy = y[r] - O->y0;
+            dz = z[r] - O->z0;
+            u = dx*O->cs + dy*O->sn;
+            v = -dx*O->sn + dy*O->cs;
+            T = O->a2*u*u + O->b2*v*v;
+            acc[r] += ((fabsf(dz) < O->c) && (T <= 1.0f)) ? O->C0 : 0.0f;
+        }
+    }
+    else {
+        for(r=0; r<n; r++) {
+            dx = x[r] - O->x0;
+            dy = y[r] - O->y0;
+            dz = z[r] - O->z0;
+            u = O->R[0]*dx + O->R[1]*dy + O->R[2]*dz;
+            v = O->R[3]*dx + O->R[4]*dy + O->R[5]*dz;
+            w = O->R[6]*dx + O->R[7]*dy + O->R[8]*dz;
+            T = O->a2*u*u + O->b2*v*v + O->c2*w*w;
+            acc[r] += sample_profile(O->Object, O->C0, T);
+        }
+    }
+}
+
+float samplePhantom2D_core_params(float *A, const float *Points, int M, const float *Params, int Components, int Overwrite, float Weight)
+{
+    int ch, ii, Chunks, Objects = 0;
+    sampleObject *O;
+
+    if (M <= 0) return 0;
+    O = (sampleObject*) malloc((Components > 0 ? Components : 1)*sizeof(sampleObject));
+    for(ii=0; ii<Components; ii++) {
+        const float *Q = &Params[(size_t)ii*7];
+        if (parameters_check2D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6]) != 0) {
+            printf("\nFunction prematurely terminated, not all objects included");
+            continue;
+        }
+        if (sampleObject2D_init(&O[Objects], Q, Weight) == 0) Objects++;
+    }
+    Chunks = (M + SAMPLE_CHUNK - 1)/SAMPLE_CHUNK;
+
+#pragma omp parallel for shared(A,O) private(ch,ii)
+    for(ch=0; ch<Chunks; ch++) {
+        float x[SAMPLE_CHUNK], y[SAMPLE_CHUNK], acc[SAMPLE_CHUNK];
+        int r, n, First = ch*SAMPLE_CHUNK;
+        n = (M - First < SAMPLE_CHUNK) ? M - First : SAMPLE_CHUNK;
+
+        /* the chunk of points (structure of arrays) */
+        for(r=0; r<n; r++) {
+            x[r] = Points[(size_t)(First + r)*2];
+            y[r] = Points[(size_t)(First + r)*2 + 1];
+            acc[r] = 0.0f;
+        }
+        for(ii=0; ii<Objects; ii++) sample2D_batch(&O[ii], n, x, y, acc);
+        for(r=0; r<n; r++) A[(size_t)First + r] = (Overwrite ? 0.0f : A[(size_t)First + r]) + acc[r];
+    }
+    free(O);
+    return *A;
+}
+
+/* the valid objects of Params (Components x 11), *Objects of them */
+static sampleObject *sample3D_objects(const float *Params, int Components, float Weight, int *Objects)
+{
+    int ii;
+    sampleObject *O = (sampleObject*) malloc((Components > 0 ? Components : 1)*sizeof(sampleObject));
+    *Objects = 0;
+    for(ii=0; ii<Components; ii++) {
+        const float *Q = &Params[(size_t)ii*11];
+        if (parameters_check3D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7]) != 0) {
+            printf("\nFunction prematurely terminated, not all objects included");
+            continue;
+        }
+        if (sampleObject3D_init(&O[*Objects], Q, Weight) == 0) (*Objects)++;
+    }
+    return O;
+}
+
+float samplePhantom3D_core_params(float *A, const float *Points, int M, const float *Params, int Components, int Overwrite, float Weight)
+{
+    int ch, ii, Chunks, Objects;
+    sampleObject *O;
+
+    if (M <= 0) return 0;
+    O = sample3D_objects(Params, Components, Weight, &Objects);
+    Chunks = (M + SAMPLE_CHUNK - 1)/SAMPLE_CHUNK;
+
+#pragma omp parallel for shared(A,O) private(ch,ii)
+    for(ch=0; ch<Chunks; ch++) {
+        float x[SAMPLE_CHUNK], y[SAMPLE_CHUNK], z[SAMPLE_CHUNK], acc[SAMPLE_CHUNK];
+        int r, n, First = ch*SAMPLE_CHUNK;
+        n = (M - First < SAMPLE_CHUNK) ? M - First : SAMPLE_CHUNK;
+
+        /* the chunk of points (structure of arrays) */
+        for(r=0; r<n; r++) {
+            x[r] = Points[(size_t)(First + r)*3];
+            y[r] = Points[(size_t)(First + r)*3 + 1];
+            z[r] = Points[(size_t)(First + r)*3 + 2];
+            acc[r] = 0.0f;
+        }
+        for(ii=0; ii<Objects; ii++) sample3D_batch(&O[ii], n, x, y, z, acc);
+        for(r=0; r<n; r++) A[(size_t)First + r] = (Overwrite ? 0.0f : A[(size_t)First + r]) + acc[r];
+    }
+    free(O);
+    return *A;
+}
+
+/* Function to render an arbitrary (oblique) plane of a 3D model, no volume is built
+ *
+ * Input Parameters:
+ * 1. Origin - the centre of the slice, U, V - the in-plane half axes, all in the [-1 1] coordinates
+ * 2. NU, NV - the slice size in pixels, the pixel A[i*NV + j] is at Origin + (-1 + 2*i/NU)*U + (-1 + 2*j/NV)*V,
+ *    i.e. Origin = (0, 0, z), U = (1, 0, 0), V = (0, 1, 0), NU = NV = N give the slice of buildPhantom3D_core at z
+ * 3. Params, Components, Overwrite, Weight - as in samplePhantom3D_core_params
+ *
+ * Output:
+ * 1. A - the slice size of [NU x NV]
+ */
+float samplePlane3D_core_params(float *A, const float *Origin, const float *U, const float *V, int NU, int NV, const float *Params, int Components, int Overwrite, float Weight)
+{
+    int ch, ii, Chunks, Objects;
+    float HU, HV;
+    sampleObject *O;
+
+    if ((NU <= 0) || (NV <= 0)) return 0;
+    O = sample3D_objects(Params, Components, Weight, &Objects);
+    HU = 2.0f/(float)NU;
+    HV = 2.0f/(float)NV;
+    /* a chunk is a part of a row of the slice */
+    Chunks = (NV + SAMPLE_CHUNK - 1)/SAMPLE_CHUNK;
+
+#pragma omp parallel for shared(A,O) private(ch,ii)
+    for(ch=0; ch<NU*Chunks; ch++) {
+        float x[SAMPLE_CHUNK], y[SAMPLE_CHUNK], z[SAMPLE_CHUNK], acc[SAMPLE_CHUNK], su, sv;
+        int r, n, i = ch/Chunks, First = (ch - i*Chunks)*SAMPLE_CHUNK;
+        size_t Offset = (size_t)i*NV + First;
+        n = (NV - First < SAMPLE_CHUNK) ? NV - First : SAMPLE_CHUNK;
+
+        su = -1.0f + (float)i*HU;
+        for(r=0; r<n; r++) {
+            sv = -1.0f + (float)(First + r)*HV;
+            x[r] = Origin[0] + su*U[0] + sv*V[0];
+            y[r] = Origin[1] + su*U[1] + sv*V[1];
+            z[r] = Origin[2] + su*U[2] + sv*V[2];
+            acc[r] = 0.0f;
+        }
+        for(ii=0; ii<Objects; ii++) sample3D_batch(&O[ii], n, x, y, z, acc);
+        for(r=0; r<n; r++) A[Offset + r] = (Overwrite ? 0.0f : A[Offset + r]) + acc[r];
+    }
+    free(O);
+    return *A;
+}
+
+/* the same for a model of Phantom2DLibrary.dat / Phantom3DLibrary.dat */
+float samplePhantom2D_core(float *A, int ModelSelected, const float *Points, int M, char *ModelParametersFilename, int Overwrite, float Weight)
+{
+    int Components = 0;
+    float *Params = read_model2D(ModelSelected, ModelParametersFilename, &Components);
+    samplePhantom2D_core_params(A, Points, M, Params, Components, Overwrite, Weight);
+    free(Params);
+    return (M > 0) ? *A : 0;
+}
+
+float samplePhantom3D_core(float *A, int ModelSelected, const float *Points, int M, char *ModelParametersFilename, int Overwrite, float Weight)
+{
+    int Components = 0;
+    float *Params = read_model3D(ModelSelected, ModelParametersFilename, &Components);
+    samplePhantom3D_core_params(A, Points, M, Params, Components, Overwrite, Weight);
+    free(Params);
+    return (M > 0) ? *A : 0;
+}
+
+float samplePlane3D_core(float *A, int ModelSelected, const float *Origin, const float *U, const float *V, int NU, int NV, char *ModelParametersFilename, int Overwrite, float Weight)
+{
+    int Components = 0;
+    float *Params = read_model3D(ModelSelected, ModelParametersFilename, &Components);
+    samplePlane3D_core_params(A, Origin, U, V, NU, NV, Params, Components, Overwrite, Weight);
+    free(Params);
+    return ((NU > 0) && (NV > 0)) ? *A : 0;
+}
@@ -0,0 +1,36 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SAMPLEPHANTOM_CORE_H
+#define SAMPLEPHANTOM_CORE_H
+
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+float samplePhantom2D_core_params(float *A, const float *Points, int M, const float *Params, int Components, int Overwrite, float Weight);
+float samplePhantom3D_core_params(float *A, const float *Points, int M, const float *Params, int Components, int Overwrite, float Weight);
+float samplePhantom2D_core(float *A, int ModelSelected, const float *Points, int M, char *ModelParametersFilename, int Overwrite, float Weight);
+float samplePhantom3D_core(float *A, int ModelSelected, const float *Points, int M, char *ModelParametersFilename, int Overwrite, float Weight);
+float samplePlane3D_core_params(float *A, const float *Origin, const float *U, const float *V, int NU, int NV, const float *Params, int Components, int Overwrite, float Weight);
+float samplePlane3D_core(float *A, int ModelSelected, const float *Origin, const float *U, const float *V, int NU, int NV, char *ModelParametersFilename, int Overwrite, float Weight);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,74 @@
+/*
+Copyright 2017 Daniil Kazantsev
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mex.h"
+#include <math.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <stdio.h>
+#include "omp.h"
+
+#include "samplePhantom_core.h"
+
+/* Function to render an arbitrary (oblique) plane of a 3D model without building the volume (MATLAB wrapper)
+ *
+ * Input Parameters:
+ * 1. Model number (see Phantom3DLibrary.dat) [required]
+ * 2. Origin - the centre of the slice [x y z] in the [-1 1] coordinates [required]
+ * 3. U, V - the in-plane half axes [x y z] of the slice [required]
+ * 4. Slice size [NU NV] (in pixels) [required]
+ * 5. An absolute path to the file Phantom3DLibrary.dat (see OS-specific syntax-differences) [required]
+ *
+ * Output:
+ * 1. The slice size of [NV, NU], the pixel S(j, i) is at Origin + (-1 + 2*(i-1)/NU)*U + (-1 + 2*(j-1)/NV)*V
+ *    (Origin = [0 0 z], U = [1 0 0], V = [0 1 0], NU = NV = N give the slices of buildPhantom3D)
+ */
+
+void mexFunction(
+        int nlhs, mxArray *plhs[],
+        int nrhs, const mxArray *prhs[])
+        
+{
+    int ModelSelected, NU, NV, ii;
+    float *A, Origin[3], U[3], V[3];
+    double *Dims;
+    char *ModelParameters_PATH;
+    
+    /*Handling Matlab input data*/
+    if (nrhs != 6) mexErrMsgTxt("Input of 6 parameters is required: Model, Origin, U, V, Slice size [NU NV], PATH");
+    for(ii=1; ii<4; ii++) {
+        if ((mxGetClassID(prhs[ii]) != mxDOUBLE_CLASS) || (mxGetNumberOfElements(prhs[ii]) != 3)) {mexErrMsgTxt("Origin, U and V must be given as [x y z]"); }
+    }
+    if ((mxGetClassID(prhs[4]) != mxDOUBLE_CLASS) || (mxGetNumberOfElements(prhs[4]) != 2)) {mexErrMsgTxt("The slice size must be given as [NU NV]"); }
+    
+    ModelSelected  = (int) mxGetScalar(prhs[0]); /* selected model */
+    for(ii=0; ii<3; ii++) {
+        Origin[ii] = (float) mxGetPr(prhs[1])[ii];
+        U[ii] = (float) mxGetPr(prhs[2])[ii];
+        V[ii] = (float) mxGetPr(prhs[3])[ii];
+    }
+    Dims = mxGetPr(prhs[4]); /* slice size */
+    NU = (int) Dims[0];
+    NV = (int) Dims[1];
+    ModelParameters_PATH = mxArrayToString(prhs[5]); /* provide an absolute path to the file */
+    
+    /*Handling Matlab output data*/
+    mwSize N_dims[] = {NV, NU};
+    A = (float*)mxGetPr(plhs[0] = mxCreateUninitNumericArray(2, N_dims, mxSINGLE_CLASS, mxREAL));
+    
+    /* the output is not initialised, the first object overwrites it */
+    samplePlane3D_core(A, ModelSelected, Origin, U, V, NU, NV, ModelParameters_PATH, 1, 1.0f);
+    
+    mxFree(ModelParameters_PATH);
+}
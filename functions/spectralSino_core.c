@@ -0,0 +1,100 @@
+/*
+ * Copyright 2017 Daniil Kazantsev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "spectralSino_core.h"
+#include "utils.h"
+#include "fastMath.h"
+
+/* Function to form the sinograms of energy bins from the basis sinograms of materials (see
+ * buildSino2D_core_materials and buildSino3D_core_materials), so that the objects are projected once per
+ * material and not once per energy
+ *
+ * Input Parameters:
+ * 1. Basis - NumMaterials basis sinograms of Rows x Cols values each (any layout, e.g. AngTot x P in 2D)
+ * 2. Mu - the attenuation of the materials at the energies, NumEnergies x NumMaterials values
+ *    (Mu[e*NumMaterials + m] scales the basis sinogram of the material m + 1)
+ * 3. Weights - NULL: the output holds the NumEnergies linear combinations sum_m Mu[e, m]*Basis[m] (NumBins is
+ *    NumEnergies), otherwise the NumBins x NumEnergies spectra of the bins (the source spectrum times the detector
+ *    response): the output of the bin b is the polychromatic Beer-Lambert sinogram
+ *    -log(sum_e Weights[b, e]*exp(-sum_m Mu[e, m]*Basis[m]) / sum_e Weights[b, e])
+ * 4. Fast - 1: exp and log of the polychromatic integration are the approximations of fastMath.h, 0 - expf
+ *    and logf of the C library
+ *
+ * Output:
+ * 1. A - NumBins sinograms of Rows x Cols values
+ */
+
+float spectralSino_core(float *A, const float *Basis, int NumMaterials, int Rows, int Cols, const float *Mu, int NumEnergies, const float *Weights, int NumBins, int Fast)
+{
+    int r, j, m, e, b;
+    size_t n = (size_t)Rows*Cols;
+    float *Norm, *T, *Acc, S;
+    
+    if (Weights == NULL) {
+        /* the linear combinations of the basis sinograms */
+#pragma omp parallel for shared(A) private(r,j,m,e,T)
+        for(r=0; r<Rows; r++) {
+            for(e=0; e<NumEnergies; e++) {
+                T = &A[(size_t)e*n + (size_t)r*Cols];
+                for(j=0; j<Cols; j++) T[j] = 0.0f;
+                for(m=0; m<NumMaterials; m++) {
+                    for(j=0; j<Cols; j++) T[j] += Mu[(size_t)e*NumMaterials + m]*Basis[(size_t)m*n + (size_t)r*Cols + j];
+                }
+            }
+        }
+        return *A;
+    }
+    
+    /* the normalisation of the spectra of the bins */
+    Norm = malloc(NumBins*sizeof(float));
+    for(b=0; b<NumBins; b++) {
+        S = 0.0f;
+        for(e=0; e<NumEnergies; e++) S += Weights[(size_t)b*NumEnergies + e];
+        if (S <= 0.0f) printf("%s %i\n", "The spectrum of the energy bin is zero, bin", b);
+        Norm[b] = 1.0f/S;
+    }
+    
+#pragma omp parallel private(r,j,m,e,b,T,Acc)
+    {
+        /* the line integrals of an energy and the transmissions of the bins for one row */
+        T = malloc(Cols*sizeof(float));
+        Acc = malloc((size_t)NumBins*Cols*sizeof(float));
+#pragma omp for
+        for(r=0; r<Rows; r++) {
+            memset(Acc, 0, (size_t)NumBins*Cols*sizeof(float));
+            for(e=0; e<NumEnergies; e++) {
+                for(j=0; j<Cols; j++) T[j] = 0.0f;
+                for(m=0; m<NumMaterials; m++) {
+                    for(j=0; j<Cols; j++) T[j] += Mu[(size_t)e*NumMaterials + m]*Basis[(size_t)m*n + (size_t)r*Cols + j];
+                }
+                if (Fast) {
+#pragma omp simd
+                    for(j=0; j<Cols; j++) T[j] = fast_expf(fminf(-T[j], 88.0f));
+                }
+                else {
+                    for(j=0; j<Cols; j++) T[j] = expf(-T[j]);
+                }
+                for(b=0; b<NumBins; b++) {
+                    for(j=0; j<Cols; j++) Acc[(size_t)b*Cols + j] += Weights[(size_t)b*NumEnergies + e]*T[j];
+                }
+            }
+            for(b=0; b<NumBins; b++) {
+                for(j=0; j<Cols; j++) A[(size_t)b*n + (size_t)r*Cols + j] = -logf(Acc[(size_t)b*Cols + j]*Norm[b]);
+            }
+        }
+        free(T); free(Acc);
+    }
+    free(Norm);
+    return *A;
+}
@@ -17,6 +17,8 @@
 #include <stdlib.h>
 #include <memory.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
 
 float parameters_check2D(float C0, float x0, float y0, float a, float b, float phi_rot)
 {
@@ -104,3 +106,350 @@ float mmtvc(float *A, float *V1, float *V2)
     return *V2;
 }
 
+/* Reads the components of the selected model from the library file (Phantom2DLibrary.dat or
+ * Phantom3DLibrary.dat) into a newly allocated array, one row per component:
+ * 2D (7 values): Object, C0, x0, y0, a, b, phi_rot
+ * 3D (11 values): Object, C0, x0, y0, z0, a, b, c, psi1, psi2, psi3
+ * Missing trailing values are set to zero. The function keeps no state between calls, so it can be
+ * used concurrently from several threads. Returns NULL and sets Components to 0 if the file or the model
+ * cannot be read or the arrays cannot be allocated, otherwise the caller must free the array.
+ * If Materials is not NULL, it receives a newly allocated array with the material of every component,
+ * given after the values as "Object : ...; Material : m;" (-1 if the material is not given).
+ */
+static float *read_model(int ModelSelected, char *ModelParametersFilename, int Stride, int *Components, int **Materials)
+{
+    FILE *in_file;
+    char tempbuff[256], tmpstr1[16], tmpstr2[16];
+    char *pos, *end;
+    float *Params = NULL, swap;
+    long Count;
+    int ii, jj, Model, found = 0;
+    
+    *Components = 0;
+    if (Materials != NULL) *Materials = NULL;
+    in_file = fopen(ModelParametersFilename, "r");
+    if (! in_file) {
+        printf("%s %s\n", "Parameters file does not exist or cannot be read!", ModelParametersFilename);
+        return NULL;
+    }
+    while (fgets(tempbuff,256,in_file)) {
+        if (tempbuff[0] == '#') continue;
+        if (sscanf(tempbuff, "%15s : %15[^;];", tmpstr1, tmpstr2) != 2) continue;
+        if (strcmp(tmpstr1,"Model") != 0) continue;
+        Model = atoi(tmpstr2);
+        if (Model != ModelSelected) continue;
+        found = 1;
+        
+        /* the selected model is found, the next line gives the number of components */
+        while (fgets(tempbuff,256,in_file) && (tempbuff[0] == '#'));
+        if ((sscanf(tempbuff, "%15s : %15[^;];", tmpstr1, tmpstr2) != 2) || (strcmp(tmpstr1,"Components") != 0)) {
+            printf("%s\n", "The number of components is unknown!");
+            break;
+        }
+        Count = strtol(tmpstr2, &end, 10);
+        if ((end == tmpstr2) || (*end != '\0') || (Count <= 0) || (Count > INT_MAX/Stride)) {
+            printf("%s %s\n", "The number of components is not a positive integer:", tmpstr2);
+            break;
+        }
+        Params = calloc((size_t)Count*Stride, sizeof(float));
+        if ((Params != NULL) && (Materials != NULL)) *Materials = malloc((size_t)Count*sizeof(int));
+        if ((Params == NULL) || ((Materials != NULL) && (*Materials == NULL))) {
+            printf("%s %li\n", "Not enough memory for the components of the model:", Count);
+            break;
+        }
+        *Components = (int)Count;
+        
+        for(ii=0; ii<*Components; ii++) {
+            if (!fgets(tempbuff,256,in_file) || (sscanf(tempbuff, "%15s", tmpstr1) != 1) || (strcmp(tmpstr1,"Object") != 0) || (strchr(tempbuff, ':') == NULL)) {
+                printf("%s\n", "Not all components of the model have been found!");
+                *Components = ii;
+                break;
+            }
+            pos = strchr(tempbuff, ':') + 1;
+            if (Materials != NULL) {
+                end = strchr(pos, ';');
+                if ((end == NULL) || (sscanf(end + 1, " Material : %d", &(*Materials)[ii]) != 1)) (*Materials)[ii] = -1;
+                else if (((*Materials)[ii] < 0) || ((*Materials)[ii] > 255)) {
+                    printf("%s\n", "The materials must be in the range [0, 255], the material is ignored!");
+                    (*Materials)[ii] = -1;
+                }
+            }
+            for(jj=0; jj<Stride; jj++) {
+                Params[ii*Stride + jj] = strtof(pos, &end);
+                if ((end == pos) || (*end == ';')) break;
+                pos = end;
+            }
+            /* the first position in the file is y0, the second is x0 */
+            swap = Params[ii*Stride + 2];
+            Params[ii*Stride + 2] = Params[ii*Stride + 3];
+            Params[ii*Stride + 3] = swap;
+        }
+        break;
+    }
+    fclose(in_file);
+    if (*Components == 0) {
+        if (!found) printf("%s %i\n", "The model cannot be found in the parameters file, model", ModelSelected);
+        free(Params);
+        if (Materials != NULL) {free(*Materials); *Materials = NULL;}
+        return NULL;
+    }
+    return Params;
+}
+
+float *read_model2D(int ModelSelected, char *ModelParametersFilename, int *Components)
+{
+    return read_model(ModelSelected, ModelParametersFilename, 7, Components, NULL);
+}
+
+float *read_model3D(int ModelSelected, char *ModelParametersFilename, int *Components)
+{
+    return read_model(ModelSelected, ModelParametersFilename, 11, Components, NULL);
+}
+
+/* the same as read_model2D and read_model3D, Materials receives the materials of the components
+ * (see read_model), the caller must free both arrays */
+float *read_model2D_materials(int ModelSelected, char *ModelParametersFilename, int *Components, int **Materials)
+{
+    return read_model(ModelSelected, ModelParametersFilename, 7, Components, Materials);
+}
+
+float *read_model3D_materials(int ModelSelected, char *ModelParametersFilename, int *Components, int **Materials)
+{
+    return read_model(ModelSelected, ModelParametersFilename, 11, Components, Materials);
+}
+
+/* returns the largest material of the components (0 if no material is given) */
+int max_material(const int *Materials, int Components)
+{
+    int ii, m = 0;
+    for(ii=0; ii<Components; ii++) if (Materials[ii] > m) m = Materials[ii];
+    return m;
+}
+
+/* Stores the value V of an object of the given Material at the position n of the material outputs:
+ * the label map L (if not NULL) takes the Material where the voxel is Inside the object (the last object
+ * covering a voxel gives its label, objects without a material do not change L), and V is added to the
+ * map of the material among the NumMaterials maps of M (NULL for no maps, the maps are Stride values apart).
+ * With Overwrite (the first object of a model) the previous content of L and of all maps is ignored, so
+ * the outputs are initialised in the pass of the first object instead of being zeroed beforehand. */
+void store_material(unsigned char *L, float *M, int NumMaterials, size_t Stride, size_t n, float V, int Inside, int Material, int Overwrite)
+{
+    int m;
+    if (L != NULL) {
+        if (Inside && (Material >= 0)) L[n] = (unsigned char)Material;
+        else if (Overwrite) L[n] = 0;
+    }
+    if (M != NULL) {
+        if (Overwrite) for(m=0; m<NumMaterials; m++) M[(size_t)m*Stride + n] = 0.0f;
+        if ((Material >= 1) && (Material <= NumMaterials)) M[(size_t)(Material-1)*Stride + n] += V;
+    }
+}
+
+/* zeroes the Count values from the position n of L and of the NumMaterials maps of M (see store_material),
+ * for the parts of the outputs which the first object of a model does not visit */
+void clear_materials(unsigned char *L, float *M, int NumMaterials, size_t Stride, size_t n, size_t Count)
+{
+    int m;
+    if (L != NULL) memset(&L[n], 0, Count);
+    if (M != NULL) for(m=0; m<NumMaterials; m++) memset(&M[(size_t)m*Stride + n], 0, Count*sizeof(float));
+}
+
+/* removes the objects with unreasonable parameters (see parameters_check3D) from Params of read_model3D,
+ * returns the number of the remaining objects (the functions which build a model in parts check it once) */
+int check_model3D(float *Params, int Components)
+{
+    int ii, n = 0;
+    for(ii=0; ii<Components; ii++) {
+        float *Q = &Params[ii*11];
+        if (parameters_check3D(Q[1], Q[2], Q[3], Q[4], Q[5], Q[6], Q[7]) == 0) {
+            if (n != ii) memmove(&Params[n*11], Q, 11*sizeof(float));
+            n++;
+        }
+        else printf("\nFunction prematurely terminated, not all objects included");
+    }
+    return n;
+}
+
+/* two angles are related by 180 degrees if they differ by 180 (mod 360) within this tolerance (in degrees) */
+#define MIRROR_TOL 1.0e-4
+
+typedef struct {
+    double r; /* the angle in [0, 360) */
+    int i;
+} sortedAngle;
+
+static int compare_angles(const void *a, const void *b)
+{
+    double d = ((const sortedAngle*)a)->r - ((const sortedAngle*)b)->r;
+    return (d > 0.0) - (d < 0.0);
+}
+
+/* Function to find the projection angles of [Ang1, Ang2) related by 180 degrees: in the parallel beam geometry the
+ * projection at Th + 180 is the projection at Th mirrored on the detector (j -> P-1-j), the centring shift of the
+ * sinograms moves the objects, not the detector, so the mirroring is exact
+ *
+ * Output (the indices are relative to Ang1):
+ * 1. The number NBase of the angles to compute, Base[0, NBase) - their indices in the increasing order
+ * 2. Mirror[i] - for a computed angle i the first angle mirrored from it, for a mirrored angle the next one mirrored
+ *    from the same computed angle, -1 if none (no pairs: NBase = Ang2 - Ang1 and all Mirror are -1)
+ */
+int sino_mirrors(const float *Th, int Ang1, int Ang2, int *Base, int *Mirror)
+{
+    int i, n, lo, hi, NA = Ang2 - Ang1, NBase = 0;
+    double t;
+    sortedAngle *S;
+
+    for(i=0; i<NA; i++) Mirror[i] = -1;
+    S = (sortedAngle*) malloc((NA > 0 ? NA : 1)*sizeof(sortedAngle));
+    for(i=0; i<NA; i++) {
+        S[i].r = fmod((double)Th[Ang1 + i], 360.0);
+        if (S[i].r < 0.0) S[i].r += 360.0;
+        S[i].i = i;
+    }
+    qsort(S, NA, sizeof(sortedAngle), compare_angles);
+
+    /* every angle in [180, 360) is looked up in [0, 180) */
+    for(n=0; n<NA; n++) {
+        int Found = -1;
+        if (S[n].r < 180.0) continue;
+        t = S[n].r - 180.0;
+        lo = 0; hi = n;
+        while (lo < hi) {
+            int mid = (lo + hi)/2;
+            if (S[mid].r < t) lo = mid + 1;
+            else hi = mid;
+        }
+        /* the nearest angles below and above t */
+        if ((lo < n) && (S[lo].r < 180.0) && (S[lo].r - t <= MIRROR_TOL)) Found = S[lo].i;
+        else if ((lo > 0) && (t - S[lo-1].r <= MIRROR_TOL)) Found = S[lo-1].i;
+        if (Found >= 0) {
+            /* the mirrored angle is written by the computed one */
+            Mirror[S[n].i] = Mirror[Found];
+            Mirror[Found] = S[n].i;
+            S[n].i = -1 - S[n].i;
+        }
+    }
+    /* the computed angles: all but the mirrored ones */
+    for(i=0; i<NA; i++) Base[i] = 1;
+    for(n=0; n<NA; n++) if (S[n].i < 0) Base[-1 - S[n].i] = 0;
+    for(i=0; i<NA; i++) if (Base[i]) Base[NBase++] = i;
+    free(S);
+    return NBase;
+}
+
+/* writes the value V of the projection i at the detector j into A (Offset is the start of the slice) and the
+ * mirrored value into the projections mirrored from i (see sino_mirrors) */
+void sino_write(float *A, size_t Offset, int i, int j, int P, const int *Mirror, float V, int Overwrite)
+{
+    int m;
+    size_t Index = Offset + (size_t)i*P + j;
+    A[Index] = (Overwrite ? 0.0f : A[Index]) + V;
+    for(m=Mirror[i]; m>=0; m=Mirror[m]) {
+        Index = Offset + (size_t)m*P + (P-1-j);
+        A[Index] = (Overwrite ? 0.0f : A[Index]) + V;
+    }
+}
+
+/* the range [j1, j2) of the detectors Pmax - j*H_p (j = 0..P-1) which can be within R from p0, the range
+ * is widened by a detector at both ends (all P detectors are taken if the window is undefined) */
+void sino_window(float p0, float R, float Pmax, float H_p, int P, int *j1, int *j2)
+{
+    float t1, t2;
+    t1 = (Pmax - p0 - R)/H_p;
+    t2 = (Pmax - p0 + R)/H_p;
+    if (isnan(t1) || isnan(t2)) {*j1 = 0; *j2 = P; return;}
+    *j1 = (t1 <= 1.0f) ? 0 : ((t1 >= (float)P) ? P : (int)t1 - 1);
+    *j2 = (t2 < 0.0f) ? 0 : ((t2 >= (float)(P-2)) ? P : (int)t2 + 2);
+    if (*j2 < *j1) *j2 = *j1;
+}
+
+/* zeroes the projection i outside of the detectors [j1, j2) and the mirrored projections (see sino_write) */
+void sino_clear(float *A, size_t Offset, int i, int j1, int j2, int P, const int *Mirror)
+{
+    int m;
+    float *Row = &A[Offset + (size_t)i*P];
+    memset(Row, 0, (size_t)j1*sizeof(float));
+    memset(Row + j2, 0, (size_t)(P-j2)*sizeof(float));
+    for(m=Mirror[i]; m>=0; m=Mirror[m]) {
+        Row = &A[Offset + (size_t)m*P];
+        memset(Row + (P-j1), 0, (size_t)j1*sizeof(float));
+        memset(Row, 0, (size_t)(P-j2)*sizeof(float));
+    }
+}
+
+/* writes the values V[0], ..., V[j2-j1-1] of the projection i at the detectors j1, ..., j2-1 (see sino_write) */
+void sino_write_row(float *A, size_t Offset, int i, int j1, int j2, int P, const int *Mirror, const float *V, int Overwrite)
+{
+    int j, m;
+    float *Row = &A[Offset + (size_t)i*P];
+    for(j=j1; j<j2; j++) Row[j] = (Overwrite ? 0.0f : Row[j]) + V[j-j1];
+    for(m=Mirror[i]; m>=0; m=Mirror[m]) {
+        Row = &A[Offset + (size_t)m*P];
+        for(j=j1; j<j2; j++) Row[P-1-j] = (Overwrite ? 0.0f : Row[P-1-j]) + V[j-j1];
+    }
+}
+
+/* float32 -> float16 (IEEE half) with rounding to nearest even, overflow to inf, subnormals and NaN kept */
+static unsigned short float_to_half(float V)
+{
+    unsigned int x, sign, mant, half, rem, halfway;
+    int e, shift;
+    memcpy(&x, &V, sizeof(float));
+    sign = (x >> 16) & 0x8000u;
+    mant = x & 0x007fffffu;
+    if (((x >> 23) & 0xff) == 0xff) return (unsigned short)(sign | 0x7c00u | (mant ? 0x0200u : 0u));
+    e = (int)((x >> 23) & 0xff) - 127 + 15;
+    if (e >= 31) return (unsigned short)(sign | 0x7c00u);
+    if (e <= 0) {
+        /* a subnormal half (or zero) */
+        if (e < -10) return (unsigned short)sign;
+        mant |= 0x00800000u;
+        shift = 14 - e;
+        half = mant >> shift;
+        rem = mant & ((1u << shift) - 1u);
+        halfway = 1u << (shift - 1);
+        if ((rem > halfway) || ((rem == halfway) && (half & 1u))) half++;
+        return (unsigned short)(sign | half);
+    }
+    half = ((unsigned int)e << 10) | (mant >> 13);
+    rem = mant & 0x1fffu;
+    /* the carry of the rounding goes into the exponent (up to inf) */
+    if ((rem > 0x1000u) || ((rem == 0x1000u) && (half & 1u))) half++;
+    return (unsigned short)(sign | half);
+}
+
+/* float32 -> bfloat16 (the upper half of float32) with rounding to nearest even, NaN kept */
+static unsigned short float_to_bfloat16(float V)
+{
+    unsigned int x;
+    memcpy(&x, &V, sizeof(float));
+    if (((x >> 23) & 0xff) == 0xff && (x & 0x007fffffu)) return (unsigned short)((x >> 16) | 0x0040u);
+    x += 0x7fffu + ((x >> 16) & 1u);
+    return (unsigned short)(x >> 16);
+}
+
+/* stores n float32 values of Src into Dst of the compact Format: COMPACT_FLOAT16 or COMPACT_BFLOAT16
+ * (Scale and Offset are not used), COMPACT_UINT16: round(Src*Scale + Offset) clipped to [0, 65535]
+ * (NaN is stored as 0) */
+void store_compact(const float *Src, unsigned short *Dst, size_t n, int Format, float Scale, float Offset)
+{
+    size_t i;
+    float T;
+    if (Format == COMPACT_FLOAT16) {
+#pragma omp parallel for shared(Src,Dst) private(i)
+        for(i=0; i<n; i++) Dst[i] = float_to_half(Src[i]);
+    }
+    else if (Format == COMPACT_BFLOAT16) {
+#pragma omp parallel for shared(Src,Dst) private(i)
+        for(i=0; i<n; i++) Dst[i] = float_to_bfloat16(Src[i]);
+    }
+    else {
+#pragma omp parallel for shared(Src,Dst) private(i,T)
+        for(i=0; i<n; i++) {
+            T = Src[i]*Scale + Offset;
+            if (!(T > 0.0f)) T = 0.0f;
+            if (T > 65535.0f) T = 65535.0f;
+            Dst[i] = (unsigned short)(T + 0.5f);
+        }
+    }
+}
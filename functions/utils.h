@@ -12,10 +12,58 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#ifndef UTILS_H
+#define UTILS_H
+
 #include <stdlib.h>
 #include <memory.h>
 #include <stdio.h>
 #include "omp.h"
+
+/* the number of detectors computed at once by the vectorised sinogram loops (see sino_write_row) */
+#define SINO_CHUNK 64
+
+/* the compact output formats (see store_compact) and the size of the float32 slabs (in values)
+ * in which the *_core_compact functions accumulate the objects */
+#define COMPACT_FLOAT16 0
+#define COMPACT_BFLOAT16 1
+#define COMPACT_UINT16 2
+#define COMPACT_SLAB 4194304
+
+/* the helpers below (and the ones of fastMath.h) are forced inline, so that the loops calling them are vectorised */
+#if defined(_MSC_VER)
+#define UTILS_INLINE static __forceinline
+#elif defined(__GNUC__)
+#define UTILS_INLINE static inline __attribute__((always_inline))
+#else
+#define UTILS_INLINE static inline
+#endif
+
+/* the index i clamped to [0, n-1] (integer selects) */
+UTILS_INLINE int clamp_index(int i, int n)
+{
+    i = (i < 0) ? 0 : i;
+    return (i > n-1) ? n-1 : i;
+}
+
+/* the linear interpolation of the samples R[0..n-1] at the position t (in samples), zero outside of them.
+ * The loads are unconditional (the indices are clamped) and the taps outside are zeroed by masks, so that
+ * the loops over the positions are vectorised (gathers); the positions far outside (and NaN) are moved
+ * next to the samples, where both taps are zero. */
+UTILS_INLINE float interp_linear(const float *R, int n, float t)
+{
+    int i1;
+    float u, v1, v2;
+    t = (t > -2.0f) ? t : -2.0f;
+    t = (t < (float)n + 1.0f) ? t : (float)n + 1.0f;
+    i1 = (int)t;
+    i1 = i1 - ((float)i1 > t);
+    u = t - (float)i1;
+    v1 = R[clamp_index(i1, n)]*(float)((i1 >= 0) & (i1 < n));
+    v2 = R[clamp_index(i1+1, n)]*(float)((i1 >= -1) & (i1 < n-1));
+    return (1.0f - u)*v1 + u*v2;
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -23,6 +71,22 @@ float parameters_check2D(float C0, float x0, float y0, float a, float b, float p
 float parameters_check3D(float C0, float x0, float y0, float z0, float a, float b, float c);
 float su3(float *A, float psi1, float psi2, float psi3);
 float mmtvc(float *A, float *V1, float *V2);
+float *read_model2D(int ModelSelected, char *ModelParametersFilename, int *Components);
+float *read_model3D(int ModelSelected, char *ModelParametersFilename, int *Components);
+float *read_model2D_materials(int ModelSelected, char *ModelParametersFilename, int *Components, int **Materials);
+float *read_model3D_materials(int ModelSelected, char *ModelParametersFilename, int *Components, int **Materials);
+int max_material(const int *Materials, int Components);
+void store_material(unsigned char *L, float *M, int NumMaterials, size_t Stride, size_t n, float V, int Inside, int Material, int Overwrite);
+void clear_materials(unsigned char *L, float *M, int NumMaterials, size_t Stride, size_t n, size_t Count);
+int check_model3D(float *Params, int Components);
+void store_compact(const float *Src, unsigned short *Dst, size_t n, int Format, float Scale, float Offset);
+int sino_mirrors(const float *Th, int Ang1, int Ang2, int *Base, int *Mirror);
+void sino_write(float *A, size_t Offset, int i, int j, int P, const int *Mirror, float V, int Overwrite);
+void sino_window(float p0, float R, float Pmax, float H_p, int P, int *j1, int *j2);
+void sino_clear(float *A, size_t Offset, int i, int j1, int j2, int P, const int *Mirror);
+void sino_write_row(float *A, size_t Offset, int i, int j1, int j2, int P, const int *Mirror, const float *V, int Overwrite);
 #ifdef __cplusplus
 }
 #endif
+
+#endif
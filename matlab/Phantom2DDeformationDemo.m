@@ -24,14 +24,42 @@ FocalP = 2.5; % focal point distance
 RFP = 1./FocalP;
 AngleTransform = 15; % angle in degrees
 
-% deform forward
+% deform forward (in single precision, pass double(G) for the double precision)
 DeformType = 0; % 0 - forward deformation
-G_deformed = DeformObject_C(double(G), RFP, AngleTransform, DeformType);
+G_deformed = DeformObject_C(G, RFP, AngleTransform, DeformType);
 % deform back
 DeformType = 1; % 1 - inverse 
-G_inv = DeformObject_C(double(G_deformed), RFP, AngleTransform, DeformType);
+G_inv = DeformObject_C(G_deformed, RFP, AngleTransform, DeformType);
 figure; 
 subplot(1,2,1); imagesc(G_deformed, [0 1]); title('Deformed Phantom'); daspect([1 1 1]); colormap hot
 subplot(1,2,2); imagesc(G_inv, [0 1]); title('Inversely Deformed Phantom'); daspect([1 1 1]); colormap hot
 MSE = norm(G_inv(:) - G(:))./norm(G(:));
 fprintf('%s %f \n', 'Error (NMSE)', MSE);
+% the cubic B-spline interpolation ('cubic' or 'lanczos') keeps small features without supersampling the phantom
+G_inv_cubic = DeformObject_C(DeformObject_C(single(G), RFP, AngleTransform, 0, 'cubic'), RFP, AngleTransform, 1, 'cubic');
+MSE = norm(double(G_inv_cubic(:)) - G(:))./norm(G(:));
+fprintf('%s %f \n', 'Error of the cubic interpolation (NMSE)', MSE);
+
+% non-square images (N x M) have square pixels and the longer side is [-1, 1]: the deformation of a centred crop
+% of an object inside the crop is the crop of the deformation of the whole image
+[Xg, Yg] = meshgrid(1:N);
+Blob = single(exp(-((Xg - N/2).^2 + (Yg - N/2).^2)/(N*N/200)));
+Crop = (N/4+1):(3*N/4);
+Blob_deformed = DeformObject_C(Blob, RFP, AngleTransform, 0);
+fprintf('%s %e \n', 'Non-square N x M vs square (max abs diff)', max(max(abs(DeformObject_C(Blob(:,Crop), RFP, AngleTransform, 0) - Blob_deformed(:,Crop)))));
+fprintf('%s %e \n', 'Non-square M x N vs square (max abs diff)', max(max(abs(DeformObject_C(Blob(Crop,:), RFP, AngleTransform, 0) - Blob_deformed(Crop,:)))));
+
+% the same deformation of many images: the warp plan is built once and applied to a stack
+[Index, Weights] = DeformPlan_C(size(G), RFP, AngleTransform, 0);
+Stack = repmat(single(G), [1 1 8]);
+Stack_deformed = DeformObject_C(Stack, Index, Weights);
+fprintf('%s %e \n', 'Plan vs direct (max abs diff)', max(max(abs(Stack_deformed(:,:,8) - single(G_deformed)))));
+
+% fan-beam sinogram: every projection is the projection of the deformed phantom (no deformed images are formed)
+Th = single(0:1:359); % projection angles in degrees
+SinoFan = DeformSino_C(single(G), RFP, Th);
+% the matching inverse pipeline (unfiltered backprojection)
+BackProj = DeformSino_C(SinoFan, RFP, Th, 1);
+figure; 
+subplot(1,2,1); imagesc(SinoFan); title('Fan-beam sinogram'); colormap hot
+subplot(1,2,2); imagesc(BackProj); title('Backprojection'); daspect([1 1 1]); colormap hot
@@ -66,3 +66,51 @@ figure;
 subplot(1,2,1); imshow(F_a, []); title('Analytical Sinogram');
 subplot(1,2,2); imshow(sino_astra', []); title('Numerical Sinogram');
 %%
+fprintf('%s \n', 'Generating numerical sinogram with the built-in projector (no toolboxes required)...');
+% discrete projections (Joseph's method) of the rasterised phantom in the geometry of the analytical sinogram
+F_j = projectJoseph(single(G), P, single(angles), 'astra');
+err_diff = norm(F_a(:) - F_j(:))./norm(F_j(:));
+fprintf('%s %.4f\n', 'NMSE for sino residuals (Joseph):', err_diff);
+%%
+fprintf('%s \n', 'Generating fan-beam sinogram analytically and with ASTRA-toolbox...');
+% the geometry is in pixels: detector pixel size, source-origin and origin-detector distances
+DetSize = 1.5; SourceOrigin = 2*N; OriginDetector = N;
+[F_fan] = buildSinoFan2D(ModelNo, N, P, single(angles), pathTP, DetSize, SourceOrigin, OriginDetector, 'flat', 'astra'); 
+
+proj_geom = astra_create_proj_geom('fanflat', DetSize, P, (angles*pi/180), SourceOrigin, OriginDetector);
+[sinogram_id, sino_astra] = astra_create_sino_cuda(G, proj_geom, vol_geom);
+astra_mex_data2d('delete', sinogram_id);
+
+sinT = sino_astra';
+% calculate residiual norm (the error is expected since projection models not the same)
+err_diff = norm(F_fan(:) - sinT(:))./norm(sinT(:));
+fprintf('%s %.4f\n', 'NMSE for fan-beam sino residuals:', err_diff);
+
+figure; 
+subplot(1,2,1); imshow(F_fan, []); title('Analytical Fan-beam Sinogram');
+subplot(1,2,2); imshow(sino_astra', []); title('Numerical Fan-beam Sinogram');
+%%
+fprintf('%s \n', 'Adding noise to the analytical sinogram...');
+% Poisson noise of 1e4 flat-field photons, gaussian noise of 5 counts, zingers and stripes (reproducible with the seed)
+F_noisy = addNoise(single(F_a), 1e4, 1/N, 5, 1, [0.001, 10], [0.01, 0.1]);
+figure; imshow(F_noisy, []); title('Noisy Analytical Sinogram');
+%%
+fprintf('%s \n', 'Reconstructing with the built-in FBP (no toolboxes required)...');
+% the centring of the sinogram ('astra' here) must be the one it was generated with
+FBP_a = FBP(single(F_a), single(angles), N, 'astra');
+FBP_noisy = FBP(F_noisy, single(angles), N, 'astra');
+err_diff = norm(double(FBP_a(:)) - G(:))./norm(G(:));
+fprintf('%s %.4f\n', 'NMSE for FBP reconstruction:', err_diff);
+figure; 
+subplot(1,2,1); imagesc(FBP_a, [0 1]); title('FBP of Analytical Sinogram'); daspect([1 1 1]); colormap hot;
+subplot(1,2,2); imagesc(FBP_noisy, [0 1]); title('FBP of Noisy Sinogram'); daspect([1 1 1]); colormap hot;
+%%
+fprintf('%s \n', 'Generating sinogram of a moving object (motion during the acquisition)...');
+% every column is [Object, C0, x0, y0, a, b, phi_rot] of the object at the corresponding angle
+Params = repmat(single([3; 1; 0; 0; 0.3; 0.2; 20]), [1 length(angles)]);
+Params(3,:) = linspace(-0.4, 0.4, length(angles)); % the ellipse moves along x during the scan
+F_motion = buildSino2DMotion(Params, N, P, single(angles), 'radon');
+FBP_motion = iradon(F_motion,angles,N);
+figure; 
+subplot(1,2,1); imshow(F_motion, []); title('Sinogram of Moving Object');
+subplot(1,2,2); imagesc(FBP_motion, [0 1]); title('Reconstruction with Motion Artifacts'); daspect([1 1 1]); colormap hot;
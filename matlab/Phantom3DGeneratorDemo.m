@@ -58,6 +58,11 @@ angles = linspace(0,180,N); % projection angles
 det = round(sqrt(2)*N);
 sino_tomophan3D = buildSino3D(ModelNo, N, det, single(angles), pathTP, 'astra'); 
 %%
+fprintf('%s \n', 'Calculating 3D cone-beam exact projections using TomoPhantom...');
+% circular trajectory: detector [columns rows], pixel size, source-axis and axis-detector distances (in voxels)
+proj_tomophan3D = buildSinoCone3D(ModelNo, N, [det N], single(linspace(0,360,N)), pathTP, 1.5, 2*N, N, 'flat', 'astra'); 
+figure; imagesc(proj_tomophan3D(:,:,1)'); colormap hot; colorbar; daspect([1 1 1]); title('Exact cone-beam projection');
+%%
 fprintf('%s \n', 'Calculating 3D parallel-beam sinogram of a phantom using ASTRA-toolbox...');
 proj_geom = astra_create_proj_geom('parallel', 1, det, (angles*pi/180));
 vol_geom = astra_create_vol_geom(N,N);
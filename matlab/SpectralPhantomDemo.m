@@ -10,22 +10,21 @@ ModelNo = 11;
 % Define phantom dimension
 N = 512; % x-y size (squared image)
 
-% generate the 2D phantom:
+% generate the 2D phantom and the label map of its materials (the materials
+% are given as "Material : m;" after the objects in the library file):
 curDir   = pwd;
 mainDir  = fileparts(curDir);
 pathTP = strcat(mainDir,'/functions/models/Phantom2DLibrary.dat'); % path to TomoPhantom parameters file
-[G] = buildPhantom2D(ModelNo,N,pathTP);
+[G, L] = buildPhantom2D(ModelNo,N,pathTP);
 figure; imagesc(G, [0 1]); daspect([1 1 1]); colormap hot;
 
 % create 4 phantoms with dedicated materials
-G(G >= 1.29) = 0.8;
 G1 = zeros(N,N);
 G2 = zeros(N,N);
 G3 = zeros(N,N);
 G4 = zeros(N,N);
 
-G1((G > 0.2) & (G < 0.4)) = 1;
-G2((G > 0.7) & (G < 0.9)) = 2;
-G3((G > 1.0) & (G < 1.15)) = 3;
-G3(G > 1.17) = 4;
-G1(G > 1) = 0;
+G1(L == 1) = 1;
+G2(L == 2) = 2;
+G3(L == 3) = 3;
+G4(L == 4) = 4;
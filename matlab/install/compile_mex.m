@@ -5,16 +5,40 @@ mkdir compiled
 cd ../functions/
 
 fprintf('%s \n', 'Building functions...');
-mex buildPhantom2D.c buildPhantom2D_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+mex buildPhantom2D.c buildPhantom2D_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
 movefile buildPhantom2D.mexa64 ../matlab/compiled/
-mex buildSino2D.c buildSino2D_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+mex buildSino2D.c buildSino2D_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
 movefile buildSino2D.mexa64 ../matlab/compiled/
-mex buildPhantom3D.c buildPhantom3D_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+mex buildSino2DMotion.c buildSino2D_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile buildSino2DMotion.mexa64 ../matlab/compiled/
+mex buildSinoSpectral2D.c buildSino2D_core.c spectralSino_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile buildSinoSpectral2D.mexa64 ../matlab/compiled/
+mex addNoise.c noiseSino_core.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile addNoise.mexa64 ../matlab/compiled/
+mex buildSinoFan2D.c buildSinoFan2D_core.c lineIntegrals_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile buildSinoFan2D.mexa64 ../matlab/compiled/
+mex buildPhantom3D.c buildPhantom3D_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
 movefile buildPhantom3D.mexa64 ../matlab/compiled/
-mex buildSino3D.c buildSino3D_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+mex buildSino3D.c buildSino3D_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
 movefile buildSino3D.mexa64 ../matlab/compiled/
-mex DeformObject_C.c CFLAGS="\$CFLAGS -fopenmp -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+mex buildSinoCone3D.c buildSinoCone3D_core.c lineIntegrals_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile buildSinoCone3D.mexa64 ../matlab/compiled/
+mex buildLineIntegrals.c lineIntegrals_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile buildLineIntegrals.mexa64 ../matlab/compiled/
+mex samplePhantom.c samplePhantom_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile samplePhantom.mexa64 ../matlab/compiled/
+mex samplePlane3D.c samplePhantom_core.c utils.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile samplePlane3D.mexa64 ../matlab/compiled/
+mex DeformObject_C.c DeformObject_core.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
 movefile DeformObject_C.mexa64 ../matlab/compiled/
+mex DeformPlan_C.c DeformObject_core.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile DeformPlan_C.mexa64 ../matlab/compiled/
+mex DeformSino_C.c DeformObject_core.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile DeformSino_C.mexa64 ../matlab/compiled/
+mex FBP.c FBP_core.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile FBP.mexa64 ../matlab/compiled/
+mex projectJoseph.c projectJoseph_core.c CFLAGS="\$CFLAGS -fopenmp -fno-math-errno -Wall -std=c99" LDFLAGS="\$LDFLAGS -fopenmp"
+movefile projectJoseph.mexa64 ../matlab/compiled/
 fprintf('%s \n', 'All compiled!');
 
 cd ../
@@ -21,7 +21,7 @@ extra_libraries    = []
 if platform.system() == 'Windows':
     extra_compile_args += ['/DWIN32', '/openmp']
 else:
-    extra_compile_args += ['-fopenmp', '-O2', '-Wall', '-std=c99']
+    extra_compile_args += ['-fopenmp', '-O2', '-fno-math-errno', '-Wall', '-std=c99']
     extra_libraries += ['m','gomp']
     
 setup(
@@ -32,7 +32,28 @@ setup(
     ext_modules = cythonize([ Extension("tomophantom.phantom3d",
                             sources = [ "src/phantom3d.pyx",
                                         "../functions/buildPhantom3D_core.c",
+                                        "../functions/buildPhantom4D_core.c",
+                                        "../functions/DeformObject_core.c",
                                         "../functions/buildSino3D_core.c",
+                                        "../functions/buildSinoCone3D_core.c",
+                                        "../functions/FBP_core.c",
+                                        "../functions/lineIntegrals_core.c",
+                                        "../functions/noiseSino_core.c",
+                                        "../functions/projectJoseph_core.c",
+                                        "../functions/samplePhantom_core.c",
+                                        "../functions/spectralSino_core.c",
+                                        "../functions/utils.c"
+                                      ],
+                            include_dirs = extra_include_dirs,
+                            library_dirs = extra_library_dirs,
+                            extra_compile_args = extra_compile_args,
+                            libraries = extra_libraries,
+                            extra_link_args = extra_link_args),
+                            Extension("tomophantom.phantom2d",
+                            sources = [ "src/phantom2d.pyx",
+                                        "../functions/buildSino2D_core.c",
+                                        "../functions/buildSinoFan2D_core.c",
+                                        "../functions/lineIntegrals_core.c",
                                         "../functions/utils.c"
                                       ],
                             include_dirs = extra_include_dirs,
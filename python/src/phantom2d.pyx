@@ -0,0 +1,109 @@
+"""
+phantom2d.pyx
+Phantom 2D functions
+"""
+
+import cython
+
+# import numpy and the Cython declarations for numpy
+import numpy as np
+cimport numpy as np
+
+from tomophantom.phantom3d import _output_array
+
+# declare the interface to the C code (the C functions are re-entrant, so they are called without the GIL)
+cdef extern float buildSino2D_core_motion(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, float *Params, int Components, int Overwrite, float Weight, int Fast) nogil
+cdef extern float buildSinoFan2D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, float DetSize, float SourceOrigin, float OriginDetector, int Curved, int Obj, float C0, float x0, float y0, float a, float b, float phi_rot, int Overwrite) nogil
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def build_sinogram_motion_2d(int volume_size, int detector_size, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int CenTypeIn, params, out=None, bint fast_math=False):
+	"""
+	build_sinogram_motion_2d (volume_size, detector_size, angles, CenTypeIn, params, out=None, fast_math=False)
+	
+	Builds the 2D parallel beam sinogram of the objects which move (or change) during the acquisition: every
+	projection is the analytical projection of the objects with their parameters at its angle, the parameters
+	being a table of the trajectories of the objects (e.g. the values of a function of the angle index).
+	The objects which do not move are built as in a static sinogram.
+	
+	param: volume_size -- int volume size (volume_size x volume_size)
+	param: detector_size -- int detector size.
+	param: angles -- a numpy array of float values with angles in degrees
+	param: CenTypeIn -- the centring of the sinogram [0: radon, 1:astra]
+	param: params -- C-contiguous float32 array (Components x len(angles) x 7, or len(angles) x 7 for one object),
+	                 every row is (Obj, C0, x0, y0, a, b, phi_rot) of an object at an angle, the object types as of
+	                 Phantom2DLibrary.dat (1 - gaussian, 2 - parabola, 3 - ellipse, 4 - parabola1, 5 - cone, 6 - rectangle),
+	                 the type of an object is taken from its first row. The rectangles are the exception: their rows of the
+	                 sinogram are in the reverse order of the angles (as in the static 2D sinograms), the row i is the
+	                 projection at angles[-1-i] with the parameters params[..., -1-i, :]
+	param: out -- optional float32 array (len(angles) x detector_size) to write into
+	param: fast_math -- the precision of exp and log (see tomophantom.phantom3d.build_volume_phantom_3d_params)
+	returns: numpy float32 sinogram array (len(angles) x detector_size).
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] s
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] q
+	cdef int Components, AngTot = angles.shape[0]
+	cdef float ret_val
+	if (not isinstance(params, np.ndarray)) or (params.dtype != np.float32) or (not params.flags['C_CONTIGUOUS']):
+		raise ValueError("params must be a C-contiguous float32 array")
+	if params.ndim == 2:
+		params = params.reshape(1, params.shape[0], params.shape[1])
+	if (params.ndim != 3) or (params.shape[1] != AngTot) or (params.shape[2] != 7):
+		raise ValueError("params must be of the shape ([Components,] len(angles), 7)")
+	Components = params.shape[0]
+	sinogram, overwrite = _output_array(out, [AngTot, detector_size], 'overwrite')
+	if (AngTot == 0) or (detector_size == 0):
+		return sinogram
+	s = sinogram.reshape(-1)
+	if Components == 0:
+		sinogram.fill(0.0)
+		return sinogram
+	q = params.reshape(-1)
+	with nogil:
+		ret_val = buildSino2D_core_motion(&s[0], volume_size, detector_size, &angles[0], AngTot, CenTypeIn, &q[0], Components, 1, 1.0, fast_math)
+	return sinogram
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def build_sinogram_fan_2d(int volume_size, int detector_size, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int CenTypeIn, params, float source_origin, float origin_detector, float pixel_size=1.0, int curved=0, out=None):
+	"""
+	build_sinogram_fan_2d (volume_size, detector_size, angles, CenTypeIn, params, source_origin, origin_detector, pixel_size=1.0, curved=0, out=None)
+	
+	Returns the exact fan-beam sinogram of the 2D objects, no phantom is rasterised. The parallel beam sinograms
+	have the detector pitch detector_size*volume_size/((volume_size+1)*(detector_size-1)) voxels: with this
+	pixel_size and a distant source (about 1e4 voxels) the sinogram of the smooth objects is the parallel beam
+	one bin for bin (the edges of the disks and rectangles converge more slowly with the distance of the source).
+	
+	param: volume_size -- int volume size (volume_size x volume_size)
+	param: detector_size -- int detector size.
+	param: angles -- a numpy array of float values with angles in degrees
+	param: CenTypeIn -- the centring of the sinogram [0: radon, 1:astra]
+	param: params -- C-contiguous float32 array (Components x 7), every row is (Obj, C0, x0, y0, a, b, phi_rot) of an
+	                 object, the object types as of build_sinogram_motion_2d
+	param: source_origin -- the source to the centre of rotation distance (in voxels)
+	param: origin_detector -- the centre of rotation to the detector distance (in voxels)
+	param: pixel_size -- the detector pixel size (in voxels)
+	param: curved -- 0: flat detector (default), 1: curved detector centred at the source
+	param: out -- optional float32 array (len(angles) x detector_size) to write into
+	returns: numpy float32 sinogram array (len(angles) x detector_size).
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] sinogram
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] q
+	cdef Py_ssize_t i
+	cdef int overwrite, AngTot = angles.shape[0]
+	cdef float ret_val
+	if (not isinstance(params, np.ndarray)) or (params.dtype != np.float32) or (not params.flags['C_CONTIGUOUS']) or (params.ndim != 2) or (params.shape[1] != 7):
+		raise ValueError("params must be a C-contiguous float32 array of the shape (Components, 7)")
+	if (pixel_size <= 0.0) or (source_origin <= 0.5*np.sqrt(2.0)*volume_size) or (origin_detector < 0.0):
+		raise ValueError("the detector pixel size must be positive and the source outside of the image")
+	q = params
+	sinogram, overwrite = _output_array(out, [AngTot, detector_size], 'overwrite')
+	if q.shape[0] == 0:
+		sinogram[...] = 0.0
+	with nogil:
+		for i in range(q.shape[0]):
+			ret_val = buildSinoFan2D_core_single(&sinogram[0,0], volume_size, detector_size, &angles[0], AngTot, CenTypeIn, pixel_size, source_origin, origin_detector, curved, <int> q[i,0], q[i,1], q[i,2], q[i,3], q[i,4], q[i,5], q[i,6], overwrite)
+			overwrite = 0
+	return sinogram
@@ -9,11 +9,35 @@ import cython
 import numpy as np
 cimport numpy as np
 
-# declare the interface to the C code
-cdef extern float buildPhantom3D_core(float *A, int ModelSelected, int N, char* ModelParametersFilename)
-cdef extern float buildPhantom3D_core_single(float *A, int N,  int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float psi1, float psi2, float psi3)
-cdef extern float buildSino3D_core(float *A, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char* ModelParametersFilename)
-cdef extern float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float phi_rot)
+# declare the interface to the C code (the C functions are re-entrant, so they are called without the GIL)
+cdef extern float buildPhantom3D_core(float *A, int ModelSelected, int N, char* ModelParametersFilename, int Overwrite, float Weight, int Z1, int Z2, int Fast) nogil
+cdef extern float buildPhantom3D_core_compact(unsigned short *A, int Format, float Scale, float Offset, int ModelSelected, int N, char* ModelParametersFilename, float Weight, int Z1, int Z2, int Fast) nogil
+cdef extern float buildPhantom3D_core_materials(float *A, unsigned char *L, float *M, int NumMaterials, int ModelSelected, int N, char* ModelParametersFilename, float Weight, int Z1, int Z2, int Fast) nogil
+cdef extern float buildPhantom3D_core_single(float *A, int N,  int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float psi1, float psi2, float psi3, int Overwrite, int Z1, int Z2, int Fast) nogil
+cdef extern float buildSino3D_core(float *A, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char* ModelParametersFilename, int Overwrite, float Weight, int Z1, int Z2, int Ang1, int Ang2, int Fast) nogil
+cdef extern float buildSino3D_core_compact(unsigned short *A, int Format, float Scale, float Offset, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char* ModelParametersFilename, float Weight, int Z1, int Z2, int Ang1, int Ang2, int Fast) nogil
+cdef extern float buildSino3D_core_materials(float *A, int NumMaterials, int ModelSelected, int N, int P, float *Th, int AngTot, int CenTypeIn, char* ModelParametersFilename, float Weight, int Z1, int Z2, int Ang1, int Ang2, int Fast) nogil
+cdef extern float buildSino3D_core_single(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float phi_rot, int Overwrite, int Z1, int Z2, int Ang1, int Ang2, int Fast) nogil
+cdef extern float buildSinoCone3D_core(float *A, int ModelSelected, int N, int P, int Rows, float *Th, int AngTot, int CenTypeIn, float DetSizeX, float DetSizeZ, float SourceOrigin, float OriginDetector, int Curved, char* ModelParametersFilename, int Overwrite, float Weight) nogil
+cdef extern float buildSinoCone3D_core_single(float *A, int N, int P, int Rows, float *Th, int AngTot, int CenTypeIn, float DetSizeX, float DetSizeZ, float SourceOrigin, float OriginDetector, int Curved, int Object, float C0, float x0, float y0, float z0, float a, float b, float c, float psi1, float psi2, float psi3, int Overwrite) nogil
+cdef extern float lineIntegrals3D_core(float *A, int ModelSelected, int N, float *Rays, int NRays, int CenTypeIn, char* ModelParametersFilename, int Overwrite, float Weight) nogil
+cdef extern float lineIntegrals3D_core_params(float *A, int N, float *Rays, int NRays, int CenTypeIn, float *Params, int Components, int Overwrite, float Weight) nogil
+cdef extern float samplePhantom3D_core(float *A, int ModelSelected, float *Points, int M, char* ModelParametersFilename, int Overwrite, float Weight) nogil
+cdef extern float samplePhantom3D_core_params(float *A, float *Points, int M, float *Params, int Components, int Overwrite, float Weight) nogil
+cdef extern float samplePlane3D_core(float *A, int ModelSelected, float *Origin, float *U, float *V, int NU, int NV, char* ModelParametersFilename, int Overwrite, float Weight) nogil
+cdef extern float samplePlane3D_core_params(float *A, float *Origin, float *U, float *V, int NU, int NV, float *Params, int Components, int Overwrite, float Weight) nogil
+cdef extern float spectralSino_core(float *A, float *Basis, int NumMaterials, int Rows, int Cols, float *Mu, int NumEnergies, float *Weights, int NumBins, int Fast) nogil
+cdef extern float DeformObject_core_interp(float *A, float *B, int dimX, int dimY, float RFP, float Angle, int DeformType, int Interp) nogil
+cdef extern int DeformObject_plan_core(int *Index, float *Weights, unsigned short *QWeights, int dimX, int dimY, float RFP, float Angle, int DeformType) nogil
+cdef extern float DeformObject_apply_core(int *Index, float *Weights, unsigned short *QWeights, float *A, float *B, int dimX, int dimY, int Images) nogil
+cdef extern float noiseSino_core(float *A, int Rows, int Cols, float I0, float Scale, float Sigma, float ZingerProb, float ZingerAmp, float StripeProb, float StripeStrength, unsigned int Seed) nogil
+cdef extern float FBP_core(float *A, float *Sino, int N, int P, float *Th, int AngTot, int CenTypeIn, int Slices) nogil
+cdef extern float projectJoseph_core(float *S, float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, int Slices) nogil
+cdef extern int buildPhantom4D_core_update(float *A, int N, float *Old, float *New, int Components, int Fast) nogil
+cdef extern int buildSino4D_core_update(float *A, int N, int P, float *Th, int AngTot, int CenTypeIn, float *Old, float *New, int Components, int Fast) nogil
+cdef extern from "fastMath.h":
+	float fast_expf(float x) nogil
+	float fast_logf(float x) nogil
 	
 cdef packed struct object_3d:
 	np.int_t Obj
@@ -28,56 +52,172 @@ cdef packed struct object_3d:
 	np.float32_t psi2
 	np.float32_t psi3
 	
+def _output_array(out, shape, str mode):
+	"""
+	returns the output array and the overwrite flag for the C functions
+	
+	param: out -- None (a new array is allocated) or a C-contiguous float32 array of the given shape
+	param: mode -- 'overwrite': the first object is written into the array, the following are added (the array is not zeroed beforehand),
+	               'accumulate': all objects are added to the existing data of out
+	"""
+	if mode not in ('overwrite', 'accumulate'):
+		raise ValueError("mode must be 'overwrite' or 'accumulate'")
+	if out is None:
+		if mode == 'accumulate':
+			raise ValueError("an output array is required for the 'accumulate' mode")
+		# no zero-filling here: the first parallel pass writes (and first-touches) every element
+		return np.empty(shape, dtype='float32'), 1
+	if (not isinstance(out, np.ndarray)) or (out.dtype != np.float32) or (not out.flags['C_CONTIGUOUS']) or (out.shape != tuple(shape)):
+		raise ValueError("out must be a C-contiguous float32 array of shape %s" % (tuple(shape),))
+	return out, int(mode == 'overwrite')
+
+def _compact_array(out, shape, str dtype):
+	"""
+	returns the output array of a compact format, its uint16 view for the C functions and the format number of store_compact
+	
+	param: out -- None (a new array is allocated) or a C-contiguous array of the given shape and of the numpy type of dtype
+	param: dtype -- 'float16', 'bfloat16' (stored as the upper 16 bits of float32 in a uint16 array) or 'uint16'
+	"""
+	formats = {'float16': (0, np.float16), 'bfloat16': (1, np.uint16), 'uint16': (2, np.uint16)}
+	if dtype not in formats:
+		raise ValueError("dtype must be 'float16', 'bfloat16' or 'uint16'")
+	Format, np_type = formats[dtype]
+	if out is None:
+		out = np.empty(shape, dtype=np_type)
+	elif (not isinstance(out, np.ndarray)) or (out.dtype != np_type) or (not out.flags['C_CONTIGUOUS']) or (out.shape != tuple(shape)):
+		raise ValueError("out must be a C-contiguous %s array of shape %s" % (np.dtype(np_type).name, tuple(shape)))
+	return out, out.view(np.uint16), Format
+
+def _model_array(object_3d[:] obj_params):
+	"""
+	returns the objects as a float32 array (max(n, 1) x 11) in the order of read_model3D for the batched C functions
+	"""
+	cdef Py_ssize_t i
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] params = np.zeros([max(obj_params.shape[0], 1), 11], dtype='float32')
+	for i in range(obj_params.shape[0]):
+		params[i,0] = obj_params[i].Obj
+		params[i,1] = obj_params[i].C0
+		params[i,2] = obj_params[i].x0
+		params[i,3] = obj_params[i].y0
+		params[i,4] = obj_params[i].z0
+		params[i,5] = obj_params[i].a
+		params[i,6] = obj_params[i].b
+		params[i,7] = obj_params[i].c
+		params[i,8] = obj_params[i].psi1
+		params[i,9] = obj_params[i].psi2
+		params[i,10] = obj_params[i].psi3
+	return params
+
 @cython.boundscheck(False)
 @cython.wraparound(False)
-def build_volume_phantom_3d_params(int phantom_size, object_3d[:] obj_params):
+def build_volume_phantom_3d_params(int phantom_size, object_3d[:] obj_params, out=None, str mode='overwrite', float weight=1.0, bint fast_math=False):
 	"""
-	build_volume_phantom_3d (model_parameters_filename,model_id, phantom_size)
+	build_volume_phantom_3d_params (phantom_size, obj_params, out=None, mode='overwrite', weight=1.0, fast_math=False)
 	
-	Takes in a input model_id and phantom_size and returns a phantom of phantom_size x phantom_size x phantom_size of type float32 numpy array.
+	Takes in a list of objects and phantom_size and returns a phantom of phantom_size x phantom_size x phantom_size of type float32 numpy array.
 	
-	param: model_parameters_filename -- filename for the model parameters
-	param: model_id -- a model id from the functions file
 	param: phantom_size -- a phantom size in each dimension.
+	param: obj_params -- object parameters list
+	param: out -- optional float32 array (phantom_size x phantom_size x phantom_size) to write into
+	param: mode -- 'overwrite' (default) or 'accumulate' (adds to the existing data of out)
+	param: weight -- the intensities of all objects are multiplied by weight
+	param: fast_math -- True: the polynomial approximations of exp and log (relative error below 8.2e-8, see
+	                   fast_math_functions, the gaussian and cone objects are 1.5-4 times faster), False: exp and log
+	                   of the C library (default); fast_math has the same meaning in all functions of the package
 	
 	returns: numpy float32 phantom array
 	
 	"""
 	cdef Py_ssize_t i
-	cdef np.ndarray[np.float32_t, ndim=3, mode="c"] phantom = np.empty([phantom_size, phantom_size, phantom_size], dtype='float32')
+	cdef np.ndarray[np.float32_t, ndim=3, mode="c"] phantom
+	cdef int overwrite
+	phantom, overwrite = _output_array(out, [phantom_size, phantom_size, phantom_size], mode)
 	cdef float ret_val
-	for i in range(obj_params.shape[0]):
-		ret_val = buildPhantom3D_core_single(&phantom[0,0,0], phantom_size, obj_params[i].Obj, obj_params[i].C0, obj_params[i].x0, obj_params[i].y0, obj_params[i].z0, obj_params[i].a, obj_params[i].b, obj_params[i].c, obj_params[i].psi1, obj_params[i].psi2, obj_params[i].psi3)
+	if overwrite and (obj_params.shape[0] == 0):
+		phantom[...] = 0.0
+	with nogil:
+		for i in range(obj_params.shape[0]):
+			ret_val = buildPhantom3D_core_single(&phantom[0,0,0], phantom_size, obj_params[i].Obj, weight*obj_params[i].C0, obj_params[i].x0, obj_params[i].y0, obj_params[i].z0, obj_params[i].a, obj_params[i].b, obj_params[i].c, obj_params[i].psi1, obj_params[i].psi2, obj_params[i].psi3, overwrite, 0, phantom_size, fast_math)
+			overwrite = 0
 	return phantom	
 	
 @cython.boundscheck(False)
 @cython.wraparound(False)
-def buildPhantom3D(int model_id, int phantom_size, str model_parameters_filename):
+def buildPhantom3D(int model_id, int phantom_size, str model_parameters_filename, out=None, str mode='overwrite', float weight=1.0, bint fast_math=False):
 	"""
-	buildPhantom3D(model_id, phantom_size,model_parameters_filename)
+	buildPhantom3D(model_id, phantom_size, model_parameters_filename, out=None, mode='overwrite', weight=1.0, fast_math=False)
 	
 	Takes in a input model_id and phantom_size and returns a phantom of phantom_size x phantom_size x phantom_size of type float32 numpy array.
 	
 	param: model_parameters_filename -- filename for the model parameters
 	param: model_id -- a model id from the functions file
 	param: phantom_size -- a phantom size in each dimension.
+	param: out -- optional float32 array (phantom_size x phantom_size x phantom_size) to write into
+	param: mode -- 'overwrite' (default) or 'accumulate' (adds to the existing data of out)
+	param: weight -- the intensities of all objects are multiplied by weight
+	param: fast_math -- the precision of exp and log (see build_volume_phantom_3d_params)
 	
 	returns: numpy float32 phantom array
 	
 	"""
 	
-	cdef np.ndarray[np.float32_t, ndim=3, mode="c"] phantom = np.empty([phantom_size, phantom_size, phantom_size], dtype='float32')
+	cdef np.ndarray[np.float32_t, ndim=3, mode="c"] phantom
+	cdef int overwrite
+	phantom, overwrite = _output_array(out, [phantom_size, phantom_size, phantom_size], mode)
 	cdef float ret_val
 	py_byte_string = model_parameters_filename.encode('UTF-8')
 	cdef char* c_string = py_byte_string
-	ret_val = buildPhantom3D_core(&phantom[0,0,0], model_id, phantom_size, c_string)
+	with nogil:
+		ret_val = buildPhantom3D_core(&phantom[0,0,0], model_id, phantom_size, c_string, overwrite, weight, 0, phantom_size, fast_math)
 	return phantom
+
+def build_volume_phantom_3d(str model_parameters_filename, int model_id, int phantom_size, out=None, str mode='overwrite', float weight=1.0, bint fast_math=False):
+	"""
+	build_volume_phantom_3d (model_parameters_filename, model_id, phantom_size, out=None, mode='overwrite', weight=1.0, fast_math=False)
+	
+	The same as buildPhantom3D with the model file given first.
+	
+	"""
+	return buildPhantom3D(model_id, phantom_size, model_parameters_filename, out, mode, weight, fast_math)
 	
 @cython.boundscheck(False)
 @cython.wraparound(False)
-def build_sinogram_phantom_3d(str model_parameters_filename, int model_id, int volume_size, int detector_size, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int CenTypeIn):
+def build_volume_phantom_3d_materials(str model_parameters_filename, int model_id, int phantom_size, int num_materials=0, float weight=1.0, bint fast_math=False):
 	"""
-	build_sinogram_phantom_3d (model_parameters_filename, model_id, volume_size, detector_size, angles)
+	build_volume_phantom_3d_materials (model_parameters_filename, model_id, phantom_size, num_materials=0, weight=1.0, fast_math=False)
+	
+	Builds the phantom together with the maps of the materials of its objects, given in the model file
+	as "Object : ...; Material : m;" (m in 0-255), all outputs are written in the same pass over the objects.
+	
+	param: num_materials -- the number of the material maps (the materials 1, ..., num_materials)
+	param: weight -- the intensities of all objects are multiplied by weight
+	param: fast_math -- the precision of exp and log (see build_volume_phantom_3d_params)
+	
+	returns: (phantom, labels, maps) -- the float32 phantom, the uint8 label map (the material of the last object
+	         covering a voxel, the part above the half of the maximum for gaussians, 0 where no object with a material
+	         is present) and the float32 maps (num_materials x phantom_size^3) with the sum of the objects of each material
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=3, mode="c"] phantom = np.empty([phantom_size, phantom_size, phantom_size], dtype='float32')
+	cdef np.ndarray[np.uint8_t, ndim=3, mode="c"] labels = np.empty([phantom_size, phantom_size, phantom_size], dtype='uint8')
+	cdef np.ndarray[np.float32_t, ndim=4, mode="c"] maps = np.empty([max(num_materials, 0), phantom_size, phantom_size, phantom_size], dtype='float32')
+	cdef float *maps_ptr = NULL
+	cdef float ret_val
+	py_byte_string = model_parameters_filename.encode('UTF-8')
+	cdef char* c_string = py_byte_string
+	if phantom_size <= 0:
+		return phantom, labels, maps
+	if num_materials > 0:
+		maps_ptr = &maps[0,0,0,0]
+	with nogil:
+		ret_val = buildPhantom3D_core_materials(&phantom[0,0,0], &labels[0,0,0], maps_ptr, num_materials, model_id, phantom_size, c_string, weight, 0, phantom_size, fast_math)
+	return phantom, labels, maps
+	
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def build_sinogram_phantom_3d(str model_parameters_filename, int model_id, int volume_size, int detector_size, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int CenTypeIn, out=None, str mode='overwrite', float weight=1.0, bint fast_math=False):
+	"""
+	build_sinogram_phantom_3d (model_parameters_filename, model_id, volume_size, detector_size, angles, CenTypeIn, out=None, mode='overwrite', weight=1.0, fast_math=False)
 	
 	Takes in as input model_id, volume_size, detector_size and projection angles and return a 3D sinogram corresponding to the model id.
 	
@@ -87,23 +227,30 @@ def build_sinogram_phantom_3d(str model_parameters_filename, int model_id, int v
 	param: detector_size -- int detector size.
 	param: angles -- a numpy array of float values with angles in radians
 	param: CenTypeIn -- 1 as default [0: radon, 1:astra]
+	param: out -- optional float32 array (len(angles) x detector_size x volume_size) to write into
+	param: mode -- 'overwrite' (default) or 'accumulate' (adds to the existing data of out)
+	param: weight -- the intensities of all objects are multiplied by weight
+	param: fast_math -- the precision of exp and log (see build_volume_phantom_3d_params)
 	returns: numpy float32 phantom sinograms array.
 	
 	"""
 	
-	cdef np.ndarray[np.float32_t, ndim=3, mode="c"] sinogram = np.zeros([angles.shape[0], detector_size, volume_size], dtype='float32')
+	cdef np.ndarray[np.float32_t, ndim=3, mode="c"] sinogram
+	cdef int overwrite
+	sinogram, overwrite = _output_array(out, [angles.shape[0], detector_size, volume_size], mode)
 	cdef float ret_val
 	py_byte_string = model_parameters_filename.encode('UTF-8')
 	cdef char* c_string = py_byte_string    
 	cdef int AngTot = angles.shape[0]
-	ret_val = buildSino3D_core(&sinogram[0,0,0], model_id, volume_size, detector_size, &angles[0], AngTot, CenTypeIn, c_string)
+	with nogil:
+		ret_val = buildSino3D_core(&sinogram[0,0,0], model_id, volume_size, detector_size, &angles[0], AngTot, CenTypeIn, c_string, overwrite, weight, 0, volume_size, 0, AngTot, fast_math)
 	return sinogram	
 	
 @cython.boundscheck(False)
 @cython.wraparound(False)
-def build_sinogram_phantom_3d_params(int volume_size, int detector_size, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int CenTypeIn, object_3d[:] obj_params):
+def build_sinogram_phantom_3d_params(int volume_size, int detector_size, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int CenTypeIn, object_3d[:] obj_params, out=None, str mode='overwrite', float weight=1.0, bint fast_math=False):
 	"""
-	build_sinogram_phantom_3d (model_parameters_filename, model_id, volume_size, detector_size, angles)
+	build_sinogram_phantom_3d_params (volume_size, detector_size, angles, CenTypeIn, obj_params, out=None, mode='overwrite', weight=1.0, fast_math=False)
 	
 	Takes in as input model parameters list, volume_size, detector_size and projection angles and return a 3D sinogram corresponding to the model id.
 	
@@ -113,13 +260,729 @@ def build_sinogram_phantom_3d_params(int volume_size, int detector_size, np.ndar
 	param: angles -- a numpy array of float values with angles in radians
 	param: CenTypeIn -- 1 as default [0: radon, 1:astra]
 	param: obj_params -- object parameters list
+	param: out -- optional float32 array (len(angles) x detector_size x volume_size) to write into
+	param: mode -- 'overwrite' (default) or 'accumulate' (adds to the existing data of out)
+	param: weight -- the intensities of all objects are multiplied by weight
+	param: fast_math -- the precision of exp and log (see build_volume_phantom_3d_params)
 	returns: numpy float32 phantom sinograms array.
 	
 	"""
 	cdef Py_ssize_t i	
-	cdef np.ndarray[np.float32_t, ndim=3, mode="c"] sinogram = np.zeros([angles.shape[0], detector_size, volume_size], dtype='float32')
+	cdef np.ndarray[np.float32_t, ndim=3, mode="c"] sinogram
+	cdef int overwrite
+	sinogram, overwrite = _output_array(out, [angles.shape[0], detector_size, volume_size], mode)
 	cdef float ret_val 
 	cdef int AngTot = angles.shape[0]
-	for i in range(obj_params.shape[0]):
-		ret_val = buildSino3D_core_single(&sinogram[0,0,0], volume_size, detector_size, &angles[0], AngTot, CenTypeIn, obj_params[i].Obj, obj_params[i].C0, obj_params[i].x0, obj_params[i].y0, obj_params[i].z0, obj_params[i].a, obj_params[i].b, obj_params[i].c, obj_params[i].phi_rot)
-	return sinogram		
+	if overwrite and (obj_params.shape[0] == 0):
+		sinogram[...] = 0.0
+	with nogil:
+		for i in range(obj_params.shape[0]):
+			ret_val = buildSino3D_core_single(&sinogram[0,0,0], volume_size, detector_size, &angles[0], AngTot, CenTypeIn, obj_params[i].Obj, weight*obj_params[i].C0, obj_params[i].x0, obj_params[i].y0, obj_params[i].z0, obj_params[i].a, obj_params[i].b, obj_params[i].c, obj_params[i].psi1, overwrite, 0, volume_size, 0, AngTot, fast_math)
+			overwrite = 0
+	return sinogram
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def build_volume_phantom_3d_compact(str model_parameters_filename, int model_id, int phantom_size, str dtype='float16', float scale=1.0, float offset=0.0, out=None, float weight=1.0, bint fast_math=False):
+	"""
+	build_volume_phantom_3d_compact (model_parameters_filename, model_id, phantom_size, dtype='float16', scale=1.0, offset=0.0, out=None, weight=1.0, fast_math=False)
+	
+	The same as build_volume_phantom_3d with a 16-bit output: the objects are accumulated in float32 slabs and
+	every voxel is stored once, so the float32 volume is never allocated.
+	
+	param: dtype -- 'float16', 'bfloat16' (returned as the bits in a uint16 array) or 'uint16'
+	param: scale, offset -- the 'uint16' values are round(phantom*scale + offset) clipped to [0, 65535]
+	param: out -- optional C-contiguous array (phantom_size x phantom_size x phantom_size) of float16 or uint16 to write into
+	param: weight -- the intensities of all objects are multiplied by weight
+	param: fast_math -- the precision of exp and log (see build_volume_phantom_3d_params)
+	
+	returns: numpy float16 or uint16 phantom array
+	
+	"""
+	cdef np.ndarray[np.uint16_t, ndim=3, mode="c"] bits
+	cdef int Format
+	phantom, bits, Format = _compact_array(out, [phantom_size, phantom_size, phantom_size], dtype)
+	cdef float ret_val
+	py_byte_string = model_parameters_filename.encode('UTF-8')
+	cdef char* c_string = py_byte_string
+	if phantom_size <= 0:
+		return phantom
+	with nogil:
+		ret_val = buildPhantom3D_core_compact(&bits[0,0,0], Format, scale, offset, model_id, phantom_size, c_string, weight, 0, phantom_size, fast_math)
+	return phantom
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def build_sinogram_materials_3d(str model_parameters_filename, int model_id, int volume_size, int detector_size, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int CenTypeIn, int num_materials, float weight=1.0, bint fast_math=False):
+	"""
+	build_sinogram_materials_3d (model_parameters_filename, model_id, volume_size, detector_size, angles, CenTypeIn, num_materials, weight=1.0, fast_math=False)
+	
+	Builds the basis sinograms of the materials 1, ..., num_materials of the model ("Object : ...; Material : m;"
+	in the model file), each one is the sinogram (see build_sinogram_phantom_3d) of the objects of one material.
+	The objects without a material are not included. The sinograms of energies are formed from the basis
+	with spectral_sinograms, so the objects are projected once per material and not once per energy.
+	
+	param: fast_math -- the precision of exp and log (see build_volume_phantom_3d_params)
+	
+	returns: numpy float32 array (num_materials x len(angles) x detector_size x volume_size)
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=4, mode="c"] basis = np.empty([max(num_materials, 0), angles.shape[0], detector_size, volume_size], dtype='float32')
+	cdef float ret_val
+	py_byte_string = model_parameters_filename.encode('UTF-8')
+	cdef char* c_string = py_byte_string
+	cdef int AngTot = angles.shape[0]
+	if basis.size == 0:
+		return basis
+	with nogil:
+		ret_val = buildSino3D_core_materials(&basis[0,0,0,0], num_materials, model_id, volume_size, detector_size, &angles[0], AngTot, CenTypeIn, c_string, weight, 0, volume_size, 0, AngTot, fast_math)
+	return basis
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def spectral_sinograms(basis, mu, weights=None, bint fast_math=False):
+	"""
+	spectral_sinograms (basis, mu, weights=None, fast_math=False)
+	
+	Forms the sinograms of energies or energy bins from the basis sinograms of materials.
+	
+	param: basis -- float32 array (materials x ...) of the basis sinograms (see build_sinogram_materials_3d)
+	param: mu -- the attenuation of the materials at the energies (energies x materials)
+	param: weights -- None: returns the linear combinations sum_m mu[e, m]*basis[m] (one sinogram per energy),
+	                  otherwise the spectra of the energy bins (bins x energies, the source spectrum times the detector
+	                  response): returns the polychromatic Beer-Lambert sinograms
+	                  -log(sum_e weights[b, e]*exp(-sum_m mu[e, m]*basis[m]) / sum_e weights[b, e])
+	param: fast_math -- the precision of exp and log of the polychromatic integration (see build_volume_phantom_3d_params)
+	
+	returns: numpy float32 array (energies or bins x ...) of the shape of basis[0]
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] b = np.ascontiguousarray(basis, dtype=np.float32).reshape(-1)
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] m = np.ascontiguousarray(mu, dtype=np.float32)
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] w
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] out
+	cdef float *w_ptr = NULL
+	cdef int NumMaterials = np.shape(basis)[0]
+	cdef int NumEnergies = m.shape[0]
+	cdef int NumBins = NumEnergies
+	cdef int Rows, Cols
+	cdef float ret_val
+	shape = tuple(np.shape(basis)[1:])
+	if m.shape[1] != NumMaterials:
+		raise ValueError("mu must be of the shape (energies, %d)" % NumMaterials)
+	if weights is not None:
+		w = np.ascontiguousarray(weights, dtype=np.float32)
+		if w.shape[1] != NumEnergies:
+			raise ValueError("weights must be of the shape (bins, %d)" % NumEnergies)
+		NumBins = w.shape[0]
+		w_ptr = &w[0,0]
+	Cols = shape[len(shape)-1] if len(shape) > 0 else 1
+	Rows = int(np.prod(shape)) // Cols if Cols > 0 else 0
+	out = np.empty([NumBins*Rows*Cols], dtype='float32')
+	if (out.shape[0] == 0) or (NumMaterials == 0):
+		return out.reshape((NumBins,) + shape)
+	with nogil:
+		ret_val = spectralSino_core(&out[0], &b[0], NumMaterials, Rows, Cols, &m[0,0], NumEnergies, w_ptr, NumBins, fast_math)
+	return out.reshape((NumBins,) + shape)
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def fast_math_functions(x):
+	"""
+	fast_math_functions (x)
+	
+	Evaluates the approximations of exp and log used with fast_math=True (e.g. to check their error).
+	
+	param: x -- array of the arguments (converted to float32)
+	
+	returns: (exp, log) -- float32 arrays of the shape of x, exp is defined for x <= 88.3 (0 below about -87.7),
+	         log for normal positive x
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] v = np.ascontiguousarray(x, dtype=np.float32).reshape(-1)
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] e = np.empty_like(v)
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] l = np.empty_like(v)
+	cdef Py_ssize_t i
+	with nogil:
+		for i in range(v.shape[0]):
+			e[i] = fast_expf(v[i])
+			l[i] = fast_logf(v[i])
+	return e.reshape(np.shape(x)), l.reshape(np.shape(x))
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def build_sinogram_phantom_3d_compact(str model_parameters_filename, int model_id, int volume_size, int detector_size, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int CenTypeIn, str dtype='float16', float scale=1.0, float offset=0.0, out=None, float weight=1.0, bint fast_math=False):
+	"""
+	build_sinogram_phantom_3d_compact (model_parameters_filename, model_id, volume_size, detector_size, angles, CenTypeIn, dtype='float16', scale=1.0, offset=0.0, out=None, weight=1.0, fast_math=False)
+	
+	The same as build_sinogram_phantom_3d with a 16-bit output (see build_volume_phantom_3d_compact).
+	
+	param: dtype -- 'float16', 'bfloat16' (returned as the bits in a uint16 array) or 'uint16'
+	param: scale, offset -- the 'uint16' values are round(sinogram*scale + offset) clipped to [0, 65535]
+	param: out -- optional C-contiguous array (len(angles) x detector_size x volume_size) of float16 or uint16 to write into
+	param: weight -- the intensities of all objects are multiplied by weight
+	param: fast_math -- the precision of exp and log (see build_volume_phantom_3d_params)
+	
+	returns: numpy float16 or uint16 sinograms array
+	
+	"""
+	cdef np.ndarray[np.uint16_t, ndim=3, mode="c"] bits
+	cdef int Format
+	sinogram, bits, Format = _compact_array(out, [angles.shape[0], detector_size, volume_size], dtype)
+	cdef float ret_val
+	py_byte_string = model_parameters_filename.encode('UTF-8')
+	cdef char* c_string = py_byte_string
+	cdef int AngTot = angles.shape[0]
+	if sinogram.size == 0:
+		return sinogram
+	with nogil:
+		ret_val = buildSino3D_core_compact(&bits[0,0,0], Format, scale, offset, model_id, volume_size, detector_size, &angles[0], AngTot, CenTypeIn, c_string, weight, 0, volume_size, 0, AngTot, fast_math)
+	return sinogram
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def build_sinogram_cone_3d(str model_parameters_filename, int model_id, int volume_size, int detector_size, int detector_rows, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int CenTypeIn, float source_origin, float origin_detector, float pixel_size=1.0, float row_size=1.0, int curved=0, out=None, str mode='overwrite', float weight=1.0):
+	"""
+	build_sinogram_cone_3d (model_parameters_filename, model_id, volume_size, detector_size, detector_rows, angles, CenTypeIn, source_origin, origin_detector, pixel_size=1.0, row_size=1.0, curved=0, out=None, mode='overwrite', weight=1.0)
+	
+	Returns the exact cone-beam projections (circular trajectory around the z axis) of the model, no phantom is voxelised.
+	
+	param: model_parameters_filename -- filename for the model parameters
+	param: model_id -- a model id from the functions file
+	param: volume_size -- a phantom size in each dimension.
+	param: detector_size -- int number of detector columns.
+	param: detector_rows -- int number of detector rows (along the rotation axis).
+	param: angles -- a numpy array of float values with angles in degrees
+	param: CenTypeIn -- 1 as default [0: radon, 1:astra]
+	param: source_origin -- the source to the rotation axis distance (in voxels)
+	param: origin_detector -- the rotation axis to the detector distance (in voxels)
+	param: pixel_size, row_size -- the detector pixel size across and along the rotation axis (in voxels)
+	param: curved -- 0: flat detector (default), 1: cylindrical detector centred at the source
+	param: out -- optional float32 array (len(angles) x detector_rows x detector_size) to write into
+	param: mode -- 'overwrite' (default) or 'accumulate' (adds to the existing data of out)
+	param: weight -- the intensities of all objects are multiplied by weight
+	returns: numpy float32 projections array (len(angles) x detector_rows x detector_size).
+	
+	"""
+	
+	cdef np.ndarray[np.float32_t, ndim=3, mode="c"] projections
+	cdef int overwrite
+	projections, overwrite = _output_array(out, [angles.shape[0], detector_rows, detector_size], mode)
+	cdef float ret_val
+	py_byte_string = model_parameters_filename.encode('UTF-8')
+	cdef char* c_string = py_byte_string
+	cdef int AngTot = angles.shape[0]
+	with nogil:
+		ret_val = buildSinoCone3D_core(&projections[0,0,0], model_id, volume_size, detector_size, detector_rows, &angles[0], AngTot, CenTypeIn, pixel_size, row_size, source_origin, origin_detector, curved, c_string, overwrite, weight)
+	return projections
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def build_sinogram_cone_3d_params(int volume_size, int detector_size, int detector_rows, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int CenTypeIn, float source_origin, float origin_detector, object_3d[:] obj_params, float pixel_size=1.0, float row_size=1.0, int curved=0, out=None, str mode='overwrite', float weight=1.0):
+	"""
+	build_sinogram_cone_3d_params (volume_size, detector_size, detector_rows, angles, CenTypeIn, source_origin, origin_detector, obj_params, pixel_size=1.0, row_size=1.0, curved=0, out=None, mode='overwrite', weight=1.0)
+	
+	The same as build_sinogram_cone_3d for a list of objects.
+	
+	param: obj_params -- object parameters list
+	returns: numpy float32 projections array (len(angles) x detector_rows x detector_size).
+	
+	"""
+	cdef Py_ssize_t i
+	cdef np.ndarray[np.float32_t, ndim=3, mode="c"] projections
+	cdef int overwrite
+	projections, overwrite = _output_array(out, [angles.shape[0], detector_rows, detector_size], mode)
+	cdef float ret_val
+	cdef int AngTot = angles.shape[0]
+	if overwrite and (obj_params.shape[0] == 0):
+		projections[...] = 0.0
+	with nogil:
+		for i in range(obj_params.shape[0]):
+			ret_val = buildSinoCone3D_core_single(&projections[0,0,0], volume_size, detector_size, detector_rows, &angles[0], AngTot, CenTypeIn, pixel_size, row_size, source_origin, origin_detector, curved, obj_params[i].Obj, weight*obj_params[i].C0, obj_params[i].x0, obj_params[i].y0, obj_params[i].z0, obj_params[i].a, obj_params[i].b, obj_params[i].c, obj_params[i].psi1, obj_params[i].psi2, obj_params[i].psi3, overwrite)
+			overwrite = 0
+	return projections
+
+def rays_parallel_3d(angles, p, z):
+	"""
+	rays_parallel_3d (angles, p, z)
+	
+	Returns the rays (for line_integrals_3d) of the parallel beam geometry given by (theta, p, z) triplets.
+	
+	param: angles -- the projection angles theta in degrees
+	param: p -- the detector coordinates (in voxels, along (-cos(theta), sin(theta), 0) from the rotation axis)
+	param: z -- the coordinates along the rotation axis (in voxels)
+	returns: numpy float32 array of rays (len x 6), broadcast over angles, p and z.
+	
+	"""
+	th, p, z = np.broadcast_arrays(np.radians(np.asarray(angles, dtype='float64')), np.asarray(p, dtype='float64'), np.asarray(z, dtype='float64'))
+	rays = np.empty(th.shape + (6,), dtype='float32')
+	rays[...,0] = -p*np.cos(th)
+	rays[...,1] = p*np.sin(th)
+	rays[...,2] = z
+	rays[...,3] = np.sin(th)
+	rays[...,4] = np.cos(th)
+	rays[...,5] = 0.0
+	return rays.reshape(-1, 6)
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def line_integrals_3d(str model_parameters_filename, int model_id, int volume_size, np.ndarray[np.float32_t, ndim=2, mode="c"] rays, int CenTypeIn=1, out=None, str mode='overwrite', float weight=1.0):
+	"""
+	line_integrals_3d (model_parameters_filename, model_id, volume_size, rays, CenTypeIn=1, out=None, mode='overwrite', weight=1.0)
+	
+	Returns the exact line integrals of the model along arbitrary rays, any geometry (helical, irregular angles,
+	subsampled detectors, ...) can be given as a list of rays.
+	
+	param: model_parameters_filename -- filename for the model parameters
+	param: model_id -- a model id from the functions file
+	param: volume_size -- a phantom size in each dimension.
+	param: rays -- float32 array (n x 6) of rays (px, py, pz, dx, dy, dz): a point of the ray outside of the objects and
+	              the direction, in voxels relative to the centre of the volume (see rays_parallel_3d)
+	param: CenTypeIn -- 1 as default [0: radon, 1:astra]
+	param: out -- optional float32 array (n) to write into
+	param: mode -- 'overwrite' (default) or 'accumulate' (adds to the existing data of out)
+	param: weight -- the intensities of all objects are multiplied by weight
+	returns: numpy float32 array (n) of the line integrals (scaled as the sinograms).
+	
+	"""
+	if rays.shape[1] != 6:
+		raise ValueError("rays must be an array of shape (n, 6)")
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] integrals
+	cdef int overwrite
+	integrals, overwrite = _output_array(out, [rays.shape[0]], mode)
+	cdef float ret_val
+	py_byte_string = model_parameters_filename.encode('UTF-8')
+	cdef char* c_string = py_byte_string
+	cdef int NRays = rays.shape[0]
+	if NRays == 0:
+		return integrals
+	with nogil:
+		ret_val = lineIntegrals3D_core(&integrals[0], model_id, volume_size, &rays[0,0], NRays, CenTypeIn, c_string, overwrite, weight)
+	return integrals
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def line_integrals_3d_params(int volume_size, np.ndarray[np.float32_t, ndim=2, mode="c"] rays, object_3d[:] obj_params, int CenTypeIn=1, out=None, str mode='overwrite', float weight=1.0):
+	"""
+	line_integrals_3d_params (volume_size, rays, obj_params, CenTypeIn=1, out=None, mode='overwrite', weight=1.0)
+	
+	The same as line_integrals_3d for a list of objects.
+	
+	param: obj_params -- object parameters list
+	returns: numpy float32 array (n) of the line integrals.
+	
+	"""
+	if rays.shape[1] != 6:
+		raise ValueError("rays must be an array of shape (n, 6)")
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] integrals
+	cdef int overwrite
+	integrals, overwrite = _output_array(out, [rays.shape[0]], mode)
+	cdef float ret_val
+	cdef int NRays = rays.shape[0]
+	cdef int Components = obj_params.shape[0]
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] params = _model_array(obj_params)
+	if NRays == 0:
+		return integrals
+	with nogil:
+		ret_val = lineIntegrals3D_core_params(&integrals[0], volume_size, &rays[0,0], NRays, CenTypeIn, &params[0,0], Components, overwrite, weight)
+	return integrals
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def sample_phantom_3d(str model_parameters_filename, int model_id, np.ndarray[np.float32_t, ndim=2, mode="c"] points, out=None, str mode='overwrite', float weight=1.0):
+	"""
+	sample_phantom_3d (model_parameters_filename, model_id, points, out=None, mode='overwrite', weight=1.0)
+	
+	Returns the exact values of the model at arbitrary points (mesh nodes, oblique slices, off-grid samples),
+	no volume is built.
+	
+	param: model_parameters_filename -- filename for the model parameters
+	param: model_id -- a model id from the functions file
+	param: points -- float32 array (M x 3) of (x, y, z) coordinates in [-1, 1], the voxel [k, i, j] of a phantom of
+	                 size N is at x = -1 + 2*i/N, y = -1 + 2*j/N, z = -1 + 2*k/N
+	param: out -- optional float32 array (M) to write into
+	param: mode -- 'overwrite' (default) or 'accumulate' (adds to the existing data of out)
+	param: weight -- the intensities of all objects are multiplied by weight
+	returns: numpy float32 array (M) of the values.
+	
+	"""
+	if points.shape[1] != 3:
+		raise ValueError("points must be an array of shape (M, 3)")
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] values
+	cdef int overwrite
+	values, overwrite = _output_array(out, [points.shape[0]], mode)
+	cdef float ret_val
+	py_byte_string = model_parameters_filename.encode('UTF-8')
+	cdef char* c_string = py_byte_string
+	cdef int M = points.shape[0]
+	if M == 0:
+		return values
+	with nogil:
+		ret_val = samplePhantom3D_core(&values[0], model_id, &points[0,0], M, c_string, overwrite, weight)
+	return values
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def sample_phantom_3d_params(np.ndarray[np.float32_t, ndim=2, mode="c"] points, object_3d[:] obj_params, out=None, str mode='overwrite', float weight=1.0):
+	"""
+	sample_phantom_3d_params (points, obj_params, out=None, mode='overwrite', weight=1.0)
+	
+	The same as sample_phantom_3d for a list of objects.
+	
+	param: obj_params -- object parameters list
+	returns: numpy float32 array (M) of the values.
+	
+	"""
+	if points.shape[1] != 3:
+		raise ValueError("points must be an array of shape (M, 3)")
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] values
+	cdef int overwrite
+	values, overwrite = _output_array(out, [points.shape[0]], mode)
+	cdef float ret_val
+	cdef int M = points.shape[0]
+	cdef int Components = obj_params.shape[0]
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] params = _model_array(obj_params)
+	if M == 0:
+		return values
+	with nogil:
+		ret_val = samplePhantom3D_core_params(&values[0], &points[0,0], M, &params[0,0], Components, overwrite, weight)
+	return values
+
+def _plane_axes(origin, u, v):
+	"""
+	returns the origin and the in-plane half axes of a slice as float32 arrays of length 3
+	"""
+	axes = [np.ascontiguousarray(w, dtype='float32').ravel() for w in (origin, u, v)]
+	if any(w.shape[0] != 3 for w in axes):
+		raise ValueError("origin, u and v must be vectors of length 3")
+	return axes
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def sample_plane_3d(str model_parameters_filename, int model_id, origin, u, v, int size_u, int size_v, out=None, str mode='overwrite', float weight=1.0):
+	"""
+	sample_plane_3d (model_parameters_filename, model_id, origin, u, v, size_u, size_v, out=None, mode='overwrite', weight=1.0)
+	
+	Returns an arbitrary (oblique) plane of the model, no volume is built.
+	
+	param: model_parameters_filename -- filename for the model parameters
+	param: model_id -- a model id from the functions file
+	param: origin -- the centre of the slice (x, y, z) in [-1, 1] coordinates
+	param: u, v -- the in-plane half axes (x, y, z) of the slice
+	param: size_u, size_v -- the slice size in pixels, the pixel [i, j] is at origin + (-1 + 2*i/size_u)*u + (-1 + 2*j/size_v)*v,
+	                         so origin = (0, 0, z), u = (1, 0, 0), v = (0, 1, 0) and size_u = size_v = N give the slices of the phantom
+	param: out -- optional float32 array (size_u x size_v) to write into
+	param: mode -- 'overwrite' (default) or 'accumulate' (adds to the existing data of out)
+	param: weight -- the intensities of all objects are multiplied by weight
+	returns: numpy float32 array (size_u x size_v) of the slice.
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] c_origin, c_u, c_v
+	c_origin, c_u, c_v = _plane_axes(origin, u, v)
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] plane
+	cdef int overwrite
+	plane, overwrite = _output_array(out, [size_u, size_v], mode)
+	cdef float ret_val
+	py_byte_string = model_parameters_filename.encode('UTF-8')
+	cdef char* c_string = py_byte_string
+	if plane.size == 0:
+		return plane
+	with nogil:
+		ret_val = samplePlane3D_core(&plane[0,0], model_id, &c_origin[0], &c_u[0], &c_v[0], size_u, size_v, c_string, overwrite, weight)
+	return plane
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def sample_plane_3d_params(origin, u, v, int size_u, int size_v, object_3d[:] obj_params, out=None, str mode='overwrite', float weight=1.0):
+	"""
+	sample_plane_3d_params (origin, u, v, size_u, size_v, obj_params, out=None, mode='overwrite', weight=1.0)
+	
+	The same as sample_plane_3d for a list of objects.
+	
+	param: obj_params -- object parameters list
+	returns: numpy float32 array (size_u x size_v) of the slice.
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] c_origin, c_u, c_v
+	c_origin, c_u, c_v = _plane_axes(origin, u, v)
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] plane
+	cdef int overwrite
+	plane, overwrite = _output_array(out, [size_u, size_v], mode)
+	cdef float ret_val
+	cdef int Components = obj_params.shape[0]
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] params = _model_array(obj_params)
+	if plane.size == 0:
+		return plane
+	with nogil:
+		ret_val = samplePlane3D_core_params(&plane[0,0], &c_origin[0], &c_u[0], &c_v[0], size_u, size_v, &params[0,0], Components, overwrite, weight)
+	return plane
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def deform_volume_3d(volume, float rfp, float angle, int deform_type=0, out=None, quantised=False, str interpolation='linear'):
+	"""
+	deform_volume_3d (volume, rfp, angle, deform_type=0, out=None, quantised=False, interpolation='linear')
+	
+	Deforms every slice of a volume with the 2D fan-beam deformation transform of Kazantsev & Pickalov (IPSE, 2017),
+	see DeformObject_C. The warp plan of the slices is built once and the slices are deformed in parallel.
+	
+	param: volume -- float32 array (slices x dimX x dimY) or a single image (dimX x dimY), the images can be non-square
+	                 (the pixels are square and the longer side of the image is [-1, 1])
+	param: rfp -- propotional to the focal point distance
+	param: angle -- deformation angle in degrees
+	param: deform_type -- 0 - forward, 1 - inverse
+	param: out -- optional float32 C-contiguous array of the shape of volume to write into, out can be volume itself
+	              (the deformation in place, the volume is streamed slice by slice)
+	param: quantised -- the weights of the plan are kept in 16 bits (half of the memory traffic of the plan, the values
+	                    differ by about 3e-5 of the intensities)
+	param: interpolation -- 'linear' (default), 'cubic' (cubic B-spline, the slices are prefiltered) or 'lanczos'
+	                        (Lanczos-3), the higher orders keep small features without supersampling the volume
+	                        (the slices are deformed one by one, quantised is ignored)
+	returns: numpy float32 array of the deformed volume.
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] a, b
+	cdef np.ndarray[np.int32_t, ndim=1, mode="c"] index
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] weights
+	cdef np.ndarray[np.uint16_t, ndim=1, mode="c"] qweights
+	cdef float *w_ptr = NULL
+	cdef unsigned short *q_ptr = NULL
+	cdef int ret_plan
+	cdef float ret_val
+	cdef int Interp
+	cdef Py_ssize_t k
+	cdef size_t Size
+	interpolations = {'linear': 0, 'cubic': 1, 'lanczos': 2}
+	if interpolation not in interpolations:
+		raise ValueError("interpolation must be 'linear', 'cubic' or 'lanczos'")
+	Interp = interpolations[interpolation]
+	shape = np.shape(volume)
+	if (len(shape) != 2) and (len(shape) != 3):
+		raise ValueError("volume must be an image or a stack of images")
+	cdef int dimX = shape[len(shape)-2]
+	cdef int dimY = shape[len(shape)-1]
+	cdef int Images = shape[0] if len(shape) == 3 else 1
+	if (dimX < 2) or (dimY < 2):
+		raise ValueError("the images must be at least 2 x 2 pixels")
+	a = np.ascontiguousarray(volume, dtype=np.float32).reshape(-1)
+	if out is None:
+		deformed = np.empty(shape, dtype='float32')
+	else:
+		deformed = out
+		if (deformed.dtype != np.float32) or (deformed.shape != shape) or (not deformed.flags['C_CONTIGUOUS']):
+			raise ValueError("out must be a C-contiguous float32 array of the shape of volume")
+	b = deformed.reshape(-1)
+	if Images == 0:
+		return deformed
+	if Interp != 0:
+		Size = <size_t> dimX*dimY
+		with nogil:
+			for k in range(Images):
+				ret_val = DeformObject_core_interp(&a[k*Size], &b[k*Size], dimX, dimY, rfp, angle, deform_type, Interp)
+		return deformed
+	index = np.empty([dimX*dimY], dtype='int32')
+	if quantised:
+		qweights = np.empty([4*dimX*dimY], dtype='uint16')
+		q_ptr = &qweights[0]
+	else:
+		weights = np.empty([4*dimX*dimY], dtype='float32')
+		w_ptr = &weights[0]
+	with nogil:
+		ret_plan = DeformObject_plan_core(<int *> &index[0], w_ptr, q_ptr, dimX, dimY, rfp, angle, deform_type)
+		ret_val = DeformObject_apply_core(<int *> &index[0], w_ptr, q_ptr, &a[0], &b[0], dimX, dimY, Images)
+	return deformed
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def add_noise_sinogram(sinogram, float I0=0.0, float scale=1.0, float sigma=0.0, float zinger_probability=0.0, float zinger_amplitude=0.0, float stripe_probability=0.0, float stripe_strength=0.0, unsigned int seed=0):
+	"""
+	add_noise_sinogram (sinogram, I0=0.0, scale=1.0, sigma=0.0, zinger_probability=0.0, zinger_amplitude=0.0, stripe_probability=0.0, stripe_strength=0.0, seed=0)
+	
+	Adds the noise of a measurement to a sinogram in place, in parallel. The random numbers are counter-based (Philox),
+	the noise depends on the seed only and is the same for any number of threads.
+	
+	param: sinogram -- C-contiguous float32 array, a 3D sinogram of build_sinogram_phantom_3d (len(angles) x detector_size x slices,
+	                   stored slice by slice, so the detector pixels are the last axis in memory) or a 2D sinogram (len(angles) x detector_size)
+	param: I0 -- the flat-field photon count: the transmission I0*exp(-scale*sinogram) is replaced by a Poisson count
+	             (plus the gaussian noise of sigma counts) and the sinogram is -log(counts/I0)/scale (the counts are at
+	             least 1), I0 <= 0 - the gaussian noise of sigma is added to the sinogram
+	param: scale -- the attenuation of one unit of the sinogram (e.g. 1/volume_size for the sinograms in pixels)
+	param: sigma -- the standard deviation of the gaussian (electronic) noise, in counts (or in the units of the sinogram)
+	param: zinger_probability, zinger_amplitude -- the probability of a zinger in a value and its amplitude (added to the sinogram)
+	param: stripe_probability, stripe_strength -- the probability of a faulty detector pixel (the stripes of the sinogram,
+	                                              the rings of the reconstruction) and the maximal relative error of its gain
+	param: seed -- the seed of the random numbers
+	returns: the noisy sinogram (the same array).
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] a
+	cdef int Rows, Cols
+	cdef float ret_val
+	if (sinogram.dtype != np.float32) or (not sinogram.flags['C_CONTIGUOUS']):
+		raise ValueError("sinogram must be a C-contiguous float32 array")
+	if sinogram.ndim not in (2, 3):
+		raise ValueError("sinogram must be of the shape (len(angles), detector_size[, slices])")
+	if sinogram.size == 0:
+		return sinogram
+	a = sinogram.reshape(-1)
+	# the detector pixels are the last axis in memory of both layouts, the rows are the angles (of all slices)
+	Cols = sinogram.shape[1]
+	Rows = sinogram.size // Cols
+	with nogil:
+		ret_val = noiseSino_core(&a[0], Rows, Cols, I0, scale, sigma, zinger_probability, zinger_amplitude, stripe_probability, stripe_strength, seed)
+	return sinogram
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def reconstruct_fbp(sinogram, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int volume_size, int CenTypeIn=1, out=None):
+	"""
+	reconstruct_fbp (sinogram, angles, volume_size, CenTypeIn=1, out=None)
+	
+	Reconstructs the images from the parallel beam sinograms with the filtered backprojection (the ramp filter),
+	in parallel over the slices. The reference reconstruction of the sinograms of build_sinogram_phantom_3d
+	(and of the 2D sinograms) without external toolboxes.
+	
+	param: sinogram -- C-contiguous float32 array, a 3D sinogram of build_sinogram_phantom_3d (len(angles) x detector_size x slices,
+	                   stored slice by slice) or a 2D sinogram (len(angles) x detector_size)
+	param: angles -- a numpy array of float values with angles in degrees (over 180 or 360 degrees)
+	param: volume_size -- the size of the reconstructed images (volume_size x volume_size)
+	param: CenTypeIn -- the centring of the sinogram, 1 as default [0: radon, 1:astra]
+	param: out -- optional float32 array (slices x volume_size x volume_size, or volume_size x volume_size) to write into
+	returns: numpy float32 array of the reconstructed images.
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] a
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] sino
+	cdef int P, Slices, AngTot = angles.shape[0]
+	cdef float ret_val
+	if (sinogram.dtype != np.float32) or (not sinogram.flags['C_CONTIGUOUS']):
+		raise ValueError("sinogram must be a C-contiguous float32 array")
+	if (sinogram.ndim not in (2, 3)) or (sinogram.shape[0] != AngTot):
+		raise ValueError("sinogram must be of the shape (len(angles), detector_size[, slices])")
+	if AngTot == 0:
+		raise ValueError("angles must not be empty")
+	P = sinogram.shape[1]
+	Slices = sinogram.shape[2] if sinogram.ndim == 3 else 1
+	if (P < 2) or (volume_size < 1):
+		raise ValueError("the detector and the volume sizes must be positive")
+	shape = [Slices, volume_size, volume_size] if sinogram.ndim == 3 else [volume_size, volume_size]
+	volume, overwrite = _output_array(out, shape, 'overwrite')
+	if Slices == 0:
+		return volume
+	a = volume.reshape(-1)
+	sino = sinogram.reshape(-1)
+	with nogil:
+		ret_val = FBP_core(&a[0], &sino[0], volume_size, P, &angles[0], AngTot, CenTypeIn, Slices)
+	return volume
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def project_joseph(volume, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int detector_size, int CenTypeIn=1, out=None):
+	"""
+	project_joseph (volume, angles, detector_size, CenTypeIn=1, out=None)
+	
+	Computes the discrete parallel beam projections (Joseph's method) of a rasterised phantom in the geometry of
+	build_sinogram_phantom_3d, in parallel over the slices and the angles. The numerical sinograms for the
+	comparisons with the analytical ones ("inverse crime") without external toolboxes.
+	
+	param: volume -- C-contiguous float32 array, a 3D phantom of build_volume_phantom_3d (slices x N x N) or a 2D image (N x N)
+	param: angles -- a numpy array of float values with angles in degrees
+	param: detector_size -- int detector size.
+	param: CenTypeIn -- the centring of the sinogram, 1 as default [0: radon, 1:astra]
+	param: out -- optional float32 array (len(angles) x detector_size x slices, or len(angles) x detector_size) to write into
+	returns: numpy float32 sinograms array (the line integrals in pixels, stored slice by slice as of build_sinogram_phantom_3d).
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] s
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] a
+	cdef int N, Slices, AngTot = angles.shape[0]
+	cdef float ret_val
+	if (volume.dtype != np.float32) or (not volume.flags['C_CONTIGUOUS']):
+		raise ValueError("volume must be a C-contiguous float32 array")
+	if (volume.ndim not in (2, 3)) or (volume.shape[volume.ndim-1] != volume.shape[volume.ndim-2]):
+		raise ValueError("volume must be of the shape ([slices,] N, N)")
+	if detector_size < 2:
+		raise ValueError("the detector size must be larger than 1")
+	N = volume.shape[volume.ndim-1]
+	Slices = volume.shape[0] if volume.ndim == 3 else 1
+	shape = [AngTot, detector_size, Slices] if volume.ndim == 3 else [AngTot, detector_size]
+	sinogram, overwrite = _output_array(out, shape, 'overwrite')
+	if (N == 0) or (Slices == 0) or (AngTot == 0):
+		sinogram.fill(0.0)
+		return sinogram
+	s = sinogram.reshape(-1)
+	a = volume.reshape(-1)
+	with nogil:
+		ret_val = projectJoseph_core(&s[0], &a[0], N, detector_size, &angles[0], AngTot, CenTypeIn, Slices)
+	return sinogram
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def update_volume_phantom_4d(volume, object_3d[:] old_params, object_3d[:] new_params, bint fast_math=False):
+	"""
+	update_volume_phantom_4d (volume, old_params, new_params, fast_math=False)
+	
+	Turns the phantom of a frame of a dynamic (4D) model into the phantom of the next frame in place: the components
+	which have changed are removed with their old parameters and added with the new ones, only in their bounding
+	boxes, so the cost of a frame is proportional to what has changed. The frames of a 4D model are built with
+	build_volume_phantom_3d_params (the first frame) and the updates.
+	
+	param: volume -- C-contiguous float32 array (phantom_size x phantom_size x phantom_size), the phantom of old_params
+	param: old_params -- object parameters list of the current frame
+	param: new_params -- object parameters list of the next frame (the same components in the same order)
+	param: fast_math -- the precision of the kernels (see build_volume_phantom_3d_params), the same as the one
+	                   the frame has been built with
+	returns: the number of the changed components.
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] a
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] old = _model_array(old_params)
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] new = _model_array(new_params)
+	cdef int N, Components = old_params.shape[0], ret_val
+	if (not isinstance(volume, np.ndarray)) or (volume.dtype != np.float32) or (not volume.flags['C_CONTIGUOUS']) or (volume.ndim != 3) or (volume.shape[0] != volume.shape[1]) or (volume.shape[0] != volume.shape[2]):
+		raise ValueError("volume must be a C-contiguous float32 array of the shape (N, N, N)")
+	if new_params.shape[0] != Components:
+		raise ValueError("old_params and new_params must have the same components")
+	N = volume.shape[0]
+	if (N == 0) or (Components == 0):
+		return 0
+	a = volume.reshape(-1)
+	with nogil:
+		ret_val = buildPhantom4D_core_update(&a[0], N, &old[0,0], &new[0,0], Components, fast_math)
+	return ret_val
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def update_sinogram_phantom_4d(sinogram, np.ndarray[np.float32_t, ndim=1, mode="c"] angles, int CenTypeIn, object_3d[:] old_params, object_3d[:] new_params, bint fast_math=False):
+	"""
+	update_sinogram_phantom_4d (sinogram, angles, CenTypeIn, old_params, new_params, fast_math=False)
+	
+	Turns the sinogram of a frame of a dynamic (4D) model into the sinogram of the next frame in place (see
+	update_volume_phantom_4d), only the slices of the changed components are updated.
+	
+	param: sinogram -- C-contiguous float32 array (len(angles) x detector_size x volume_size) of build_sinogram_phantom_3d_params with old_params
+	param: angles -- a numpy array of float values with angles in degrees
+	param: CenTypeIn -- the centring of the sinogram [0: radon, 1:astra]
+	param: old_params -- object parameters list of the current frame
+	param: new_params -- object parameters list of the next frame (the same components in the same order)
+	param: fast_math -- the precision of the kernels (see build_volume_phantom_3d_params), the same as the one
+	                   the frame has been built with
+	returns: the number of the changed components.
+	
+	"""
+	cdef np.ndarray[np.float32_t, ndim=1, mode="c"] s
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] old = _model_array(old_params)
+	cdef np.ndarray[np.float32_t, ndim=2, mode="c"] new = _model_array(new_params)
+	cdef int N, P, AngTot = angles.shape[0], Components = old_params.shape[0], ret_val
+	if (not isinstance(sinogram, np.ndarray)) or (sinogram.dtype != np.float32) or (not sinogram.flags['C_CONTIGUOUS']) or (sinogram.ndim != 3) or (sinogram.shape[0] != AngTot):
+		raise ValueError("sinogram must be a C-contiguous float32 array of the shape (len(angles), detector_size, volume_size)")
+	if new_params.shape[0] != Components:
+		raise ValueError("old_params and new_params must have the same components")
+	P = sinogram.shape[1]
+	N = sinogram.shape[2]
+	if (N == 0) or (AngTot == 0) or (Components == 0):
+		return 0
+	s = sinogram.reshape(-1)
+	with nogil:
+		ret_val = buildSino4D_core_update(&s[0], N, P, &angles[0], AngTot, CenTypeIn, &old[0,0], &new[0,0], Components, fast_math)
+	return ret_val
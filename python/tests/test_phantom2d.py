@@ -0,0 +1,53 @@
+import unittest
+import numpy as np
+import tomophantom
+import tomophantom.phantom2d
+class TestTomophantom2D(unittest.TestCase):
+    def test_build_sinogram_motion_2d(self):
+        # every projection of a moving object is the projection of the object at its angle
+        N, P = 64, 92
+        angles = np.linspace(0,360, 60, endpoint=False, dtype='float32')
+        params = np.zeros((3, angles.size, 7), dtype='float32')
+        params[0] = (3, 1.00, 0.0, 0.0, 0.6, 0.5, 20.0)
+        params[1] = (1, 0.50, -0.2, 0.1, 0.05, 0.05, 0.0)
+        params[2] = (5, 0.30, 0.2, -0.2, 0.15, 0.1, 0.0)
+        params[1,:,2] = np.linspace(-0.3, 0.3, angles.size)
+        params[2,:,6] = 0.5*angles
+        sino = tomophantom.phantom2d.build_sinogram_motion_2d(N, P, angles, 1, params)
+        self.assertEqual(sino.shape, (angles.size, P))
+        for i in range(angles.size):
+            row = tomophantom.phantom2d.build_sinogram_motion_2d(N, P, angles[i:i+1].copy(), 1, params[:,i:i+1,:].copy())
+            self.assertEqual(np.allclose(sino[i], row[0], rtol=1e-5, atol=1e-4), True)
+        # a moving rectangle (the rows of the rectangles are in the reverse order of the angles)
+        rect = np.zeros((1, angles.size, 7), dtype='float32')
+        rect[0] = (6, 1.00, 0.1, -0.1, 0.3, 0.15, 13.0)
+        rect[0,:,2] = np.linspace(-0.3, 0.3, angles.size)
+        rect[0,:,6] = 13.0 + 0.1*angles
+        sino = tomophantom.phantom2d.build_sinogram_motion_2d(N, P, angles, 1, rect)
+        rows = [tomophantom.phantom2d.build_sinogram_motion_2d(N, P, angles[i:i+1].copy(), 1, rect[:,i:i+1,:].copy())[0] for i in range(angles.size)]
+        self.assertEqual(np.allclose(sino[::-1], np.array(rows), rtol=1e-5, atol=1e-4), True)
+        # the objects which do not move are the same as in a static sinogram
+        static = tomophantom.phantom2d.build_sinogram_motion_2d(N, P, angles, 1, params[0].copy())
+        rows = [tomophantom.phantom2d.build_sinogram_motion_2d(N, P, angles[i:i+1].copy(), 1, params[0,i:i+1,:].copy())[0] for i in range(angles.size)]
+        self.assertEqual(np.allclose(static, np.array(rows), rtol=1e-5, atol=1e-4), True)
+        self.assertEqual(np.abs(sino - tomophantom.phantom2d.build_sinogram_motion_2d(N, P, angles, 1, np.repeat(params[:,:1,:], angles.size, axis=1))).max() > 1.0, True)
+    
+    def test_build_sinogram_fan_2d(self):
+        # with the detector pitch of the parallel beam sinograms and a distant source the fan beam sinogram of the
+        # smooth objects is the parallel beam one bin for bin (the edges of the disks converge more slowly)
+        N, P = 64, 92
+        angles = np.linspace(0,360, 24, endpoint=False, dtype='float32')
+        params = np.array([(1, 1.00, -0.1, 0.2, 0.1, 0.2, 30.0), (1, 0.50, 0.3, -0.2, 0.3, 0.15, 20.0), (2, 0.30, 0.0, 0.1, 0.4, 0.3, 0.0)], dtype='float32')
+        pitch = P*N/((N + 1.0)*(P - 1))
+        for CenTypeIn in (0, 1):
+            parallel = tomophantom.phantom2d.build_sinogram_motion_2d(N, P, angles, CenTypeIn, np.ascontiguousarray(np.repeat(params[:,None,:], angles.size, axis=1)))
+            for curved in (0, 1):
+                fan = tomophantom.phantom2d.build_sinogram_fan_2d(N, P, angles, CenTypeIn, params, 1.0e4, 0.0, pixel_size=pitch, curved=curved)
+                error = np.abs(fan - parallel).max()
+                self.assertLessEqual(error, 2e-3*parallel.max())
+            # the unit pitch is a different detector grid
+            fan = tomophantom.phantom2d.build_sinogram_fan_2d(N, P, angles, CenTypeIn, params, 1.0e4, 0.0)
+            self.assertGreater(np.abs(fan - parallel).max(), 3.0*error)
+        
+if __name__ == "__main__":
+    unittest.main()